@@ -7,18 +7,41 @@
 #include <stdint.h>
 #include "compressor.h"
 #include "zfp_example.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 //float *uncompressedValues; //array for uncompressed values in dataset
 struct fileStats *stats; //array for each files stats
+struct fieldDescriptor *fields; //shape of each dataset
+struct fieldDescriptor grid; //shape the stencil runs over, every dataset must share it
+struct fieldLayout layout; //storage order of every array the stencils run on
+float **originalDatasets; //datasets as read in, the stencil arrays are rebuilt from these for each layout
+struct fieldDescriptor paddedGrid; //grid with one layer of ghost cells on every side
+float **paddedDatasets; //uncompressed datasets stored in paddedGrid, ghost cells are 0.0
 float **datasets; //collection of all uncompressed datasets
 struct compressedVal **compressed24Datasets;
-unsigned char **lossy21;
-unsigned char **lossy18;
-unsigned char **lossy15;
-unsigned char **lossy12;
+struct compressedVal **compressed24FixedDatasets; //separate copy for the fixed point stencil so both paths start from the same data
+unsigned char **aligned16Datasets;
+struct compressedField *lossy21; //5 mag 15 precision variable bit fields, one per dataset
+struct compressedField *lossy18; //5 mag 12 precision
+struct compressedField *lossy15; //5 mag 9 precision
+struct compressedField *lossy12; //5 mag 6 precision
+struct compressedField *halfFloat; //IEEE half precision fields
+struct compressedField *bfloat16;
+struct compressedField *codebook8; //trained codebook and 1 byte indices
+struct compressedField *codebook16;
+struct zfpContext *zfpLossless; //tolerance 0 zfp stream and buffer shared by every zfp benchmark
+struct zfpArray **zfpFixedRateDatasets; //16 bits per value fixed rate zfp, accessed through a cache of decoded blocks
 int numDatasets;
 int algorithm_repeat = 1;
+int temporal_block = 4; //stencil sweeps applied to each slab of the grid before moving on to the next
+enum traversalOrder { //order the stencil visits grid points in
+	TRAVERSE_I_OUTER, //i outermost and k innermost, the original order, strides a whole plane per step in a linear layout
+	TRAVERSE_MEMORY //k outermost and i innermost, brick by brick for brick layouts, so steps follow storage
+} traversal = TRAVERSE_MEMORY;
+unsigned int zfp_chunk_size = 0; //blocks per OpenMP chunk for parallel zfp, 0 lets zfp choose
 int repeat = 1;
 
 //struct to represent basic file stats
@@ -26,37 +49,16 @@ struct fileStats {
 	unsigned int uncompressedCount;
 	unsigned int runlengthCount;
 	unsigned int variableCount;
-	unsigned int var21Count;
-	unsigned int var18Count;
-	unsigned int var15Count;
-	unsigned int var12Count;
 	long unsigned int runlengthSize;
 	long unsigned int zfpSize;
+	unsigned int xorCount; //bytes after XOR predictive compression, previous value prediction
+	unsigned int xorPlaneCount; //bytes after XOR predictive compression, previous k plane prediction
 	long unsigned int size24;
  	float maxVal;
  	float minVal;
  	float avgVal;
 };
 
-/*
- * Purpose:
- *		Get the index in the 1D array for the 3D coordinations
- * Parameters:
- *		1. i_rng - top index in i array
- *		2. j_rng - top index in j array
- *		3. i_lb - index for bottom of i array (0)
- *		4. j_lb - index for bottom of j array (0)
- *		5. k_lb - index for bottom of k array (0)
- *		6. ix - target i index
- *		7. jx - target j index
- *		8. kx - target k index
- * Returns:
- *		The 1d index
- */
-inline unsigned int F3D2C(unsigned int i_rng, unsigned int j_rng, int i_lb, int j_lb, int k_lb, int ix, int jx, int kx) {
-	return (i_rng*j_rng*(kx-k_lb)+i_rng*(jx-j_lb)+ix+i_lb);
-}
-
 /*
  * Purpose:
  *		Get the index for [i][j][k] in the 1d flat array
@@ -68,60 +70,521 @@ inline unsigned int F3D2C(unsigned int i_rng, unsigned int j_rng, int i_lb, int
  *		The index value or -1 if the desired position falls off the array
  */
 int getIndex(int i, int j, int k) {
-	if(i == -1 || i == 150 || j == -1 || j == 150 || k == -1 || k == 90)
+	if(i == -1 || i == grid.nx || j == -1 || j == grid.ny || k == -1 || k == grid.nz)
 		return -1;
 	else
-		return F3D2C(150, 150, 0, 0, 0, i, j, k);
+		return getLayoutIndex(&layout, i, j, k);
+}
+
+typedef void (*pointUpdate)(int i, int j, int k); //updates one grid point of every dataset
+
+/*
+ * Purpose:
+ *		Update the points i0 to i1-1 of one i line, interior points go to interiorUpdate and the peeled boundary points to boundaryUpdate
+ */
+void sweepLine(pointUpdate interiorUpdate, pointUpdate boundaryUpdate, int i0, int i1, int j, int k) {
+	int i, last;
+
+	if(j == 0 || j == grid.ny-1 || k == 0 || k == grid.nz-1 || grid.nx < 3) { //whole line is on the boundary
+		for(i = i0; i < i1; i++) {
+			boundaryUpdate(i,j,k);
+		}
+		return;
+	}
+	if(i0 == 0) {
+		boundaryUpdate(0,j,k);
+		i0 = 1;
+	}
+	last = i1 == grid.nx ? grid.nx-1 : i1;
+	for(i = i0; i < last; i++) {
+		interiorUpdate(i,j,k);
+	}
+	if(i1 == grid.nx) {
+		boundaryUpdate(grid.nx-1,j,k);
+	}
+}
+
+/*
+ * Purpose:
+ *		Update every point in planes k0 to k1-1 in memory order, brick by brick for brick layouts. Planes are a whole number of bricks.
+ */
+void sweepSlab(pointUpdate interiorUpdate, pointUpdate boundaryUpdate, int k0, int k1) {
+	int i0, j0, j, k;
+	int tile = layout.brick ? layout.brick : grid.nx + grid.ny + grid.nz; //one tile covers a linear field
+
+	for(j0 = 0; j0 < grid.ny; j0 += tile) {
+		for(i0 = 0; i0 < grid.nx; i0 += tile) {
+			for(k = k0; k < k1; k++) {
+				for(j = j0; j < j0 + tile && j < grid.ny; j++) {
+					sweepLine(interiorUpdate, boundaryUpdate, i0, i0 + tile < grid.nx ? i0 + tile : grid.nx, j, k);
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Run one stencil sweep over the grid in the current traversal order. Points with all six neighbours go to interiorUpdate,
+ *		which needs no bounds checks, the peeled boundary points (first/last i, j and k) go to boundaryUpdate.
+ * Parameters:
+ *		1. interiorUpdate - update for points away from the edge of the grid
+ *		2. boundaryUpdate - update that checks which neighbours exist
+ */
+void sweepGrid(pointUpdate interiorUpdate, pointUpdate boundaryUpdate) {
+	int i, j, k, k0;
+	int slab = layout.brick ? layout.brick : grid.nz;
+
+	if(traversal == TRAVERSE_I_OUTER) {
+		for(i = 0; i < grid.nx; i++) {
+			for(j = 0; j < grid.ny; j++) {
+				if(i == 0 || i == grid.nx-1 || j == 0 || j == grid.ny-1 || grid.nz < 3) { //whole k line is on the boundary
+					for(k = 0; k < grid.nz; k++) {
+						boundaryUpdate(i,j,k);
+					}
+					continue;
+				}
+				boundaryUpdate(i,j,0);
+				for(k = 1; k < grid.nz-1; k++) {
+					interiorUpdate(i,j,k);
+				}
+				boundaryUpdate(i,j,grid.nz-1);
+			}
+		}
+		return;
+	}
+	for(k0 = 0; k0 < grid.nz; k0 += slab) {
+		sweepSlab(interiorUpdate, boundaryUpdate, k0, k0 + slab < grid.nz ? k0 + slab : grid.nz);
+	}
+}
+
+/*
+ * Purpose:
+ *		Run several stencil sweeps in one pass over the grid (temporal blocking). The grid is cut into slabs of one brick, or one plane for a
+ *		linear layout, and sweep t updates slab s on wave s+t, so the slabs a wave touches stay in cache between sweeps. Sweep t on slab s comes
+ *		after sweep t-1 on slab s+1 and before sweep t+1 on slab s-1, every point reads the same neighbour values as it would with steps
+ *		separate memory order sweeps, so the results are identical.
+ * Parameters:
+ *		1. interiorUpdate - update for points away from the edge of the grid
+ *		2. boundaryUpdate - update that checks which neighbours exist
+ *		3. steps - number of sweeps to apply
+ */
+void wavefrontSweeps(pointUpdate interiorUpdate, pointUpdate boundaryUpdate, int steps) {
+	int slab = layout.brick ? layout.brick : 1;
+	int slabs = (grid.nz + slab - 1) / slab;
+	int wave, step, s;
+
+	for(wave = 0; wave < slabs + steps - 1; wave++) {
+		for(step = 0; step < steps; step++) {
+			s = wave - step;
+			if(s >= 0 && s < slabs) {
+				sweepSlab(interiorUpdate, boundaryUpdate, s*slab, (s+1)*slab < grid.nz ? (s+1)*slab : grid.nz);
+			}
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Apply algorithm_repeat stencil sweeps, temporal_block at a time through wavefrontSweeps when traversing in memory order
+ */
+void repeatSweeps(pointUpdate interiorUpdate, pointUpdate boundaryUpdate) {
+	int rep, steps;
+
+	for(rep = 0; rep < algorithm_repeat; rep += steps) {
+		steps = temporal_block < algorithm_repeat - rep ? temporal_block : algorithm_repeat - rep;
+		if(traversal == TRAVERSE_I_OUTER || steps < 2) {
+			steps = 1;
+			sweepGrid(interiorUpdate, boundaryUpdate);
+		} else {
+			wavefrontSweeps(interiorUpdate, boundaryUpdate, steps);
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Update the points of one colour (i+j+k even for red, odd for black) in planes k0 to k1-1, peeling the boundary points as sweepLine does
+ */
+void sweepSlabColour(pointUpdate interiorUpdate, pointUpdate boundaryUpdate, int k0, int k1, int colour) {
+	int i, j, k, last;
+
+	for(k = k0; k < k1; k++) {
+		for(j = 0; j < grid.ny; j++) {
+			i = (colour + j + k) & 1; //first i of this colour on the line
+			if(j == 0 || j == grid.ny-1 || k == 0 || k == grid.nz-1 || grid.nx < 3) {
+				for(; i < grid.nx; i += 2) {
+					boundaryUpdate(i,j,k);
+				}
+				continue;
+			}
+			if(i == 0) {
+				boundaryUpdate(0,j,k);
+				i = 2;
+			}
+			last = grid.nx-1;
+			for(; i < last; i += 2) {
+				interiorUpdate(i,j,k);
+			}
+			if(i == last) {
+				boundaryUpdate(last,j,k);
+			}
+		}
+	}
 }
 
 /*
  * Purpose:
- *		Update a value in 21 bit format
+ *		Run one red-black stencil sweep with the grid split into k slabs across threads. Points of one colour only read points of the other,
+ *		so the result does not depend on the number of threads. Slabs are a whole number of bricks thick so each covers one run of storage,
+ *		and even and odd slabs take turns so two threads never write neighbouring slabs (records of compressed formats can share a byte
+ *		with the record stored next to them).
+ * Parameters:
+ *		1. interiorUpdate - update for points away from the edge of the grid
+ *		2. boundaryUpdate - update that checks which neighbours exist
+ *		3. threads - number of threads to use
  */
-float update21BitCompressedValue(int i, int j, int k) {
+void redBlackSweep(pointUpdate interiorUpdate, pointUpdate boundaryUpdate, int threads) {
+	int unit = layout.brick ? layout.brick : 1;
+	int units = (grid.nz + unit - 1) / unit;
+	int slabs = 2*threads < units ? 2*threads : units;
+	int colour, parity, slab;
+
+	for(colour = 0; colour < 2; colour++) {
+		for(parity = 0; parity < 2; parity++) {
+			#pragma omp parallel for num_threads(threads) schedule(static)
+			for(slab = parity; slab < slabs; slab += 2) {
+				int k0 = (slab * units / slabs) * unit;
+				int k1 = ((slab + 1) * units / slabs) * unit;
+				sweepSlabColour(interiorUpdate, boundaryUpdate, k0, k1 < grid.nz ? k1 : grid.nz, colour);
+			}
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Update a value of every dataset's compressed field, checking which neighbours exist
+ * Parameters:
+ *		1. compressedFields - one field per dataset
+ *		2. i - index
+ *		3. j - index
+ *		4. k - index
+ */
+void updateFieldValue(struct compressedField *compressedFields, int i, int j, int k) {
 	float tmpValue;
 	int divisor;
+	int fileInd;
+
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		tmpValue = getFieldNeighbourSum(&compressedFields[fileInd], i, j, k, &divisor);
+		setFieldValue(&compressedFields[fileInd], i, j, k, getFieldValue(&compressedFields[fileInd], i, j, k) + (tmpValue/divisor));
+	}
+}
+
+/*
+ * Purpose:
+ *		Update an interior value (all six neighbours exist) of every dataset's compressed field
+ */
+void updateFieldInteriorValue(struct compressedField *compressedFields, int i, int j, int k) {
+	float tmpValue;
+	int fileInd;
+
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		tmpValue = getFieldValue(&compressedFields[fileInd], i-1, j, k) + getFieldValue(&compressedFields[fileInd], i+1, j, k)
+			+ getFieldValue(&compressedFields[fileInd], i, j-1, k) + getFieldValue(&compressedFields[fileInd], i, j+1, k)
+			+ getFieldValue(&compressedFields[fileInd], i, j, k-1) + getFieldValue(&compressedFields[fileInd], i, j, k+1);
+		setFieldValue(&compressedFields[fileInd], i, j, k, getFieldValue(&compressedFields[fileInd], i, j, k) + (tmpValue/6));
+	}
+}
+
+/*
+ * Purpose:
+ *		Point updates for the variable bit formats, in the pointUpdate form the sweeps take
+ */
+void update21BitCompressedValue(int i, int j, int k) {
+	updateFieldValue(lossy21, i, j, k);
+}
+
+void update21BitInteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(lossy21, i, j, k);
+}
+
+void update18BitCompressedValue(int i, int j, int k) {
+	updateFieldValue(lossy18, i, j, k);
+}
+
+void update18BitInteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(lossy18, i, j, k);
+}
+
+void update15BitCompressedValue(int i, int j, int k) {
+	updateFieldValue(lossy15, i, j, k);
+}
+
+void update15BitInteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(lossy15, i, j, k);
+}
+
+void update12BitCompressedValue(int i, int j, int k) {
+	updateFieldValue(lossy12, i, j, k);
+}
+
+void update12BitInteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(lossy12, i, j, k);
+}
+
+/*
+ * Purpose:
+ *		Point updates for the 16 bit float formats, through the codec interface like the variable bit formats
+ */
+void updateHalfFloatValue(int i, int j, int k) {
+	updateFieldValue(halfFloat, i, j, k);
+}
+
+void updateHalfFloatInteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(halfFloat, i, j, k);
+}
+
+void updateBFloat16Value(int i, int j, int k) {
+	updateFieldValue(bfloat16, i, j, k);
+}
+
+void updateBFloat16InteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(bfloat16, i, j, k);
+}
+
+/*
+ * Purpose:
+ *		Point updates for the codebook formats, the codebook stays fixed and each set picks the nearest entry
+ */
+void updateCodebook8Value(int i, int j, int k) {
+	updateFieldValue(codebook8, i, j, k);
+}
+
+void updateCodebook8InteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(codebook8, i, j, k);
+}
+
+void updateCodebook16Value(int i, int j, int k) {
+	updateFieldValue(codebook16, i, j, k);
+}
+
+void updateCodebook16InteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(codebook16, i, j, k);
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on one of the compressed fields above and record performance
+ * Parameters:
+ *		1. name - Format name for the report
+ *		2. interiorUpdate - Update for points with all six neighbours
+ *		3. boundaryUpdate - Update for any point
+ */
+void transformCompressedField(const char *name, pointUpdate interiorUpdate, pointUpdate boundaryUpdate) {
+	clock_t startTime = clock();
+
+	repeatSweeps(interiorUpdate, boundaryUpdate);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on %s data (averaged over %d interations)  = %f\n", name, algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+
+
+
+/*
+ * Purpose:
+ *		Update item in uncompressed float array given an index in 3-d space 
+ * Parameters:
+ *		1. i - index
+ *		2. j - index
+ *		3. k - index
+ */
+void updateUncompressedValue(int i, int j, int k) {
+	float tmpValue;
+	int divisor ;
 	float currentValue;
 	int fileInd;
 
-	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
 		tmpValue = 0.0f;
 		divisor = 0;
-		currentValue = getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count, F3D2C(150,150,0,0,0,i,j,k), 5, 15);
+		currentValue = datasets[fileInd][getLayoutIndex(&layout,i,j,k)];
 
 		if(getIndex(i-1,j,k)!=-1) {
-			tmpValue+= getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count, F3D2C(150,150,0,0,0,i-1,j,k), 5, 15);
+			tmpValue+=datasets[fileInd][getLayoutIndex(&layout,i-1,j,k)];
 			divisor++;
 		}
 		if(getIndex(i+1,j,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count,  F3D2C(150,150,0,0,0,i+1,j,k), 5, 15);
+			tmpValue+=datasets[fileInd][getLayoutIndex(&layout,i+1,j,k)];
 			divisor++;
 		}
 		if(getIndex(i,j-1,k) != -1){
-			tmpValue+= getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count,  F3D2C(150,150,0,0,0,i,j-1,k), 5, 15);
+			tmpValue+=datasets[fileInd][getLayoutIndex(&layout,i,j-1,k)];
 			divisor++;
 		}
 		if(getIndex(i,j+1,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count,  F3D2C(150,150,0,0,0,i,j+1,k), 5, 15);
+			tmpValue+=datasets[fileInd][getLayoutIndex(&layout,i,j+1,k)];
 			divisor++;
 		}
 		if(getIndex(i,j,k-1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count,  F3D2C(150,150,0,0,0,i,j,k-1), 5, 15);
+			tmpValue+=datasets[fileInd][getLayoutIndex(&layout,i,j,k-1)];
 			divisor++;
 		}
 		if(getIndex(i,j,k+1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count,  F3D2C(150,150,0,0,0,i,j,k+1), 5, 15);
+			tmpValue+=datasets[fileInd][getLayoutIndex(&layout,i,j,k+1)];
 			divisor++;
 		}
-		insertSingleVariableBitValue(lossy21[fileInd], stats[fileInd].var21Count, F3D2C(150,150,0,0,0,i,j,k), currentValue + (tmpValue/divisor), 5, 15);
+		datasets[fileInd][getLayoutIndex(&layout,i,j,k)]=currentValue+(tmpValue/divisor);
 	}
 }
 
 /*
  * Purpose:
- *		Update a value in 18 bit format
+ *		Update an interior value (all six neighbours exist) in uncompressed float arrays, no bounds checks
+ */
+void updateUncompressedInteriorValue(int i, int j, int k) {
+	size_t index = getLayoutIndex(&layout,i,j,k);
+	float tmpValue;
+	int fileInd;
+
+	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+		tmpValue = datasets[fileInd][getLayoutIndex(&layout,i-1,j,k)] + datasets[fileInd][getLayoutIndex(&layout,i+1,j,k)]
+			+ datasets[fileInd][getLayoutIndex(&layout,i,j-1,k)] + datasets[fileInd][getLayoutIndex(&layout,i,j+1,k)]
+			+ datasets[fileInd][getLayoutIndex(&layout,i,j,k-1)] + datasets[fileInd][getLayoutIndex(&layout,i,j,k+1)];
+		datasets[fileInd][index] = datasets[fileInd][index] + (tmpValue/6);
+	}
+}
+
+/*
+ * Purpose:
+ *		Update a value of the uncompressed data stored with ghost cells. The ghost cells are 0.0 so all six neighbours are added
+ *		and the divisor (number of real neighbours) is worked out without branches.
+ */
+void updatePaddedValue(int i, int j, int k) {
+	size_t index = getFieldIndex(&paddedGrid,i,j,k);
+	float divisor = 6 - (i == 0) - (i == paddedGrid.nx-1) - (j == 0) - (j == paddedGrid.ny-1) - (k == 0) - (k == paddedGrid.nz-1);
+	float tmpValue;
+	float *values;
+	int fileInd;
+
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		values = paddedDatasets[fileInd];
+		tmpValue = values[index-paddedGrid.sx] + values[index+paddedGrid.sx]
+			+ values[index-paddedGrid.sy] + values[index+paddedGrid.sy]
+			+ values[index-paddedGrid.sz] + values[index+paddedGrid.sz];
+		values[index] = values[index] + (tmpValue/divisor);
+	}
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on uncompressed data stored with ghost cells and record performance, the same update runs on
+ *		boundary and interior points
+ */
+void transformUncompressedPadded() {
+	clock_t startTime = clock();
+
+	repeatSweeps(updatePaddedValue, updatePaddedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on uncompressed data with ghost cells (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+/*
+ * Purpose:
+ *		Report the largest difference between the ghost cell and the bounds checked uncompressed stencil results (run after both transforms)
+ */
+void comparePaddedResults() {
+	int fileInd, i, j, k;
+	float maxDifference = 0.0f;
+	float difference;
+
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		for(k = 0; k < grid.nz; k++) {
+			for(j = 0; j < grid.ny; j++) {
+				for(i = 0; i < grid.nx; i++) {
+					difference = fabs(datasets[fileInd][getLayoutIndex(&layout,i,j,k)] - paddedDatasets[fileInd][getFieldIndex(&paddedGrid,i,j,k)]);
+					if(difference > maxDifference) {
+						maxDifference = difference;
+					}
+				}
+			}
+		}
+	}
+	printf("Largest difference between ghost cell and bounds checked uncompressed results: %f\n", maxDifference);
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on uncompressed floating point data and record performance
+ */
+void transformUncompressed() {
+	clock_t startTime = clock();
+
+	repeatSweeps(updateUncompressedInteriorValue, updateUncompressedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on uncompressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+void transformNonByteAligned12Compression() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update12BitInteriorValue, update12BitCompressedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 12 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+void transformNonByteAligned15Compression() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update15BitInteriorValue, update15BitCompressedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 15 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+void transformNonByteAligned18Compression() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update18BitInteriorValue, update18BitCompressedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 18 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+void transformNonByteAligned21Compression() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update21BitInteriorValue, update21BitCompressedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 21 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+/*
+ * Purpose:
+ *		Update a value in 16 bit byte aligned format
  */
-float update18BitCompressedValue(int i, int j, int k) {
+void update16BitAlignedValue(int i, int j, int k) {
 	float tmpValue;
 	int divisor;
 	float currentValue;
@@ -130,41 +593,88 @@ float update18BitCompressedValue(int i, int j, int k) {
 	for(fileInd=0; fileInd < numDatasets; fileInd++) {
 		tmpValue = 0.0f;
 		divisor = 0;
-		currentValue = getSingleVariableBitValue(lossy18[fileInd],stats[fileInd].var18Count,  F3D2C(150,150,0,0,0,i,j,k), 5, 12);
+		currentValue = getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j,k), 5, 10);
 
 		if(getIndex(i-1,j,k)!=-1) {
-			tmpValue+= getSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count, F3D2C(150,150,0,0,0,i-1,j,k), 5, 12);
+			tmpValue+= getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i-1,j,k), 5, 10);
 			divisor++;
 		}
 		if(getIndex(i+1,j,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count, F3D2C(150,150,0,0,0,i+1,j,k), 5, 12);
+			tmpValue+= getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i+1,j,k), 5, 10);
 			divisor++;
 		}
 		if(getIndex(i,j-1,k) != -1){
-			tmpValue+= getSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count, F3D2C(150,150,0,0,0,i,j-1,k), 5, 12);
+			tmpValue+= getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j-1,k), 5, 10);
 			divisor++;
 		}
 		if(getIndex(i,j+1,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count,  F3D2C(150,150,0,0,0,i,j+1,k), 5, 12);
+			tmpValue+= getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j+1,k), 5, 10);
 			divisor++;
 		}
 		if(getIndex(i,j,k-1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count,  F3D2C(150,150,0,0,0,i,j,k-1), 5, 12);
+			tmpValue+= getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j,k-1), 5, 10);
 			divisor++;
 		}
 		if(getIndex(i,j,k+1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count, F3D2C(150,150,0,0,0,i,j,k+1), 5, 12);
+			tmpValue+= getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j,k+1), 5, 10);
 			divisor++;
 		}
-		insertSingleVariableBitValue(lossy18[fileInd], stats[fileInd].var18Count, F3D2C(150,150,0,0,0,i,j,k), currentValue + (tmpValue/divisor), 5, 12);
+		insertSingleAligned16BitValue(aligned16Datasets[fileInd], currentValue + (tmpValue/divisor), getLayoutIndex(&layout,i,j,k), 5, 10);
+	}
+}
+
+/*
+ * Purpose:
+ *		Update an interior value (all six neighbours exist) in 16 bit byte aligned format, no bounds checks
+ */
+void update16BitAlignedInteriorValue(int i, int j, int k) {
+	size_t index = getLayoutIndex(&layout,i,j,k);
+	float tmpValue;
+	int fileInd;
+
+	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+		tmpValue = getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i-1,j,k), 5, 10) + getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i+1,j,k), 5, 10)
+			+ getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j-1,k), 5, 10) + getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j+1,k), 5, 10)
+			+ getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j,k-1), 5, 10) + getSingleAligned16BitValue(aligned16Datasets[fileInd], getLayoutIndex(&layout,i,j,k+1), 5, 10);
+		insertSingleAligned16BitValue(aligned16Datasets[fileInd], getSingleAligned16BitValue(aligned16Datasets[fileInd], index, 5, 10) + (tmpValue/6), index, 5, 10);
+	}
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on 16 bit byte aligned data and record performance
+ */
+void transformAligned16Compression() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update16BitAlignedInteriorValue, update16BitAlignedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 16 bit byte aligned data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+/*
+ * Purpose:
+ *		Get the largest difference between a compressed field and the values it was made from
+ */
+float getFieldMaxError(struct compressedField *field, float *values, unsigned int count) {
+	float *decompressed = field->codec->decompress(field->codec, field->values, field->bytes, count), maxError = 0.0f;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		maxError = fmaxf(maxError, fabsf(decompressed[i] - values[i]));
 	}
+	free(decompressed);
+	return maxError;
 }
 
 /*
  * Purpose:
- *		Update a value in 15 bit format
+ *		Update a value in fixed rate zfp format
  */
-float update15BitCompressedValue(int i, int j, int k) {
+void updateZfpFixedRateValue(int i, int j, int k) {
 	float tmpValue;
 	int divisor;
 	float currentValue;
@@ -173,41 +683,78 @@ float update15BitCompressedValue(int i, int j, int k) {
 	for(fileInd=0; fileInd < numDatasets; fileInd++) {
 		tmpValue = 0.0f;
 		divisor = 0;
-		currentValue = getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i,j,k), 5, 9);
+		currentValue = zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j, k);
 
 		if(getIndex(i-1,j,k)!=-1) {
-			tmpValue+= getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i-1,j,k), 5, 9);
+			tmpValue+= zfpArrayGet(zfpFixedRateDatasets[fileInd], i-1, j, k);
 			divisor++;
 		}
 		if(getIndex(i+1,j,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i+1,j,k), 5, 9);
+			tmpValue+= zfpArrayGet(zfpFixedRateDatasets[fileInd], i+1, j, k);
 			divisor++;
 		}
 		if(getIndex(i,j-1,k) != -1){
-			tmpValue+= getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i,j-1,k), 5, 9);
+			tmpValue+= zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j-1, k);
 			divisor++;
 		}
 		if(getIndex(i,j+1,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i,j+1,k), 5, 9);
+			tmpValue+= zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j+1, k);
 			divisor++;
 		}
 		if(getIndex(i,j,k-1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i,j,k-1), 5, 9);
+			tmpValue+= zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j, k-1);
 			divisor++;
 		}
 		if(getIndex(i,j,k+1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i,j,k+1), 5, 9);
+			tmpValue+= zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j, k+1);
 			divisor++;
 		}
-		insertSingleVariableBitValue(lossy15[fileInd], stats[fileInd].var15Count, F3D2C(150,150,0,0,0,i,j,k), currentValue + (tmpValue/divisor), 5, 9);
+		zfpArraySet(zfpFixedRateDatasets[fileInd], i, j, k, currentValue + (tmpValue/divisor));
 	}
 }
 
 /*
  * Purpose:
- *		Update a value in 12 bit format
+ *		Update an interior value (all six neighbours exist) in fixed rate zfp format, no bounds checks
+ */
+void updateZfpFixedRateInteriorValue(int i, int j, int k) {
+	float tmpValue;
+	int fileInd;
+
+	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+		tmpValue = zfpArrayGet(zfpFixedRateDatasets[fileInd], i-1, j, k) + zfpArrayGet(zfpFixedRateDatasets[fileInd], i+1, j, k)
+			+ zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j-1, k) + zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j+1, k)
+			+ zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j, k-1) + zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j, k+1);
+		zfpArraySet(zfpFixedRateDatasets[fileInd], i, j, k, zfpArrayGet(zfpFixedRateDatasets[fileInd], i, j, k) + (tmpValue/6));
+	}
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on fixed rate zfp data and record performance, changed blocks are recompressed before the clock stops
+ */
+void transformZfpFixedRate() {
+	int rep, fileInd;
+	clock_t startTime = clock();
+
+	for(rep = 0; rep < algorithm_repeat; rep++) {
+		sweepGrid(updateZfpFixedRateInteriorValue, updateZfpFixedRateValue);
+	}
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		zfpArrayFlush(zfpFixedRateDatasets[fileInd]);
+	}
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 16 bit fixed rate zfp data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+/*
+ * Purpose:
+ *		Update a value in 24 bit format
  */
-float update12BitCompressedValue(int i, int j, int k) {
+void update24BitCompressedValue(int i, int j, int k) {
 	float tmpValue;
 	int divisor;
 	float currentValue;
@@ -216,431 +763,866 @@ float update12BitCompressedValue(int i, int j, int k) {
 	for(fileInd=0; fileInd < numDatasets; fileInd++) {
 		tmpValue = 0.0f;
 		divisor = 0;
-		currentValue = getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i,j,k), 5, 6);
+		currentValue = getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j,k), 5, 18);
 
 		if(getIndex(i-1,j,k)!=-1) {
-			tmpValue+= getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i-1,j,k), 5, 6);
+			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i-1,j,k), 5, 18);
 			divisor++;
 		}
 		if(getIndex(i+1,j,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i+1,j,k), 5, 6);
+			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i+1,j,k), 5, 18);
 			divisor++;
 		}
 		if(getIndex(i,j-1,k) != -1){
-			tmpValue+= getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i,j-1,k), 5, 6);
+			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j-1,k), 5, 18);
 			divisor++;
 		}
 		if(getIndex(i,j+1,k)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i,j+1,k), 5, 6);
+			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j+1,k), 5, 18);
 			divisor++;
 		}
 		if(getIndex(i,j,k-1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i,j,k-1), 5, 6);
+			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j,k-1), 5, 18);
 			divisor++;
 		}
-		if(getIndex(i,j,k+1)!=-1){
-			tmpValue+= getSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i,j,k+1), 5, 6);
-			divisor++;
+		if(getIndex(i,j,k+1)!=-1){
+			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j,k+1), 5, 18);
+			divisor++;
+		}
+		insertSingle24BitValue(compressed24Datasets[fileInd], currentValue + (tmpValue/divisor), getLayoutIndex(&layout,i,j,k), 5, 18);
+	}
+}
+
+/*
+ * Purpose:
+ *		Update an interior value (all six neighbours exist) in 24 bit format, no bounds checks
+ */
+void update24BitInteriorValue(int i, int j, int k) {
+	size_t index = getLayoutIndex(&layout,i,j,k);
+	float tmpValue;
+	int fileInd;
+
+	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+		tmpValue = getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i-1,j,k), 5, 18) + getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i+1,j,k), 5, 18)
+			+ getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j-1,k), 5, 18) + getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j+1,k), 5, 18)
+			+ getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j,k-1), 5, 18) + getSingle24BitValue(compressed24Datasets[fileInd], getLayoutIndex(&layout,i,j,k+1), 5, 18);
+		insertSingle24BitValue(compressed24Datasets[fileInd], getSingle24BitValue(compressed24Datasets[fileInd], index, 5, 18) + (tmpValue/6), index, 5, 18);
+	}
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on 24 bit compressed data and record performance
+ */
+void transform24BitCompression() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update24BitInteriorValue, update24BitCompressedValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 24 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+/*
+ * Purpose:
+ *		Update a value in 24 bit format using fixed point arithmetic on the compressed values (no conversion to float and back)
+ */
+void update24BitFixedPointValue(int i, int j, int k) {
+	int32_t neighbours[6];
+	int divisor;
+	int32_t currentValue;
+	int fileInd;
+
+	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+		divisor = 0;
+		currentValue = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i,j,k), 5, 18);
+
+		if(getIndex(i-1,j,k)!=-1) {
+			neighbours[divisor++] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i-1,j,k), 5, 18);
+		}
+		if(getIndex(i+1,j,k)!=-1){
+			neighbours[divisor++] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i+1,j,k), 5, 18);
+		}
+		if(getIndex(i,j-1,k) != -1){
+			neighbours[divisor++] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i,j-1,k), 5, 18);
+		}
+		if(getIndex(i,j+1,k)!=-1){
+			neighbours[divisor++] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i,j+1,k), 5, 18);
+		}
+		if(getIndex(i,j,k-1)!=-1){
+			neighbours[divisor++] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i,j,k-1), 5, 18);
+		}
+		if(getIndex(i,j,k+1)!=-1){
+			neighbours[divisor++] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], getLayoutIndex(&layout,i,j,k+1), 5, 18);
+		}
+		insertSingle24BitFixedValue(compressed24FixedDatasets[fileInd], fixedPointAdd(currentValue, fixedPointAverage(neighbours, divisor)), getLayoutIndex(&layout,i,j,k), 5, 18);
+	}
+}
+
+/*
+ * Purpose:
+ *		Update an interior value (all six neighbours exist) in 24 bit format using fixed point arithmetic, no bounds checks
+ */
+void update24BitFixedPointInteriorValue(int i, int j, int k) {
+	size_t index = getLayoutIndex(&layout,i,j,k);
+	size_t offsets[6] = {getLayoutIndex(&layout,i-1,j,k), getLayoutIndex(&layout,i+1,j,k), getLayoutIndex(&layout,i,j-1,k), getLayoutIndex(&layout,i,j+1,k), getLayoutIndex(&layout,i,j,k-1), getLayoutIndex(&layout,i,j,k+1)};
+	int32_t neighbours[6];
+	int fileInd, n;
+
+	for(fileInd=0; fileInd < numDatasets; fileInd++) {
+		for(n = 0; n < 6; n++) {
+			neighbours[n] = getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], offsets[n], 5, 18);
+		}
+		insertSingle24BitFixedValue(compressed24FixedDatasets[fileInd], fixedPointAdd(getSingle24BitFixedValue(compressed24FixedDatasets[fileInd], index, 5, 18), fixedPointAverage(neighbours, 6)), index, 5, 18);
+	}
+}
+
+/*
+ * Purpose:
+ *		Perform transformation algorithm on 24 bit compressed data using compressed domain fixed point arithmetic and record performance
+ */
+void transform24BitFixedPoint() {
+	clock_t startTime = clock();
+
+	repeatSweeps(update24BitFixedPointInteriorValue, update24BitFixedPointValue);
+
+	clock_t endTime = clock();
+	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+
+	printf("Time taken for algorithm on 24 bit compressed data with fixed point arithmetic (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+}
+
+/*
+ * Purpose:
+ *		Report the largest difference between the float and fixed point 24 bit stencil results (run after both transforms)
+ */
+void compareFixedPointResults() {
+	int fileInd;
+	unsigned int i;
+	float maxDifference = 0.0f;
+	float difference;
+
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		for(i = 0; i < stats[fileInd].uncompressedCount; i++) {
+			difference = fabs(getSingle24BitValue(compressed24Datasets[fileInd], i, 5, 18) - getSingle24BitValue(compressed24FixedDatasets[fileInd], i, 5, 18));
+			if(difference > maxDifference) {
+				maxDifference = difference;
+			}
+		}
+	}
+	printf("Largest difference between float and fixed point 24 bit results: %f\n", maxDifference);
+}
+
+/*
+ * Purpose:
+ *		Convert the total time a codec took over every dataset and repeat into throughput on the uncompressed data
+ * Returns:
+ *		Megabytes of uncompressed floats processed per second
+ * Parameters:
+ *		1. totalSeconds - Total time spent across all datasets and repeats
+ */
+double getThroughput(double totalSeconds) {
+	double bytes = 0;
+	int i;
+
+	for(i = 0; i < numDatasets; i++) {
+		bytes += (double) stats[i].uncompressedCount * sizeof(float);
+	}
+	return (bytes * repeat / 1e6) / totalSeconds;
+}
+
+/*
+ * Purpose:
+ *		Compress a dataset in the order it was read (zfp needs the field shape) through the ZFP lossless context held by the codec
+ */
+unsigned char *compressZfpCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	const unsigned char *buffer;
+
+	*bytes = zfpCompressWithContext(codec->context, values, grid.nx, grid.ny, grid.nz, &buffer);
+	return memcpy(malloc(*bytes), buffer, *bytes); //the context reuses its buffer
+}
+
+/*
+ * Purpose:
+ *		Decompress a dataset compressed by compressZfpCodec
+ */
+float *decompressZfpCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	float *values = malloc((size_t) count * sizeof(float));
+
+	if(zfpDecompressWithContext(codec->context, compressed, bytes, values, grid.nx, grid.ny, grid.nz) != 0) {
+		free(values);
+		return NULL;
+	}
+	return values;
+}
+
+struct codec zfpCodec = {.name = "ZFP", .lossless = 1, .compress = compressZfpCodec, .decompress = decompressZfpCodec}; //context set once zfpLossless exists
+struct codec xorPlaneCodec; //XOR predictive codec predicting from the previous k plane, set up once the grid is known
+
+/*
+ * Purpose:
+ *		Register the codecs that depend on the grid or on zfp, the rest are built into compressor.c
+ */
+void registerAnalysisCodecs() {
+	xorPlaneCodec = *findCodec("XOR Predictive (previous value)");
+	xorPlaneCodec.name = "XOR Predictive (previous plane)";
+	xorPlaneCodec.parameter = grid.sz;
+	registerCodec(&xorPlaneCodec);
+	zfpCodec.context = zfpLossless;
+	registerCodec(&zfpCodec);
+}
+
+/*
+ * Purpose:
+ *		Time compressing every dataset with every registered codec
+ */
+void compressionSpeedAnalysis() {
+	unsigned int codecCount = getCodecCount();
+	double *totals = calloc(codecCount, sizeof(double));
+	const struct codec *codec;
+	unsigned int c;
+	size_t bytes;
+	clock_t start;
+	int i, rep;
+
+	for(rep = 0; rep < repeat; rep++) {
+		for(i = 0; i < numDatasets; i++) {
+			for(c = 0; c < codecCount; c++) {
+				codec = getCodec(c);
+				start = clock();
+				free(codec->compress(codec, datasets[i], stats[i].uncompressedCount, &bytes));
+				totals[c]+= (double)(clock() - start);
+			}
+		}
+	}
+	printf("Average compression times\n");
+	for(c = 0; c < codecCount; c++) {
+		printf("%s: %f seconds\n", getCodec(c)->name, (totals[c]/(numDatasets*repeat))/CLOCKS_PER_SEC);
+	}
+	printf("Lossless compression throughput\n");
+	for(c = 0; c < codecCount; c++) {
+		if(getCodec(c)->lossless) {
+			printf("%s: %.1f MB/s\n", getCodec(c)->name, getThroughput(totals[c]/CLOCKS_PER_SEC));
+		}
+	}
+	free(totals);
+}
+
+/*
+ * Purpose:
+ *		Compress every dataset once with every registered codec, then time decompressing them
+ */
+void decompressionSpeedAnalysis() {
+	unsigned int codecCount = getCodecCount();
+	double *totals = calloc(codecCount, sizeof(double));
+	unsigned char **compressed = malloc(codecCount * numDatasets * sizeof(unsigned char *));
+	size_t *bytes = malloc(codecCount * numDatasets * sizeof(size_t));
+	const struct codec *codec;
+	unsigned int c;
+	clock_t start;
+	int i, rep;
+
+	for(c = 0; c < codecCount; c++) {
+		codec = getCodec(c);
+		for(i = 0; i < numDatasets; i++) {
+			compressed[c*numDatasets + i] = codec->compress(codec, datasets[i], stats[i].uncompressedCount, &bytes[c*numDatasets + i]);
+		}
+	}
+	for(rep = 0; rep < repeat; rep++) {
+		for(i = 0; i < numDatasets; i++) {
+			for(c = 0; c < codecCount; c++) {
+				codec = getCodec(c);
+				start = clock();
+				free(codec->decompress(codec, compressed[c*numDatasets + i], bytes[c*numDatasets + i], stats[i].uncompressedCount));
+				totals[c]+= (double) (clock() - start);
+			}
+		}
+	}
+	printf("Average Decompression times\n");
+	for(c = 0; c < codecCount; c++) {
+		printf("%s: %f seconds\n", getCodec(c)->name, (totals[c]/(numDatasets*repeat))/CLOCKS_PER_SEC);
+	}
+	printf("Lossless decompression throughput\n");
+	for(c = 0; c < codecCount; c++) {
+		if(getCodec(c)->lossless) {
+			printf("%s: %.1f MB/s\n", getCodec(c)->name, getThroughput(totals[c]/CLOCKS_PER_SEC));
 		}
-		insertSingleVariableBitValue(lossy12[fileInd], stats[fileInd].var12Count, F3D2C(150,150,0,0,0,i,j,k), currentValue + (tmpValue/divisor), 5, 6);
 	}
+	for(i = 0; i < codecCount * numDatasets; i++) {
+		free(compressed[i]);
+	}
+	free(compressed);
+	free(bytes);
+	free(totals);
 }
 
-
-
+#define ENTROPY_FORMATS 8
+static const char *entropyFormatNames[ENTROPY_FORMATS] = {"Variable 21 Bit", "Variable 18 Bit", "Variable 15 Bit", "Variable 12 Bit",
+	"24 Bit byte shuffled", "24 Bit bit shuffled", "32 Bit float byte shuffled", "32 Bit float bit shuffled"};
 
 /*
  * Purpose:
- *		Update item in uncompressed float array given an index in 3-d space 
+ *		Get the bytes one of the entropy analysis formats gives the entropy stage for a dataset
+ * Returns:
+ *		The bytes, packed records or the byte/bit planes of fixed width records
  * Parameters:
- *		1. i - index
- *		2. j - index
- *		3. k - index
+ *		1. format - Index into entropyFormatNames
+ *		2. dataset - Index of the dataset
+ *		3. bytes - Gets the number of bytes returned
  */
-void updateUncompressedValue(int i, int j, int k) {
-	float tmpValue;
-	int divisor ;
-	float currentValue;
-	int fileInd;
-
-	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
-		tmpValue = 0.0f;
-		divisor = 0;
-		currentValue = datasets[fileInd][F3D2C(150,150,0,0,0,i,j,k)];
-
-		if(getIndex(i-1,j,k)!=-1) {
-			tmpValue+=datasets[fileInd][F3D2C(150,150,0,0,0,i-1,j,k)];
-			divisor++;
-		}
-		if(getIndex(i+1,j,k)!=-1){
-			tmpValue+=datasets[fileInd][F3D2C(150,150,0,0,0,i+1,j,k)];
-			divisor++;
-		}
-		if(getIndex(i,j-1,k) != -1){
-			tmpValue+=datasets[fileInd][F3D2C(150,150,0,0,0,i,j-1,k)];
-			divisor++;
-		}
-		if(getIndex(i,j+1,k)!=-1){
-			tmpValue+=datasets[fileInd][F3D2C(150,150,0,0,0,i,j+1,k)];
-			divisor++;
-		}
-		if(getIndex(i,j,k-1)!=-1){
-			tmpValue+=datasets[fileInd][F3D2C(150,150,0,0,0,i,j,k-1)];
-			divisor++;
-		}
-		if(getIndex(i,j,k+1)!=-1){
-			tmpValue+=datasets[fileInd][F3D2C(150,150,0,0,0,i,j,k+1)];
-			divisor++;
+unsigned char *getEntropyFormatBytes(int format, int dataset, size_t *bytes) {
+	unsigned int precBits[4] = {15, 12, 9, 6};
+	unsigned int count = stats[dataset].uncompressedCount, newCount;
+	unsigned char *records, *planes, *scratch;
+
+	if(format < 4) {
+		records = getVariableBitCompressedData(datasets[dataset], count, &newCount, 5, precBits[format]);
+		*bytes = newCount;
+		return records;
+	}
+	if(format < 6) {
+		records = (unsigned char *) get24BitCompressedData(datasets[dataset], count, 5, 18);
+		*bytes = (size_t) count * sizeof(struct compressedVal);
+	} else {
+		records = (unsigned char *) datasets[dataset];
+		*bytes = (size_t) count * sizeof(float);
+	}
+	planes = malloc(*bytes);
+	if(format == 4 || format == 6) {
+		shuffleBytes(records, count, *bytes / count, planes);
+	} else {
+		scratch = format < 6 ? records : malloc(*bytes); //the raw datasets are kept
+		shuffleBits(records, count, *bytes / count, planes, scratch);
+		if(scratch != records) {
+			free(scratch);
 		}
-		datasets[fileInd][F3D2C(150,150,0,0,0,i,j,k)]=currentValue+(tmpValue/divisor);
 	}
+	if(format < 6) {
+		free(records);
+	}
+	return planes;
 }
 
 /*
  * Purpose:
- *		Perform transformation algorithm on uncompressed floating point data and record performance
+ *		Show what the rANS entropy stage adds on top of the packed formats and the byte/bit shuffled fixed width ones: the size before and
+ *		after, and how fast the entropy stage decodes (in MB/s of the bytes it gives back, so it can be set against the ratio gain)
  */
-void transformUncompressed() {
-	int i, j, k, rep;
-	clock_t startTime = clock();
+void entropyAnalysis() {
+	unsigned char *packed, *coded, *decoded;
+	size_t packedBytes, codedBytes, decodedBytes;
+	double baseTotal, codedTotal, decodeTotal;
+	clock_t start;
+	int f, i, rep;
 
-	for(rep = 0; rep < algorithm_repeat; rep++) {
-		for(i = 0; i < 150; i++) {
-			for(j = 0; j < 150; j++) {
-				for(k = 0; k < 90; k++) {
-					updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
-					// updateUncompressedValue(i,j,k);
+	printf("Entropy coding (rANS) on top of the packed formats\n");
+	for(f = 0; f < ENTROPY_FORMATS; f++) {
+		baseTotal = codedTotal = decodeTotal = 0;
+		for(i = 0; i < numDatasets; i++) {
+			packed = getEntropyFormatBytes(f, i, &packedBytes);
+			coded = getEntropyCompressedData(packed, packedBytes, &codedBytes);
+			for(rep = 0; rep < repeat; rep++) {
+				start = clock();
+				decoded = getEntropyDecompressedData(coded, codedBytes, &decodedBytes);
+				decodeTotal += (double) (clock() - start);
+				if(decoded == NULL || decodedBytes != packedBytes || memcmp(decoded, packed, packedBytes) != 0) {
+					printf("Entropy stage didnt round trip on dataset %d\n", i);
 				}
+				free(decoded);
 			}
+			baseTotal += packedBytes;
+			codedTotal += codedBytes;
+			free(packed);
+			free(coded);
 		}
+		printf("%s: %.0f -> %.0f bytes, ratio gain %.3f, decode %.1f MB/s\n", entropyFormatNames[f], baseTotal, codedTotal,
+			baseTotal / codedTotal, (baseTotal * repeat / 1e6) / (decodeTotal / CLOCKS_PER_SEC));
 	}
-
-	clock_t endTime = clock();
-	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
-
-	printf("Time taken for algorithm on uncompressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
 }
 
-void transformNonByteAligned12Compression() {
-	int i, j, k, rep;
-	clock_t startTime = clock();
+/*
+ * Purpose:
+ *		Time the byte and bit shuffles and their inverses on the raw float datasets with the selected kernels
+ */
+void shuffleAnalysis() {
+	double totals[4] = {0};
+	const char *names[4] = {"Byte shuffle", "Byte unshuffle", "Bit shuffle", "Bit unshuffle"};
+	unsigned char *planes, *back, *scratch;
+	unsigned int count;
+	clock_t start;
+	int i, rep, t;
 
-	for(rep = 0; rep < algorithm_repeat; rep++) {
-		for(i = 0; i < 150; i++) {
-			for(j = 0; j < 150; j++) {
-				for(k = 0; k < 90; k++) {
-					update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-					// update12BitCompressedValue(i,j,k);
-				}
-			}
+	for(i = 0; i < numDatasets; i++) {
+		count = stats[i].uncompressedCount;
+		planes = malloc((size_t) count * sizeof(float));
+		back = malloc((size_t) count * sizeof(float));
+		scratch = malloc((size_t) count * sizeof(float));
+		for(rep = 0; rep < repeat; rep++) {
+			start = clock();
+			shuffleBytes((unsigned char *) datasets[i], count, sizeof(float), planes);
+			totals[0] += (double) (clock() - start);
+			start = clock();
+			unshuffleBytes(planes, count, sizeof(float), back);
+			totals[1] += (double) (clock() - start);
+			start = clock();
+			shuffleBits((unsigned char *) datasets[i], count, sizeof(float), planes, scratch);
+			totals[2] += (double) (clock() - start);
+			start = clock();
+			unshuffleBits(planes, count, sizeof(float), back, scratch);
+			totals[3] += (double) (clock() - start);
 		}
+		if(memcmp(back, datasets[i], (size_t) count * sizeof(float)) != 0) {
+			printf("Bit shuffle didnt round trip on dataset %d\n", i);
+		}
+		free(planes);
+		free(back);
+		free(scratch);
+	}
+	printf("Shuffle throughput (%s kernels)\n", getIsaName(getKernelIsa()));
+	for(t = 0; t < 4; t++) {
+		printf("%s: %.1f MB/s\n", names[t], getThroughput(totals[t]/CLOCKS_PER_SEC));
 	}
+}
 
-	clock_t endTime = clock();
-	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
+/*
+ * Purpose:
+ *		Get the wall clock time, used where work is spread across threads (clock() adds up the time of every thread)
+ * Returns:
+ *		Seconds since an arbitrary fixed point
+ */
+double getWallTime() {
+	struct timespec now;
 
-	printf("Time taken for algorithm on 12 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
 }
 
-void transformNonByteAligned15Compression() {
-	int i, j, k, rep;
-	clock_t startTime = clock();
+/*
+ * Purpose:
+ *		Rebuild every array the stencils update (uncompressed, 24 bit, fixed point 24 bit, 16 bit aligned, variable bit, half float, codebook) from the original
+ *		datasets, stored in the given layout. Unused slots at the edge of brick layouts are compressed too.
+ */
+void prepareStencilData(enum fieldLayoutType type) {
+	int i;
 
-	for(rep = 0; rep < algorithm_repeat; rep++) {
-		for(i = 0; i < 150; i++) {
-			for(j = 0; j < 150; j++) {
-				for(k = 0; k < 90; k++) {
-					update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-					// update15BitCompressedValue(i,j,k);
-				}
-			}
-		}
+	freeFieldLayout(&layout);
+	layout = getFieldLayout(&grid, type);
+	for(i = 0; i < numDatasets; i++) {
+		free(datasets[i]);
+		free(compressed24Datasets[i]);
+		free(compressed24FixedDatasets[i]);
+		free(aligned16Datasets[i]);
+		freeCompressedField(&lossy21[i]);
+		freeCompressedField(&lossy18[i]);
+		freeCompressedField(&lossy15[i]);
+		freeCompressedField(&lossy12[i]);
+		freeCompressedField(&halfFloat[i]);
+		freeCompressedField(&bfloat16[i]);
+		freeCompressedField(&codebook8[i]);
+		freeCompressedField(&codebook16[i]);
+		datasets[i] = getLayoutData(originalDatasets[i], &fields[i], &layout);
+		compressed24Datasets[i] = get24BitCompressedData(datasets[i], layout.storageCount, 5, 18);
+		compressed24FixedDatasets[i] = get24BitCompressedData(datasets[i], layout.storageCount, 5, 18);
+		aligned16Datasets[i] = getAligned16BitCompressedData(datasets[i], layout.storageCount, 5, 10);
+		lossy21[i] = getCompressedField(findCodec("21 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		lossy18[i] = getCompressedField(findCodec("18 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		lossy15[i] = getCompressedField(findCodec("15 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		lossy12[i] = getCompressedField(findCodec("12 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		halfFloat[i] = getCompressedField(findCodec("16 Bit Half Float"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		bfloat16[i] = getCompressedField(findCodec("16 Bit BFloat16"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		codebook8[i] = getCompressedField(findCodec("8 Bit Codebook"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		codebook16[i] = getCompressedField(findCodec("16 Bit Codebook"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
 	}
-
-	clock_t endTime = clock();
-	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
-
-	printf("Time taken for algorithm on 15 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
 }
 
-void transformNonByteAligned18Compression() {
-	int i, j, k, rep;
-	clock_t startTime = clock();
+#define STENCIL_FORMATS 12 //formats with in place stencil updates, zfp is left out of the analyses below as its block cache is shared state
+const char *stencilNames[STENCIL_FORMATS] = {"uncompressed", "24 bit", "24 bit fixed point", "16 bit byte aligned", "21 bit", "18 bit", "15 bit", "12 bit",
+	"16 bit half float", "16 bit bfloat16", "8 bit codebook", "16 bit codebook"};
+pointUpdate interiorUpdates[STENCIL_FORMATS] = {updateUncompressedInteriorValue, update24BitInteriorValue, update24BitFixedPointInteriorValue, update16BitAlignedInteriorValue,
+	update21BitInteriorValue, update18BitInteriorValue, update15BitInteriorValue, update12BitInteriorValue, updateHalfFloatInteriorValue, updateBFloat16InteriorValue,
+	updateCodebook8InteriorValue, updateCodebook16InteriorValue};
+pointUpdate boundaryUpdates[STENCIL_FORMATS] = {updateUncompressedValue, update24BitCompressedValue, update24BitFixedPointValue, update16BitAlignedValue,
+	update21BitCompressedValue, update18BitCompressedValue, update15BitCompressedValue, update12BitCompressedValue, updateHalfFloatValue, updateBFloat16Value,
+	updateCodebook8Value, updateCodebook16Value};
 
-	for(rep = 0; rep < algorithm_repeat; rep++) {
-		for(i = 0; i < 150; i++) {
-			for(j = 0; j < 150; j++) {
-				for(k = 0; k < 90; k++) {
-					update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
-					// update18BitCompressedValue(i,j,k);
+/*
+ * Purpose:
+ *		Time red-black stencil sweeps on raw floats and every compressed format the stencils update with 1 thread up to the OpenMP maximum
+ *		(one per core unless OMP_NUM_THREADS says otherwise). Each run starts from the original data. The fixed rate zfp array is left out,
+ *		its cache of decoded blocks is shared between all accesses.
+ */
+void redBlackScalingAnalysis() {
+	double serialSeconds[STENCIL_FORMATS];
+	double start, seconds;
+	float *serialResult = malloc(layout.storageCount * sizeof(float));
+	float maxDifference = 0.0f;
+	int maxThreads = 1;
+	int threads, format, rep;
+	size_t i;
+
+#ifdef _OPENMP
+	maxThreads = omp_get_max_threads();
+#endif
+	printf("\nRed-black stencil thread scaling (%s layout)\n", layout.type == LAYOUT_LINEAR ? "linear" : layout.type == LAYOUT_BRICK ? "brick" : "Morton");
+	for(threads = 1; threads <= maxThreads; threads++) {
+		for(format = 0; format < STENCIL_FORMATS; format++) {
+			prepareStencilData(layout.type);
+			start = getWallTime();
+			for(rep = 0; rep < algorithm_repeat; rep++) {
+				redBlackSweep(interiorUpdates[format], boundaryUpdates[format], threads);
+			}
+			seconds = (getWallTime() - start) / algorithm_repeat;
+			if(threads == 1) {
+				serialSeconds[format] = seconds;
+			}
+			if(format == 0 && threads == 1) {
+				memcpy(serialResult, datasets[0], layout.storageCount * sizeof(float));
+			} else if(format == 0) { //the colouring makes every thread count give the same answer
+				for(i = 0; i < layout.storageCount; i++) {
+					maxDifference = fmaxf(maxDifference, fabsf(serialResult[i] - datasets[0][i]));
 				}
 			}
+			printf("%d thread(s), %s: %f seconds, speedup %.2f\n", threads, stencilNames[format], seconds, serialSeconds[format] / seconds);
 		}
 	}
-
-	clock_t endTime = clock();
-	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
-
-	printf("Time taken for algorithm on 18 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+	printf("Largest difference between single and multi-threaded red-black results: %f\n", maxDifference);
+	free(serialResult);
 }
 
-void transformNonByteAligned21Compression() {
-	int i, j, k, rep;
-	clock_t startTime = clock();
+/*
+ * Purpose:
+ *		Compute plane k of a Jacobi stencil step, each point plus the mean of its existing neighbours with every value read from the previous step
+ * Parameters:
+ *		1. below - plane k-1 of the previous step, NULL for the first plane
+ *		2. current - plane k of the previous step
+ *		3. above - plane k+1 of the previous step, NULL for the last plane
+ *		4. out - grid.nx*grid.ny floats for plane k of the new step
+ */
+void jacobiPlane(const float *below, const float *current, const float *above, float *out) {
+	int i, j, divisor;
+	size_t index;
+	float tmpValue;
 
-	for(rep = 0; rep < algorithm_repeat; rep++) {
-		for(i = 0; i < 150; i++) {
-			for(j = 0; j < 150; j++) {
-				for(k = 0; k < 90; k++) {
-					//printf("%d %d %d\n", i,j,k);
-					update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-					// update21BitCompressedValue(i,j,k);
-				}
+	for(j = 0; j < grid.ny; j++) {
+		for(i = 0; i < grid.nx; i++) {
+			index = (size_t) j*grid.nx + i;
+			tmpValue = 0.0f;
+			divisor = 0;
+			if(i > 0) {
+				tmpValue += current[index-1];
+				divisor++;
 			}
+			if(i < grid.nx-1) {
+				tmpValue += current[index+1];
+				divisor++;
+			}
+			if(j > 0) {
+				tmpValue += current[index-grid.nx];
+				divisor++;
+			}
+			if(j < grid.ny-1) {
+				tmpValue += current[index+grid.nx];
+				divisor++;
+			}
+			if(below) {
+				tmpValue += below[index];
+				divisor++;
+			}
+			if(above) {
+				tmpValue += above[index];
+				divisor++;
+			}
+			out[index] = current[index] + (tmpValue/divisor);
 		}
 	}
-
-	clock_t endTime = clock();
-	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
-
-	printf("Time taken for algorithm on 21 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
 }
 
 /*
  * Purpose:
- *		Update a value in 24 bit format
+ *		Run one Jacobi step on raw floats stored in the linear layout, reading source and writing destination
  */
-float update24BitCompressedValue(int i, int j, int k) {
-	float tmpValue;
-	int divisor;
-	float currentValue;
-	int fileInd;
+void jacobiStepUncompressed(const float *source, float *destination) {
+	size_t planeSize = (size_t) grid.nx*grid.ny;
+	int k;
 
-	for(fileInd=0; fileInd < numDatasets; fileInd++) {
-		tmpValue = 0.0f;
-		divisor = 0;
-		currentValue = getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i,j,k), 5, 18);
+	for(k = 0; k < grid.nz; k++) {
+		jacobiPlane(k > 0 ? source + (k-1)*planeSize : NULL, source + k*planeSize, k < grid.nz-1 ? source + (k+1)*planeSize : NULL, destination + k*planeSize);
+	}
+}
 
-		if(getIndex(i-1,j,k)!=-1) {
-			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i-1,j,k), 5, 18);
-			divisor++;
-		}
-		if(getIndex(i+1,j,k)!=-1){
-			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i+1,j,k), 5, 18);
-			divisor++;
-		}
-		if(getIndex(i,j-1,k) != -1){
-			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i,j-1,k), 5, 18);
-			divisor++;
-		}
-		if(getIndex(i,j+1,k)!=-1){
-			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i,j+1,k), 5, 18);
-			divisor++;
-		}
-		if(getIndex(i,j,k-1)!=-1){
-			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i,j,k-1), 5, 18);
-			divisor++;
-		}
-		if(getIndex(i,j,k+1)!=-1){
-			tmpValue+= getSingle24BitValue(compressed24Datasets[fileInd], F3D2C(150,150,0,0,0,i,j,k+1), 5, 18);
-			divisor++;
+/*
+ * Purpose:
+ *		Run one Jacobi step on a variable bit compressed field stored in the linear layout. The source is decoded one plane ahead of the plane
+ *		being updated and each new plane is streamed into destination, so every record is decoded once and encoded once with no random access.
+ * Parameters:
+ *		1. source - compressed field from the previous step
+ *		2. destination - array of byteCount bytes the new step is compressed into, its old contents are overwritten
+ *		3. byteCount - bytes in source and destination
+ *		4. magBits - Number of bits used to represent magnitude
+ *		5. precBits - Number of bits used to represent precision
+ *		6. planes - room for 3 planes of floats, the decoded planes k-1, k and k+1 are kept at (plane % 3)
+ *		7. out - room for 1 plane of floats
+ */
+void jacobiStepVariableBit(unsigned char *source, unsigned char *destination, unsigned int byteCount, unsigned int magBits, unsigned int precBits, float *planes, float *out) {
+	size_t planeSize = (size_t) grid.nx*grid.ny;
+	struct variableBitStream reader, writer;
+	int k;
+
+	startVariableBitStream(&reader, source, byteCount, magBits, precBits);
+	startVariableBitStream(&writer, destination, byteCount, magBits, precBits);
+	for(k = 0; k < 2 && k < grid.nz; k++) {
+		readVariableBitValues(&reader, planes + k*planeSize, planeSize);
+	}
+	for(k = 0; k < grid.nz; k++) {
+		jacobiPlane(k > 0 ? planes + ((k+2)%3)*planeSize : NULL, planes + (k%3)*planeSize, k < grid.nz-1 ? planes + ((k+1)%3)*planeSize : NULL, out);
+		writeVariableBitValues(&writer, out, planeSize);
+		if(k+2 < grid.nz) { //plane k-1 is no longer needed
+			readVariableBitValues(&reader, planes + ((k+2)%3)*planeSize, planeSize);
 		}
-		insertSingle24BitValue(compressed24Datasets[fileInd], currentValue + (tmpValue/divisor), F3D2C(150,150,0,0,0,i,j,k), 5, 18);
 	}
+	flushVariableBitStream(&writer);
 }
 
 /*
  * Purpose:
- *		Perform transformation algorithm on 24 bit compressed data and record performance
+ *		Time double buffered Jacobi sweeps on raw floats and the variable bit formats, starting from the original data in the linear layout.
+ *		Each step reads one buffer and writes the other (streamed through the sequential bit writer for compressed data), then the buffers
+ *		swap. Reports the largest difference between each compressed result and the raw float result.
  */
-void transform24BitCompression() {
-	int i, j, k, rep;
-	clock_t startTime = clock();
-
-	for(rep = 0; rep < algorithm_repeat; rep++) {
-		for(i = 0; i < 150; i++) {
-			for(j = 0; j < 150; j++) {
-				for(k = 0; k < 90; k++) {
-					//printf("%d %d %d\n", i,j,k);
-					update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-					// update24BitCompressedValue(i,j,k);
-				}
+void jacobiAnalysis() {
+	const char *names[4] = {"21 bit", "18 bit", "15 bit", "12 bit"};
+	struct compressedField *lossyFields[4] = {lossy21, lossy18, lossy15, lossy12};
+	unsigned int precBits[4] = {15, 12, 9, 6};
+	size_t planeSize = (size_t) grid.nx*grid.ny;
+	float *planes = malloc(3*planeSize*sizeof(float));
+	float *out = malloc(planeSize*sizeof(float));
+	float *decoded, *nextValues, *swapValues;
+	unsigned char *nextBytes, *swapBytes;
+	struct variableBitStream reader;
+	float maxDifference;
+	int format, fileInd, rep;
+	size_t i;
+	clock_t startTime;
+
+	prepareStencilData(LAYOUT_LINEAR); //streaming walks the planes in storage order
+	decoded = malloc(layout.storageCount*sizeof(float));
+	printf("\nDouble buffered Jacobi stencil\n");
+	startTime = clock();
+	for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+		nextValues = malloc(layout.storageCount*sizeof(float));
+		for(rep = 0; rep < algorithm_repeat; rep++) {
+			jacobiStepUncompressed(datasets[fileInd], nextValues);
+			swapValues = datasets[fileInd];
+			datasets[fileInd] = nextValues;
+			nextValues = swapValues;
+		}
+		free(nextValues);
+	}
+	printf("Time taken for Jacobi algorithm on uncompressed data (averaged over %d interations)  = %f\n", algorithm_repeat, (double)(clock() - startTime) / CLOCKS_PER_SEC / algorithm_repeat);
+
+	for(format = 0; format < 4; format++) {
+		maxDifference = 0.0f;
+		startTime = clock();
+		for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+			struct compressedField *field = &lossyFields[format][fileInd];
+			nextBytes = malloc(field->bytes);
+			for(rep = 0; rep < algorithm_repeat; rep++) {
+				jacobiStepVariableBit(field->values, nextBytes, field->bytes, 5, precBits[format], planes, out);
+				swapBytes = field->values;
+				field->values = nextBytes;
+				nextBytes = swapBytes;
+			}
+			free(nextBytes);
+		}
+		printf("Time taken for Jacobi algorithm on %s compressed data, streamed (averaged over %d interations)  = %f\n", names[format], algorithm_repeat, (double)(clock() - startTime) / CLOCKS_PER_SEC / algorithm_repeat);
+		for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+			startVariableBitStream(&reader, lossyFields[format][fileInd].values, lossyFields[format][fileInd].bytes, 5, precBits[format]);
+			readVariableBitValues(&reader, decoded, layout.storageCount);
+			for(i = 0; i < layout.storageCount; i++) {
+				maxDifference = fmaxf(maxDifference, fabsf(decoded[i] - datasets[fileInd][i]));
 			}
 		}
+		printf("Largest difference between %s and uncompressed Jacobi results: %f\n", names[format], maxDifference);
 	}
-
-	clock_t endTime = clock();
-	double time_spent = (double)(endTime - startTime) / CLOCKS_PER_SEC;
-
-	printf("Time taken for algorithm on 24 bit compressed data (averaged over %d interations)  = %f\n", algorithm_repeat, time_spent/algorithm_repeat);
+	free(planes);
+	free(out);
+	free(decoded);
 }
 
-void compressionSpeedAnalysis() {
-	int i;
-	double rlTotal = 0;
-	double zfpTotal = 0;
-	double lossy24BitTotal = 0;
-	double lossy21BitTotal = 0;
-	float lossy18BitTotal = 0;
-	double lossy15BitTotal = 0;
-	double lossy12BitTotal = 0;
-	clock_t start;
-	int rep;
-
-	for(rep = 0; rep < repeat; rep++) {
-		for(i = 0; i < numDatasets; i++) {
-			start = clock();
-			getRunlengthCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].runlengthCount);
-			rlTotal+= (double)(clock() - start);
-
-			start = clock();
-			zfpCompress(datasets[i], 150, 150, 90, 0.00, 0);
-			zfpTotal+= (double)(clock() - start);
-
-			start = clock();
-			get24BitCompressedData(datasets[i], stats[i].uncompressedCount, 5, 18);
-			lossy24BitTotal+= (double) (clock() - start);
-
-			start = clock();
-			getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].variableCount, 5, 15);
-			lossy21BitTotal+= (double) (clock() - start);
+struct compressedField *codecFields; //each dataset compressed with the codec under test
 
-			start = clock();
-			getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].variableCount, 5, 12);
-			lossy18BitTotal+= (double) (clock() - start);
+/*
+ * Purpose:
+ *		Point updates on codecFields, in the pointUpdate form the sweeps take
+ */
+void updateCodecValue(int i, int j, int k) {
+	updateFieldValue(codecFields, i, j, k);
+}
 
-			start = clock();
-			getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].variableCount, 5, 9);
-			lossy15BitTotal+= (double) (clock() - start);
+void updateCodecInteriorValue(int i, int j, int k) {
+	updateFieldInteriorValue(codecFields, i, j, k);
+}
 
-			start = clock();
-			getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].variableCount, 5, 6);
-			lossy12BitTotal+= (double) (clock() - start);
+/*
+ * Purpose:
+ *		Time the stencil on every registered codec with random access through the codec interface, starting from the original data. New
+ *		codecs show up here without any changes to this file.
+ */
+void codecStencilAnalysis() {
+	const struct codec *stencilCodec;
+	unsigned int c;
+	int fileInd;
+	clock_t startTime;
+
+	prepareStencilData(layout.type);
+	codecFields = malloc(numDatasets * sizeof(struct compressedField));
+	printf("\nStencil through the codec interface\n");
+	for(c = 0; c < getCodecCount(); c++) {
+		stencilCodec = getCodec(c);
+		if(stencilCodec->get == NULL || stencilCodec->set == NULL) {
+			continue;
+		}
+		for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+			codecFields[fileInd] = getCompressedField(stencilCodec, datasets[fileInd], grid.nx, grid.ny, grid.nz, &layout);
+		}
+		startTime = clock();
+		repeatSweeps(updateCodecInteriorValue, updateCodecValue);
+		printf("Time taken for algorithm on %s data (averaged over %d interations)  = %f\n", stencilCodec->name, algorithm_repeat, (double)(clock() - startTime) / CLOCKS_PER_SEC / algorithm_repeat);
+		for(fileInd = 0; fileInd < numDatasets; fileInd++) {
+			freeCompressedField(&codecFields[fileInd]);
 		}
 	}
-	printf("Average compression times\n");
-	printf("Runlength: %f seconds\n", (rlTotal/numDatasets*repeat)/CLOCKS_PER_SEC);
-	printf("ZFP: %f seconds\n", (zfpTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("24 Bit Lossy: %f seconds\n", (lossy24BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("21 Bit Lossy: %f seconds\n", (lossy21BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("18 Bit Lossy: %f seconds\n", (lossy18BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("15 Bit Lossy: %f seconds\n", (lossy15BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("12 Bit Lossy: %f seconds\n", (lossy12BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
+	free(codecFields);
 }
 
-void decompressionSpeedAnalysis() {
-	//for each dataset, compress it once then decompress and time
-	int i;
-	double rlTotal = 0;
-	double zfpTotal = 0;
-	double lossy24BitTotal = 0;
-	double lossy21BitTotal = 0;
-	float lossy18BitTotal = 0;
-	double lossy15BitTotal = 0;
-	double lossy12BitTotal = 0;
-	clock_t start;
-	int rep;
-
-	struct runlengthEntry **rlComp = malloc(numDatasets*sizeof(struct runlengthEntry *));
-	struct compressedVal **compressed24 = malloc(numDatasets*sizeof(struct compressedVal *));
-	unsigned char **compressed21 = malloc(numDatasets * sizeof(unsigned char *));
-	unsigned char **compressed18 = malloc(numDatasets * sizeof(unsigned char *));
-	unsigned char **compressed15 = malloc(numDatasets * sizeof(unsigned char *));
-	unsigned char **compressed12 = malloc(numDatasets * sizeof(unsigned char *));
-
-	//generate compressed versions to decompress
-	for(i = 0; i < numDatasets; i++) {
-		rlComp[i] = getRunlengthCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].runlengthCount);
-		compressed24[i] = get24BitCompressedData(datasets[i], stats[i].uncompressedCount, 5, 18);
-		compressed21[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var21Count, 5, 15);
-		compressed18[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var18Count, 5, 12);
-		compressed15[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var15Count, 5, 9);
-		compressed12[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var12Count, 5, 6);
+/*
+ * Purpose:
+ *		Get the array a stencil format updates for one dataset (in the order of stencilNames) and its size in bytes
+ */
+unsigned char *getStencilBytes(int format, int fileInd, size_t *bytes) {
+	struct compressedField *lossyFields[8] = {lossy21, lossy18, lossy15, lossy12, halfFloat, bfloat16, codebook8, codebook16};
+
+	if(format == 0) {
+		*bytes = layout.storageCount * sizeof(float);
+		return (unsigned char *) datasets[fileInd];
+	} else if(format <= 2) {
+		*bytes = (layout.storageCount + 1) * sizeof(struct compressedVal);
+		return (unsigned char *) (format == 1 ? compressed24Datasets[fileInd] : compressed24FixedDatasets[fileInd]);
+	} else if(format == 3) {
+		*bytes = layout.storageCount * 2;
+		return aligned16Datasets[fileInd];
 	}
-	unsigned int junk = 0;
-
-	for(rep = 0; rep < repeat; rep++) {
-		for(i = 0; i < numDatasets; i++) {
-			start = clock();
-			getRunlengthDecompressedData(rlComp[i], stats[i].runlengthSize, &junk);
-			rlTotal+= (double) (clock() - start);
-
-			start = clock();
-			get24BitDecompressedData(compressed24[i], stats[i].uncompressedCount, 5, 18);
-			lossy24BitTotal+= (double) (clock() - start);
-
-			start = clock();
-			getVariableBitDecompressedData(compressed21[i], stats[i].uncompressedCount, &junk, 5, 15);
-			lossy21BitTotal+= (double) (clock() - start);
+	*bytes = lossyFields[format-4][fileInd].bytes;
+	return lossyFields[format-4][fileInd].values;
+}
 
-			start = clock();
-			getVariableBitDecompressedData(compressed18[i], stats[i].uncompressedCount, &junk, 5, 12);
-			lossy18BitTotal+= (double) (clock() - start);
+/*
+ * Purpose:
+ *		Time temporal_block separate memory order sweeps against the same number of sweeps in one wavefront pass, for the linear and brick
+ *		layouts, and check the wavefront gives identical results for every format
+ */
+void temporalBlockingAnalysis() {
+	enum fieldLayoutType layouts[2] = {LAYOUT_LINEAR, LAYOUT_BRICK};
+	const char *layoutNames[2] = {"linear", "brick"};
+	enum traversalOrder defaultOrder = traversal;
+	int steps = temporal_block > 1 ? temporal_block : 2;
+	unsigned char *sweptBytes;
+	size_t bytes;
+	double sweptSeconds, blockedSeconds;
+	int run, format, rep, identical;
+	clock_t startTime;
+
+	traversal = TRAVERSE_MEMORY;
+	printf("\nTemporal blocking, %d sweeps per pass\n", steps);
+	for(run = 0; run < 2; run++) {
+		for(format = 0; format < STENCIL_FORMATS; format++) {
+			prepareStencilData(layouts[run]);
+			startTime = clock();
+			for(rep = 0; rep < steps; rep++) {
+				sweepGrid(interiorUpdates[format], boundaryUpdates[format]);
+			}
+			sweptSeconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+			sweptBytes = getStencilBytes(format, 0, &bytes);
+			sweptBytes = memcpy(malloc(bytes), sweptBytes, bytes);
+
+			prepareStencilData(layouts[run]);
+			startTime = clock();
+			wavefrontSweeps(interiorUpdates[format], boundaryUpdates[format], steps);
+			blockedSeconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+			identical = memcmp(sweptBytes, getStencilBytes(format, 0, &bytes), bytes) == 0;
+			free(sweptBytes);
+			printf("%s layout, %s: %f seconds sweep by sweep, %f seconds blocked, speedup %.2f, results %s\n", layoutNames[run], stencilNames[format],
+				sweptSeconds, blockedSeconds, sweptSeconds / blockedSeconds, identical ? "identical" : "differ");
+		}
+	}
+	traversal = defaultOrder;
+}
 
-			start = clock();
-			getVariableBitDecompressedData(compressed15[i], stats[i].uncompressedCount, &junk, 5, 9);
-			lossy15BitTotal+= (double) (clock() - start);
+/*
+ * Purpose:
+ *		Time the stencil on every codec under each storage layout and traversal order. ZFP is left out as it always stores 4x4x4 blocks.
+ */
+void layoutAnalysis() {
+	const char *layoutNames[3] = {"linear", "brick", "Morton"};
+	const char *traversalNames[2] = {"i outermost", "memory order"};
+	enum fieldLayoutType layouts[4] = {LAYOUT_LINEAR, LAYOUT_LINEAR, LAYOUT_BRICK, LAYOUT_MORTON};
+	enum traversalOrder orders[4] = {TRAVERSE_I_OUTER, TRAVERSE_MEMORY, TRAVERSE_MEMORY, TRAVERSE_MEMORY};
+	enum traversalOrder defaultOrder = traversal;
+	int run;
+
+	for(run = 0; run < 4; run++) {
+		prepareStencilData(layouts[run]);
+		traversal = orders[run];
+		printf("\nLayout: %s, traversal: %s (%lu values stored per dataset)\n", layoutNames[layouts[run]], traversalNames[orders[run]], layout.storageCount);
+		transformUncompressed();
+		transform24BitCompression();
+		transform24BitFixedPoint();
+		transformAligned16Compression();
+		transformCompressedField("16 bit half float", updateHalfFloatInteriorValue, updateHalfFloatValue);
+		transformCompressedField("16 bit bfloat16", updateBFloat16InteriorValue, updateBFloat16Value);
+		transformCompressedField("8 bit codebook", updateCodebook8InteriorValue, updateCodebook8Value);
+		transformCompressedField("16 bit codebook", updateCodebook16InteriorValue, updateCodebook16Value);
+		transformNonByteAligned21Compression();
+		transformNonByteAligned18Compression();
+		transformNonByteAligned15Compression();
+		transformNonByteAligned12Compression();
+	}
+	traversal = defaultOrder;
+}
 
-			start = clock();
-			getVariableBitDecompressedData(compressed12[i], stats[i].uncompressedCount, &junk, 5, 6);
-			lossy12BitTotal+= (double) (clock() - start);
+/*
+ * Purpose:
+ *		Report zfp compression throughput with 1 thread up to one per core, using zfp's OpenMP execution policy
+ */
+void zfpThreadScalingAnalysis() {
+	int maxThreads = 1;
+	int threads, rep, i;
+	double start, seconds, serialSeconds = 0;
+
+#ifdef _OPENMP
+	maxThreads = omp_get_num_procs();
+#endif
+	printf("ZFP compression thread scaling (chunk size %u)\n", zfp_chunk_size);
+	for(threads = 1; threads <= maxThreads; threads++) {
+		if(!zfpSetThreads(zfpLossless, threads, zfp_chunk_size) && threads > 1) {
+			printf("libzfp was built without OpenMP, only serial compression is available\n");
+			break;
+		}
+		start = getWallTime();
+		for(rep = 0; rep < repeat; rep++) {
+			for(i = 0; i < numDatasets; i++) {
+				zfpCompressWithContext(zfpLossless, datasets[i], fields[i].nx, fields[i].ny, fields[i].nz, NULL);
+			}
 		}
+		seconds = getWallTime() - start;
+		if(threads == 1) {
+			serialSeconds = seconds;
+		}
+		printf("%d thread(s): %.1f MB/s, speedup %.2f\n", threads, getThroughput(seconds), serialSeconds / seconds);
 	}
-	printf("Average Decompression times\n");
-	printf("Runlength: %f seconds\n", (rlTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("24 Bit Lossy: %f seconds\n", (lossy24BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("21 Bit Lossy: %f seconds\n", (lossy21BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("18 Bit Lossy: %f seconds\n", (lossy18BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("15 Bit Lossy: %f seconds\n", (lossy15BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
-	printf("12 Bit Lossy: %f seconds\n", (lossy12BitTotal/(numDatasets*repeat))/CLOCKS_PER_SEC);
+	zfpSetThreads(zfpLossless, 1, 0);
 }
 
 int main() {
@@ -651,73 +1633,158 @@ int main() {
 
 	stats = malloc(numDatasets * sizeof(struct fileStats));
 	datasets = malloc(numDatasets * sizeof(float *));
+	originalDatasets = malloc(numDatasets * sizeof(float *));
+	fields = malloc(numDatasets * sizeof(struct fieldDescriptor));
 	compressed24Datasets = malloc(numDatasets * sizeof(struct compressedVal *));
-	lossy21 = malloc(numDatasets * sizeof(unsigned char *));
-	lossy18 = malloc(numDatasets * sizeof(unsigned char *));
-	lossy15 = malloc(numDatasets * sizeof(unsigned char *));
-	lossy12 = malloc(numDatasets * sizeof(unsigned char *));
+	compressed24FixedDatasets = malloc(numDatasets * sizeof(struct compressedVal *));
+	lossy21 = malloc(numDatasets * sizeof(struct compressedField));
+	lossy18 = malloc(numDatasets * sizeof(struct compressedField));
+	lossy15 = malloc(numDatasets * sizeof(struct compressedField));
+	lossy12 = malloc(numDatasets * sizeof(struct compressedField));
+	halfFloat = malloc(numDatasets * sizeof(struct compressedField));
+	bfloat16 = malloc(numDatasets * sizeof(struct compressedField));
+	codebook8 = malloc(numDatasets * sizeof(struct compressedField));
+	codebook16 = malloc(numDatasets * sizeof(struct compressedField));
+	aligned16Datasets = malloc(numDatasets * sizeof(unsigned char *));
+	zfpLossless = zfpCreateContext(0.00);
+	zfpFixedRateDatasets = malloc(numDatasets * sizeof(struct zfpArray *));
 	
 	int i;
 	printf("Reading in datasets...\n"); //grab uncompressed data and generate stats
 	for(i = 0; i < numDatasets; i++) {
-		struct fileStats entry = { .maxVal = 0.0, .minVal = 0.0, .avgVal = 0.0, .variableCount = 0, .var21Count=0, .var18Count = 0, .var15Count = 0, .var12Count = 0, .uncompressedCount = 0, .runlengthCount = 0, .size24 = 0, .zfpSize = 0, .runlengthSize = 0};
+		struct fileStats entry = { .maxVal = 0.0, .minVal = 0.0, .avgVal = 0.0, .variableCount = 0, .uncompressedCount = 0, .runlengthCount = 0, .size24 = 0, .zfpSize = 0, .runlengthSize = 0, .xorCount = 0, .xorPlaneCount = 0};
 		stats[i] = entry;
 		datasets[i] = getData(files[i], &stats[i].uncompressedCount, &stats[i].maxVal, &stats[i].minVal, &stats[i].avgVal);
 		printf("Basic stats for file: %s\nNumber of values: %d, Max value: %f, Min value: %f, Average value: %f\n", files[i], stats[i].uncompressedCount, stats[i].maxVal, stats[i].minVal, stats[i].avgVal);
 		printf("\tUncompressed size: %lu bytes\n", stats[i].uncompressedCount * sizeof(float));
+		if(!getFieldDescriptor(files[i], &fields[i])) { //no header, the original datasets are all 150x150x90
+			fields[i] = stats[i].uncompressedCount == 150*150*90 ? getContiguousField(150, 150, 90) : getContiguousField(stats[i].uncompressedCount, 1, 1);
+		}
+		if((size_t) fields[i].nx * fields[i].ny * fields[i].nz != stats[i].uncompressedCount) {
+			printf("Dimensions %u x %u x %u dont match the %u values in %s\n", fields[i].nx, fields[i].ny, fields[i].nz, stats[i].uncompressedCount, files[i]);
+			exit(1);
+		}
+		if(i > 0 && (fields[i].nx != fields[0].nx || fields[i].ny != fields[0].ny || fields[i].nz != fields[0].nz)) {
+			printf("%s is %u x %u x %u but the stencil needs every dataset to be %u x %u x %u\n", files[i], fields[i].nx, fields[i].ny, fields[i].nz, fields[0].nx, fields[0].ny, fields[0].nz);
+			exit(1);
+		}
+		grid = fields[0];
+		if(i == 0) {
+			layout = getFieldLayout(&grid, LAYOUT_LINEAR); //the arrays below are built in the order the datasets were read
+		}
+		originalDatasets[i] = malloc(stats[i].uncompressedCount * sizeof(float));
+		memcpy(originalDatasets[i], datasets[i], stats[i].uncompressedCount * sizeof(float));
+		printf("\tDimensions: %u x %u x %u\n", fields[i].nx, fields[i].ny, fields[i].nz);
 		
 		//runlength compression
 		printf("Stats after runlength compression\n");
-		struct runlengthEntry *runlengthCompressed = getRunlengthCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].runlengthCount);
+		unsigned char *runlengthCompressed = getRunlengthCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].runlengthCount);
 		free(runlengthCompressed);
-		printf("\tNumber of runlength entries: %d, Runlength compressed size: %lu bytes\n", stats[i].runlengthCount, stats[i].runlengthCount * sizeof(struct runlengthEntry));
+		stats[i].runlengthSize = stats[i].runlengthCount;
+		printf("\tRunlength compressed size: %lu bytes\n", stats[i].runlengthSize);
 		
 		//zfp compression
 		printf("Stats after ZFP compression\n");
-		stats[i].zfpSize = zfpCompress(datasets[i], 150, 150, 90, 0.00, 0);
+		stats[i].zfpSize = zfpCompressWithContext(zfpLossless, datasets[i], fields[i].nx, fields[i].ny, fields[i].nz, NULL);
 		printf("\tZFP compressed size: %lu bytes\n", stats[i].zfpSize);
+		zfpFixedRateDatasets[i] = zfpCreateArray(datasets[i], fields[i].nx, fields[i].ny, fields[i].nz, 16, 256); //256 cached blocks covers the stencil's neighbouring rows of blocks
+		printf("\tZFP 16 bit fixed rate compressed size: %lu bytes\n", zfpArraySize(zfpFixedRateDatasets[i]));
+
+		//XOR predictive compression, lossless like runlength and ZFP at tolerance 0
+		printf("Stats after XOR predictive compression\n");
+		free(getXorPredictiveCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].xorCount, 1));
+		free(getXorPredictiveCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].xorPlaneCount, fields[i].sz));
+		printf("\tPrevious value prediction compressed size: %u bytes\n", stats[i].xorCount);
+		printf("\tPrevious plane prediction compressed size: %u bytes\n", stats[i].xorPlaneCount);
+		printf("\tLossless ratios: Runlength %.3f, ZFP %.3f, XOR previous value %.3f, XOR previous plane %.3f\n",
+			stats[i].uncompressedCount * sizeof(float) / (double) stats[i].runlengthSize, stats[i].uncompressedCount * sizeof(float) / (double) stats[i].zfpSize,
+			stats[i].uncompressedCount * sizeof(float) / (double) stats[i].xorCount, stats[i].uncompressedCount * sizeof(float) / (double) stats[i].xorPlaneCount);
 		
 		//24 bit compression
 		printf("Stats after 24 bit compression\n");
 		struct compressedVal *compressed24 = get24BitCompressedData(datasets[i], stats[i].uncompressedCount, 5, 18);
 		compressed24Datasets[i] = compressed24;
+		compressed24FixedDatasets[i] = get24BitCompressedData(datasets[i], stats[i].uncompressedCount, 5, 18);
 		printf("\t24 Bit compressed size: %lu bytes\n", sizeof(struct compressedVal) * stats[i].uncompressedCount); //number of indexes doesnt change so no need for new value
+
+		//byte aligned compression, 1 and 2 byte records
+		printf("Stats for byte aligned compression\n");
+		aligned16Datasets[i] = getAligned16BitCompressedData(datasets[i], stats[i].uncompressedCount, 5, 10);
+		printf("\t16 Bit (5 Mag 10 Precision) compressed size: %lu bytes\n", 2 * (long unsigned int) stats[i].uncompressedCount);
+		printf("\t8 Bit (3 Mag 4 Precision) compressed size: %lu bytes\n", (long unsigned int) stats[i].uncompressedCount);
+		halfFloat[i] = getCompressedField(findCodec("16 Bit Half Float"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		bfloat16[i] = getCompressedField(findCodec("16 Bit BFloat16"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		printf("\t16 Bit half float and bfloat16 compressed size: %lu bytes\n", halfFloat[i].bytes);
+		codebook8[i] = getCompressedField(findCodec("8 Bit Codebook"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		codebook16[i] = getCompressedField(findCodec("16 Bit Codebook"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		printf("\t8 Bit codebook compressed size: %lu bytes, max error %f\n", codebook8[i].bytes, getFieldMaxError(&codebook8[i], datasets[i], stats[i].uncompressedCount));
+		printf("\t16 Bit codebook compressed size: %lu bytes, max error %f\n", codebook16[i].bytes, getFieldMaxError(&codebook16[i], datasets[i], stats[i].uncompressedCount));
 		printf("Stats for non byte aligned compression\n");
 		
 		//do non byte aligned compression
-		lossy21[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var21Count, 5, 15);
-		printf("\t5 Mag 15 Precision compressed size: %lu\n", sizeof(unsigned char) * stats[i].var21Count);
+		lossy21[i] = getCompressedField(findCodec("21 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		printf("\t5 Mag 15 Precision compressed size: %lu\n", lossy21[i].bytes);
 		//free(varCompressed);
 
 		//do non byte aligned compression
-		lossy18[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var18Count, 5, 12);
-		printf("\t5 Mag 12 Precision compressed size: %lu\n", sizeof(unsigned char) * stats[i].var18Count);
+		lossy18[i] = getCompressedField(findCodec("18 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		printf("\t5 Mag 12 Precision compressed size: %lu\n", lossy18[i].bytes);
 		//free(varCompressed);
 
 		//do non byte aligned compression
-		lossy15[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var15Count, 5, 9);
-		printf("\t5 Mag 9 Precision compressed size: %lu\n", sizeof(unsigned char) * stats[i].var15Count);
+		lossy15[i] = getCompressedField(findCodec("15 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		printf("\t5 Mag 9 Precision compressed size: %lu\n", lossy15[i].bytes);
 		//free(varCompressed);
 
 		//do non byte aligned compression
-		lossy12[i] = getVariableBitCompressedData(datasets[i], stats[i].uncompressedCount, &stats[i].var12Count, 5, 6);
-		printf("\t5 Mag 6 Precision compressed size: %lu\n\n\n", sizeof(unsigned char) * stats[i].var12Count);
+		lossy12[i] = getCompressedField(findCodec("12 Bit Lossy"), datasets[i], grid.nx, grid.ny, grid.nz, &layout);
+		printf("\t5 Mag 6 Precision compressed size: %lu\n\n\n", lossy12[i].bytes);
 		//free(varCompressed);
 		//free(datasets[i]);
 	}
 
 	printf("Running compression speed tests\n");
+	printf("Codec kernels: %s (best supported %s, set %s to force another)\n", getIsaName(getKernelIsa()), getIsaName(getSupportedIsa()), KERNEL_ISA_ENV);
+	registerAnalysisCodecs();
 	compressionSpeedAnalysis();
 	decompressionSpeedAnalysis();
+	entropyAnalysis();
+	shuffleAnalysis();
+	zfpThreadScalingAnalysis();
 	printf("\n");
 
+	paddedGrid = getPaddedField(grid.nx, grid.ny, grid.nz, 1);
+	paddedDatasets = malloc(numDatasets * sizeof(float *));
+	for(i = 0; i < numDatasets; i++) {
+		paddedDatasets[i] = getPaddedData(datasets[i], &fields[i], &paddedGrid);
+	}
+
 	printf("Datasets read in!\n");
 	printf("Running analysis\n");
 	printf("Testing evaluating compression overhead...\n");
 	transformUncompressed();
+	transformUncompressedPadded();
+	comparePaddedResults();
 	transform24BitCompression();
+	transform24BitFixedPoint();
+	compareFixedPointResults();
+	transformAligned16Compression();
+	transformCompressedField("16 bit half float", updateHalfFloatInteriorValue, updateHalfFloatValue);
+	transformCompressedField("16 bit bfloat16", updateBFloat16InteriorValue, updateBFloat16Value);
+	transformCompressedField("8 bit codebook", updateCodebook8InteriorValue, updateCodebook8Value);
+	transformCompressedField("16 bit codebook", updateCodebook16InteriorValue, updateCodebook16Value);
+	transformZfpFixedRate();
 	transformNonByteAligned21Compression();
 	transformNonByteAligned18Compression();
 	transformNonByteAligned15Compression();
 	transformNonByteAligned12Compression();
+	redBlackScalingAnalysis();
+	jacobiAnalysis();
+	codecStencilAnalysis();
+	temporalBlockingAnalysis();
+	layoutAnalysis();
+	for(i = 0; i < numDatasets; i++) {
+		zfpFreeArray(zfpFixedRateDatasets[i]);
+	}
+	zfpFreeContext(zfpLossless);
 }
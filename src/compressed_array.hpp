@@ -0,0 +1,412 @@
+//FILE: compressed_array.hpp
+//PURPOSE: header only C++ view of the variable bit format, compressed_array<Mag, Prec> holds the same bytes as getVariableBitCompressedData
+//with the record layout fixed at compile time so every get/set inlines down to one 8 byte load and a few shifts. Needs C++17, the span
+//overloads of decode_into/encode_from need C++20
+
+#ifndef COMPRESSED_ARRAY_HPP_
+#define COMPRESSED_ARRAY_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define COMPRESSED_ARRAY_SPAN 1
+#endif
+
+namespace compressor {
+
+namespace detail {
+
+/*
+ * Purpose:
+ *		Decimal digits in 2^bits, the same table numberOfDigits uses
+ */
+constexpr unsigned int numberOfDigits(unsigned int bits) {
+	constexpr unsigned char digits[25] = {1, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 6, 6, 6, 7, 7, 7, 7, 8};
+	return digits[bits];
+}
+
+constexpr std::uint32_t powerOfTen(unsigned int n) {
+	return n == 0 ? 1 : 10 * powerOfTen(n - 1);
+}
+
+} // namespace detail
+
+/*
+ * Purpose:
+ *		count floats stored as 1 sign bit, Mag magnitude bits and Prec precision bits, byte for byte the layout of
+ *		getVariableBitCompressedData(values, count, &bytes, Mag, Prec). Records run MSB first through a bit stream whose byte n is stored at
+ *		data()[byte_size()-1-n], so arrays can be handed to and from the C functions without conversion.
+ *		Magnitude and precision parts too big for their fields keep only their low bits, as with writeVariableBitValues.
+ */
+template <unsigned int Mag, unsigned int Prec>
+class compressed_array {
+	static_assert(Mag <= 24 && Prec >= 1 && Prec <= 24, "the C format splits magnitude and precision into at most 3 bytes each");
+
+public:
+	static constexpr unsigned int record_bits = 1 + Mag + Prec;
+	static constexpr unsigned int prec_offset = 0; //bit offsets within a record, counted from its last bit
+	static constexpr unsigned int mag_offset = Prec;
+	static constexpr unsigned int sign_offset = Mag + Prec;
+	static constexpr std::uint64_t prec_mask = (std::uint64_t{1} << Prec) - 1;
+	static constexpr std::uint64_t mag_mask = (std::uint64_t{1} << Mag) - 1;
+	static constexpr std::uint64_t record_mask = (std::uint64_t{1} << record_bits) - 1;
+	static constexpr std::uint32_t multiplier = detail::numberOfDigits(Prec) == 1 ? 10 : detail::powerOfTen(detail::numberOfDigits(Prec)); //same scaling as startVariableBitStream
+	static constexpr float divider = detail::numberOfDigits(Prec) == 1 ? 100.0f : static_cast<float>(detail::powerOfTen(detail::numberOfDigits(Prec)));
+
+	using value_type = float;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+
+	/*
+	 * Purpose:
+	 *		Proxy returned by operator[], reads decode and assignments encode the record in place
+	 */
+	class reference {
+	public:
+		reference(compressed_array &array, size_type index) : array_(&array), index_(index) {}
+		reference(const reference &) = default;
+
+		operator float() const {
+			return array_->get(index_);
+		}
+		reference &operator=(float value) {
+			array_->set(index_, value);
+			return *this;
+		}
+		reference &operator=(const reference &other) {
+			array_->set(index_, static_cast<float>(other));
+			return *this;
+		}
+		reference &operator+=(float value) {
+			return *this = static_cast<float>(*this) + value;
+		}
+		reference &operator-=(float value) {
+			return *this = static_cast<float>(*this) - value;
+		}
+		reference &operator*=(float value) {
+			return *this = static_cast<float>(*this) * value;
+		}
+		reference &operator/=(float value) {
+			return *this = static_cast<float>(*this) / value;
+		}
+
+	private:
+		compressed_array *array_;
+		size_type index_;
+	};
+
+	/*
+	 * Purpose:
+	 *		Random access iterator over the records, dereferencing gives a reference (or a decoded float when Const)
+	 */
+	template <bool Const>
+	class basic_iterator {
+		using array_type = typename std::conditional<Const, const compressed_array, compressed_array>::type;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = float;
+		using difference_type = std::ptrdiff_t;
+		using reference = typename std::conditional<Const, float, typename compressed_array::reference>::type;
+		using pointer = void;
+
+		basic_iterator() : array_(nullptr), index_(0) {}
+		basic_iterator(array_type &array, size_type index) : array_(&array), index_(index) {}
+		template <bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+		basic_iterator(const basic_iterator<OtherConst> &other) : array_(other.array_), index_(other.index_) {}
+
+		reference operator*() const {
+			return (*array_)[index_];
+		}
+		reference operator[](difference_type n) const {
+			return (*array_)[index_ + n];
+		}
+		basic_iterator &operator++() {
+			++index_;
+			return *this;
+		}
+		basic_iterator operator++(int) {
+			basic_iterator old = *this;
+			++index_;
+			return old;
+		}
+		basic_iterator &operator--() {
+			--index_;
+			return *this;
+		}
+		basic_iterator operator--(int) {
+			basic_iterator old = *this;
+			--index_;
+			return old;
+		}
+		basic_iterator &operator+=(difference_type n) {
+			index_ += n;
+			return *this;
+		}
+		basic_iterator &operator-=(difference_type n) {
+			index_ -= n;
+			return *this;
+		}
+		friend basic_iterator operator+(basic_iterator it, difference_type n) {
+			return it += n;
+		}
+		friend basic_iterator operator+(difference_type n, basic_iterator it) {
+			return it += n;
+		}
+		friend basic_iterator operator-(basic_iterator it, difference_type n) {
+			return it -= n;
+		}
+		friend difference_type operator-(const basic_iterator &a, const basic_iterator &b) {
+			return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+		}
+		friend bool operator==(const basic_iterator &a, const basic_iterator &b) {
+			return a.index_ == b.index_;
+		}
+		friend bool operator!=(const basic_iterator &a, const basic_iterator &b) {
+			return a.index_ != b.index_;
+		}
+		friend bool operator<(const basic_iterator &a, const basic_iterator &b) {
+			return a.index_ < b.index_;
+		}
+		friend bool operator>(const basic_iterator &a, const basic_iterator &b) {
+			return a.index_ > b.index_;
+		}
+		friend bool operator<=(const basic_iterator &a, const basic_iterator &b) {
+			return a.index_ <= b.index_;
+		}
+		friend bool operator>=(const basic_iterator &a, const basic_iterator &b) {
+			return a.index_ >= b.index_;
+		}
+
+	private:
+		friend class basic_iterator<!Const>;
+		array_type *array_;
+		size_type index_;
+	};
+
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	/*
+	 * Purpose:
+	 *		Number of bytes count records take, the same as the newCount getVariableBitCompressedData gives
+	 */
+	static constexpr size_type bytes_for(size_type count) {
+		return (count * record_bits + 7) / 8;
+	}
+
+	compressed_array() : count_(0) {}
+
+	/*
+	 * Purpose:
+	 *		count records, all 0.0
+	 */
+	explicit compressed_array(size_type count) : bytes_(bytes_for(count)), count_(count) {}
+
+	/*
+	 * Purpose:
+	 *		Compress count floats
+	 */
+	compressed_array(const float *values, size_type count) : bytes_(bytes_for(count)), count_(count) {
+		encode_from(values, count);
+	}
+
+	/*
+	 * Purpose:
+	 *		Copy an array made by the C functions, bytes must hold bytes_for(count) bytes
+	 */
+	compressed_array(const unsigned char *bytes, size_type count) : bytes_(bytes, bytes + bytes_for(count)), count_(count) {}
+
+	size_type size() const {
+		return count_;
+	}
+	bool empty() const {
+		return count_ == 0;
+	}
+	size_type byte_size() const {
+		return bytes_.size();
+	}
+	unsigned char *data() {
+		return bytes_.data();
+	}
+	const unsigned char *data() const {
+		return bytes_.data();
+	}
+
+	/*
+	 * Purpose:
+	 *		Decode record index, no bounds checks
+	 */
+	float get(size_type index) const {
+		size_type bit = index * record_bits;
+		std::uint64_t record = (load(bit / 8) << (bit % 8)) >> (64 - record_bits);
+		float value = static_cast<float>((record >> mag_offset) & mag_mask) + static_cast<float>(record & prec_mask) / divider;
+
+		return (record >> sign_offset) ? -value : value;
+	}
+
+	/*
+	 * Purpose:
+	 *		Encode value into record index, only the bytes the record covers are written
+	 */
+	void set(size_type index, float value) {
+		size_type bit = index * record_bits;
+		unsigned int shift = 64 - record_bits - bit % 8;
+		std::uint64_t window = (load(bit / 8) & ~(record_mask << shift)) | (encode(value) << shift);
+		size_type top = bytes_.size() - 1 - bit / 8;
+		unsigned int t;
+
+		for(t = 0; t < (bit % 8 + record_bits + 7) / 8; t++) {
+			bytes_[top - t] = static_cast<unsigned char>(window >> (56 - 8*t));
+		}
+	}
+
+	reference operator[](size_type index) {
+		return reference(*this, index);
+	}
+	float operator[](size_type index) const {
+		return get(index);
+	}
+
+	iterator begin() {
+		return iterator(*this, 0);
+	}
+	iterator end() {
+		return iterator(*this, count_);
+	}
+	const_iterator begin() const {
+		return const_iterator(*this, 0);
+	}
+	const_iterator end() const {
+		return const_iterator(*this, count_);
+	}
+	const_iterator cbegin() const {
+		return begin();
+	}
+	const_iterator cend() const {
+		return end();
+	}
+	reverse_iterator rbegin() {
+		return reverse_iterator(end());
+	}
+	reverse_iterator rend() {
+		return reverse_iterator(begin());
+	}
+	const_reverse_iterator rbegin() const {
+		return const_reverse_iterator(end());
+	}
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(begin());
+	}
+
+	/*
+	 * Purpose:
+	 *		Decode count records starting at first into out
+	 */
+	void decode_into(float *out, size_type count, size_type first = 0) const {
+		size_type i;
+
+		for(i = 0; i < count; i++) {
+			out[i] = get(first + i);
+		}
+	}
+
+	/*
+	 * Purpose:
+	 *		Encode count floats into the records starting at first. The records are streamed through a bit accumulator so each byte is
+	 *		written once, only the bits shared with records outside the range are merged with what is already stored.
+	 */
+	void encode_from(const float *values, size_type count, size_type first = 0) {
+		size_type bit = first * record_bits;
+		size_type next = bit / 8; //stream byte the accumulator writes next
+		std::uint64_t buffer = 0;
+		unsigned int bits = bit % 8;
+		size_type i;
+
+		if(count == 0) {
+			return;
+		}
+		if(bits) { //keep the bits of the record before first
+			buffer = streamByte(next) >> (8 - bits);
+		}
+		for(i = 0; i < count; i++) {
+			buffer = (buffer << record_bits) | encode(values[i]);
+			bits += record_bits;
+			while(bits >= 8) {
+				bits -= 8;
+				streamByte(next++) = static_cast<unsigned char>(buffer >> bits);
+			}
+		}
+		if(bits) { //keep the bits of the record after the range
+			unsigned char &last = streamByte(next);
+			last = static_cast<unsigned char>((buffer << (8 - bits)) | (last & ((1U << (8 - bits)) - 1)));
+		}
+	}
+
+#ifdef COMPRESSED_ARRAY_SPAN
+	void decode_into(std::span<float> out, size_type first = 0) const {
+		decode_into(out.data(), out.size(), first);
+	}
+	void encode_from(std::span<const float> values, size_type first = 0) {
+		encode_from(values.data(), values.size(), first);
+	}
+#endif
+
+private:
+	std::vector<unsigned char> bytes_;
+	size_type count_;
+
+	/*
+	 * Purpose:
+	 *		Sign, magnitude and precision bits of value, split the same way as splitFloat
+	 */
+	static std::uint64_t encode(float value) {
+		float beforeDp;
+		float afterDp = std::modf(value, &beforeDp);
+		std::uint64_t mag = static_cast<std::uint32_t>(std::fabs(beforeDp)) & mag_mask;
+		std::uint64_t prec = static_cast<std::uint32_t>(std::round(static_cast<double>(std::fabs(afterDp)) * multiplier)) & prec_mask;
+
+		return (static_cast<std::uint64_t>(value < 0) << sign_offset) | (mag << mag_offset) | prec;
+	}
+
+	unsigned char &streamByte(size_type n) {
+		return bytes_[bytes_.size() - 1 - n];
+	}
+	unsigned char streamByte(size_type n) const {
+		return bytes_[bytes_.size() - 1 - n];
+	}
+
+	/*
+	 * Purpose:
+	 *		Stream bytes first..first+7 as a big endian word, bytes past the end of the stream read as 0
+	 */
+	std::uint64_t load(size_type first) const {
+		size_type top = bytes_.size() - 1 - first; //memory position of stream byte first
+		std::uint64_t window = 0;
+		size_type t;
+
+		if(top >= 7) {
+			std::memcpy(&window, bytes_.data() + top - 7, sizeof(window));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			window = __builtin_bswap64(window);
+#endif
+			return window;
+		}
+		for(t = 0; t <= top; t++) {
+			window |= static_cast<std::uint64_t>(bytes_[top - t]) << (56 - 8*t);
+		}
+		return window;
+	}
+};
+
+} // namespace compressor
+
+#endif
@@ -0,0 +1,133 @@
+//FILE: compressed_array_tests.cpp
+//PURPOSE: Unit tests for the C++ compressed_array wrapper, checked against the C variable bit functions
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#include "minunit.h"
+#include "compressor.h"
+#include "compressed_array.hpp"
+
+static const float uncompressedData[11] = {0.0, 1.25, -2.25, 31.125, -17.0625, 3.3, 0.25, -0.3125, 12.0, 7.1875, -30.25}; //fit every field size below
+
+/*
+ * Purpose:
+ *		Check one compressed_array instantiation against getVariableBitCompressedData, getSingleVariableBitValue and
+ *		insertSingleVariableBitValue
+ * Returns:
+ *		NULL when everything matches, otherwise the first failure
+ */
+template <unsigned int Mag, unsigned int Prec>
+static const char *checkCompressedArray() {
+	using array_type = compressor::compressed_array<Mag, Prec>;
+	unsigned int compressedCount = 0;
+	unsigned char *compressedData = getVariableBitCompressedData(const_cast<float *>(uncompressedData), 11, &compressedCount, Mag, Prec);
+	array_type array(uncompressedData, 11);
+	array_type copy(compressedData, 11);
+	std::vector<float> decoded(11);
+	unsigned int i;
+	const char *failure = NULL;
+
+	if(array.byte_size() != compressedCount || memcmp(array.data(), compressedData, compressedCount) != 0) {
+		failure = "compressed bytes dont match getVariableBitCompressedData";
+	}
+	for(i = 0; i < 11 && failure == NULL; i++) {
+		if(array[i] != getSingleVariableBitValue(compressedData, compressedCount, i, Mag, Prec) || copy.get(i) != array.get(i)) {
+			failure = "value doesnt match getSingleVariableBitValue";
+		}
+	}
+	array.decode_into(decoded.data(), 11);
+	if(failure == NULL && !std::equal(decoded.begin(), decoded.end(), array.cbegin())) {
+		failure = "decode_into doesnt match the iterators";
+	}
+
+	//writes through the proxy must touch only their own record
+	for(i = 0; i < 11 && failure == NULL; i += 3) {
+		array[i] = uncompressedData[10 - i];
+		insertSingleVariableBitValue(compressedData, compressedCount, i, uncompressedData[10 - i], Mag, Prec);
+	}
+	if(failure == NULL && memcmp(array.data(), compressedData, compressedCount) != 0) {
+		failure = "proxy assignment doesnt match insertSingleVariableBitValue";
+	}
+
+	//a bulk encode part way through the array must leave the records either side alone
+	copy = array;
+	for(i = 2; i < 9; i++) {
+		copy.set(i, uncompressedData[i - 1]);
+	}
+	array.encode_from(uncompressedData + 1, 7, 2);
+	if(failure == NULL && memcmp(array.data(), copy.data(), array.byte_size()) != 0) {
+		failure = "encode_from doesnt match single sets";
+	}
+	free(compressedData);
+	return failure;
+}
+
+/*
+ * Purpose:
+ *		Test that compressed_array is byte compatible with the C variable bit format for record sizes that do and dont line up with bytes,
+ *		including a precision small enough to use the 1 digit scaling
+ */
+MU_TEST(testCompressedArrayFormat) {
+	const char *failure;
+
+	failure = checkCompressedArray<5, 15>();
+	mu_assert(failure == NULL, failure);
+	failure = checkCompressedArray<5, 9>();
+	mu_assert(failure == NULL, failure);
+	failure = checkCompressedArray<5, 6>();
+	mu_assert(failure == NULL, failure);
+	failure = checkCompressedArray<7, 12>();
+	mu_assert(failure == NULL, failure);
+	failure = checkCompressedArray<5, 2>();
+	mu_assert(failure == NULL, failure);
+	mu_assert((compressor::compressed_array<5, 15>::record_bits == 21 && compressor::compressed_array<5, 15>::mag_mask == 31), "ERROR in testCompressedArrayFormat: record constants are wrong");
+}
+
+/*
+ * Purpose:
+ *		Test that compressed_array works with standard algorithms through its iterators and proxy references
+ */
+MU_TEST(testCompressedArrayIterators) {
+	compressor::compressed_array<5, 9> array(uncompressedData, 11);
+	const compressor::compressed_array<5, 9> &constArray = array;
+	std::vector<float> copied;
+	float sum;
+
+	mu_assert(array.end() - array.begin() == 11 && array.size() == 11, "ERROR in testCompressedArrayIterators: wrong number of records");
+	std::copy(constArray.begin(), constArray.end(), std::back_inserter(copied));
+	mu_assert(std::equal(copied.begin(), copied.end(), array.begin()), "ERROR in testCompressedArrayIterators: copy doesnt match the records");
+	sum = std::accumulate(array.cbegin(), array.cend(), 0.0f);
+	mu_assert(sum == std::accumulate(copied.begin(), copied.end(), 0.0f), "ERROR in testCompressedArrayIterators: accumulate doesnt match");
+
+	std::transform(array.begin(), array.end(), array.begin(), [](float value) { return value < 0 ? -value : value; });
+	for(compressor::compressed_array<5, 9>::const_iterator it = array.begin(); it != array.end(); ++it) {
+		mu_assert(*it >= 0 && *it == (copied[it - array.cbegin()] < 0 ? -copied[it - array.cbegin()] : copied[it - array.cbegin()]), "ERROR in testCompressedArrayIterators: transform didnt write back");
+	}
+	std::fill(array.begin() + 4, array.begin() + 7, 2.5f);
+	array[10] += 1.0f;
+	mu_assert(array[3] != 2.5f && array[4] == 2.5f && array[6] == 2.5f && array[7] != 2.5f, "ERROR in testCompressedArrayIterators: fill touched the wrong records");
+	mu_assert(array[10] == (-copied[10]) + 1.0f, "ERROR in testCompressedArrayIterators: compound assignment didnt store the value");
+#ifdef COMPRESSED_ARRAY_SPAN
+	array.decode_into(std::span<float>(copied).subspan(2), 2);
+	mu_assert(copied[4] == array[4] && copied[10] == array[10], "ERROR in testCompressedArrayIterators: span decode read the wrong records");
+#endif
+	mu_assert(*std::max_element(array.cbegin(), array.cend()) == array[10] && constArray.rbegin()[0] == array[10], "ERROR in testCompressedArrayIterators: search through iterators failed");
+}
+
+/*
+ * Purpose:
+ *	Causes all individual tests to be run...
+ */
+MU_TEST_SUITE(test_suite) {
+	MU_RUN_TEST(testCompressedArrayFormat);
+	MU_RUN_TEST(testCompressedArrayIterators);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return minunit_status;
+}
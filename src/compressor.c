@@ -10,13 +10,74 @@
 #include <math.h>
 #include <assert.h>
 #include <float.h>
+#include <limits.h>
 #include "compressor.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define COMPRESSOR_X86 1 //SIMD kernels are built with target attributes whatever -march says and picked at run time, see selectKernels
+#include <immintrin.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 struct floatSplitValue { //Struct to represent the before and after decimal point values of a float split (3 bytes for each)
 	uint8_t beforeDecimal[3];
 	uint8_t afterDecimal[3];
 };
 
+#define ALWAYS_INLINE static inline __attribute__((always_inline)) //for shared bodies that must be specialised per record size
+
+struct layout24Bit;
+
+struct codecKernels { //the kernels one instruction set level uses, every level has a full set (falling back to older levels' kernels)
+	enum kernelIsa isa;
+	unsigned int (*findRunEnd)(const float *values, unsigned int start, unsigned int count);
+	void (*fillRun)(float *out, float value, unsigned int length);
+	void (*decode24BitRecords)(const struct compressedVal *records, unsigned int count, float *out, const struct layout24Bit *layout);
+	unsigned int (*decodeVariableBits)(const unsigned char *values, size_t byteCount, size_t bit, unsigned int count, float *out, unsigned int magBits,
+		unsigned int precBits, float divider); //NULL when there is no vector kernel, returns how many records it decoded
+	unsigned int (*extractVariableBits)(const unsigned char *values, size_t byteCount, size_t bit, unsigned int count, uint32_t *out,
+		unsigned int recordBits); //as decodeVariableBits but gives the raw records
+	void (*encodeFloat16)(const float *values, unsigned int count, unsigned char *out);
+	void (*decodeFloat16)(const unsigned char *records, unsigned int count, float *out);
+	void (*shuffleBytes)(const unsigned char *in, size_t count, unsigned int width, unsigned char *out);
+	void (*unshuffleBytes)(const unsigned char *in, size_t count, unsigned int width, unsigned char *out);
+	void (*transposeBits)(const unsigned char *in, size_t bytes, unsigned char *out);
+	void (*untransposeBits)(const unsigned char *in, size_t bytes, unsigned char *out);
+	void (*decodeCodebook)(const float *codebook, const unsigned char *indices, unsigned int count, unsigned int indexBits, float *out);
+};
+
+static const struct codecKernels scalarKernels;
+static const struct codecKernels *kernels = &scalarKernels; //kernels in use, replaced by selectKernels before main runs
+
+struct layout24Bit { //Where the fields of a 24 bit record sit once it has been loaded as a 32 bit int
+	uint32_t magShift;
+	uint32_t magMask;
+	uint32_t precShift;
+	uint32_t precMask;
+	unsigned int multiplier;
+	float divider;
+};
+
+struct truncatedFloatLayout { //Field positions for truncated float records, sign then re-biased exponent then the top mantissa bits
+	uint32_t mantBits;
+	uint32_t mantMask;
+	uint32_t expMask; //also the largest stored exponent
+	uint32_t rebias; //IEEE exponent - stored exponent
+	uint32_t round; //half of the last kept mantissa bit
+	uint32_t signShift;
+};
+
+struct alignedLayout { //Field positions for the byte aligned (8/16/24/32 bit) record family
+	uint32_t recordMask;
+	uint32_t signShift;
+	uint32_t magMask;
+	uint32_t precBits;
+	uint32_t precMask;
+	unsigned int multiplier;
+	float divider;
+};
+
 /* 
  * Purpose:  
  * 		Get a array of the absolute filepaths of a certain type of file within a directory.
@@ -45,6 +106,25 @@ void getAbsoluteFilepaths(char *files[], char *baseDirectory, char *fileExtensio
 	} 
 }
 
+/*
+ * Purpose:
+ *		Read the next value of a data file, float64 fields are read at full precision and narrowed to float once.
+ * Returns:
+ *		1 if a value was read, 0 at the end of the data.
+ */
+static int readDataValue(FILE *file, enum fieldElementType type, float *value) {
+	double wideValue;
+
+	if(type == FIELD_FLOAT32) {
+		return fscanf(file, "%f", value) == 1;
+	}
+	if(fscanf(file, "%lf", &wideValue) != 1) {
+		return 0;
+	}
+	*value = (float) wideValue;
+	return 1;
+}
+
 /*
  * Purpose:
  * 		Extract a list of floats from a given file. This method is used to get the simulation data from data dump files. (/simulation datasets/)
@@ -59,13 +139,25 @@ void getAbsoluteFilepaths(char *files[], char *baseDirectory, char *fileExtensio
  */
 float *getData(char *absFilePath, unsigned int *count, float *max, float *min, float *mean) {
 	FILE *contentFile = fopen(absFilePath, "r");
-	float *fileContent = malloc((150*150*150)*sizeof(float)); //arbitrarily large allocation for other datasets
-	int i = 0;
+	unsigned int capacity = 1 << 16;
+	float *fileContent = malloc(capacity*sizeof(float)); //grown as needed so any size of dataset fits
+	unsigned int i = 0;
+	int firstChar;
+	struct fieldDescriptor field = {.type = FIELD_FLOAT32};
 	*max = FLT_MIN;
 	*min = FLT_MAX;
 	float total = 0;
 
-	while(fscanf(contentFile, "%f", &fileContent[i]) == 1) { //while there's still data left, copy it into the array
+	firstChar = fgetc(contentFile);
+	if(firstChar == '#') { //skip a field header line (see getFieldDescriptor)
+		while(firstChar != '\n' && firstChar != EOF) {
+			firstChar = fgetc(contentFile);
+		}
+	} else if(firstChar != EOF) {
+		ungetc(firstChar, contentFile);
+	}
+	getFieldDescriptor(absFilePath, &field); //values are read as the element type the field declares
+	while(readDataValue(contentFile, field.type, &fileContent[i])) { //while there's still data left, copy it into the array
 		total+=fileContent[i];
 		if(fileContent[i] > *max) {
 			*max = fileContent[i];
@@ -73,14 +165,233 @@ float *getData(char *absFilePath, unsigned int *count, float *max, float *min, f
 			*min = fileContent[i];
 		}
 		i++;
+		if(i == capacity) {
+			capacity *= 2;
+			fileContent = realloc(fileContent, capacity*sizeof(float));
+		}
 	}
 	fclose(contentFile);
-	float *exactContent = malloc(i*sizeof(float)); //resize to whats needed
-	memcpy(exactContent, fileContent, i*sizeof(float));
 	*count = i;
 	*mean = total/ *count;
 
-	return exactContent;
+	return realloc(fileContent, (i ? i : 1)*sizeof(float)); //resize to whats needed
+}
+
+/*
+ * Purpose:
+ *		Describe a contiguous nx*ny*nz field of floats with x (i) varying fastest.
+ * Returns:
+ *		The field descriptor.
+ */
+struct fieldDescriptor getContiguousField(unsigned int nx, unsigned int ny, unsigned int nz) {
+	return getPaddedField(nx, ny, nz, 0);
+}
+
+/*
+ * Purpose:
+ *		Describe an nx*ny*nz field of floats surrounded by halo layers of ghost cells on every side, x (i) varying fastest.
+ *		Indexes -halo to n+halo-1 are valid in each dimension, so a stencil can read past the edge of the field without checks.
+ * Returns:
+ *		The field descriptor.
+ */
+struct fieldDescriptor getPaddedField(unsigned int nx, unsigned int ny, unsigned int nz, unsigned int halo) {
+	size_t px = nx + 2*halo;
+	size_t py = ny + 2*halo;
+	struct fieldDescriptor field = {.nx = nx, .ny = ny, .nz = nz, .sx = 1, .sy = px, .sz = px*py, .type = FIELD_FLOAT32, .halo = halo};
+
+	field.origin = halo*(1 + px + px*py);
+	return field;
+}
+
+/*
+ * Purpose:
+ *		Get the number of values needed to store a field, ghost cells included.
+ */
+size_t getFieldStorageCount(const struct fieldDescriptor *field) {
+	return (size_t) (field->nx + 2*field->halo) * (field->ny + 2*field->halo) * (field->nz + 2*field->halo);
+}
+
+/*
+ * Purpose:
+ *		Copy a field into padded storage with every ghost cell set to 0.0.
+ * Returns:
+ *		Array of getFieldStorageCount(padded) floats.
+ * Parameters:
+ *		1. values - The field to copy
+ *		2. field - Shape of values
+ *		3. padded - Shape to copy into, from getPaddedField with the same nx, ny and nz
+ */
+float *getPaddedData(float *values, const struct fieldDescriptor *field, const struct fieldDescriptor *padded) {
+	float *paddedValues = calloc(getFieldStorageCount(padded), sizeof(float));
+	unsigned int i, j, k;
+
+	for(k = 0; k < field->nz; k++) {
+		for(j = 0; j < field->ny; j++) {
+			for(i = 0; i < field->nx; i++) {
+				paddedValues[getFieldIndex(padded, i, j, k)] = values[getFieldIndex(field, i, j, k)];
+			}
+		}
+	}
+	return paddedValues;
+}
+
+/*
+ * Purpose:
+ *		Spread the bits of value out so there are two 0 bits between each (bit n moves to bit 3n), for Morton codes.
+ */
+static size_t spreadBits3(unsigned int value) {
+	size_t spread = 0;
+	unsigned int bit;
+
+	for(bit = 0; value >> bit; bit++) {
+		spread |= (size_t) ((value >> bit) & 1) << (3*bit);
+	}
+	return spread;
+}
+
+/*
+ * Purpose:
+ *		Build the storage layout of a field. Brick layouts round each dimension up to a whole number of bricks.
+ * Returns:
+ *		The layout, free its tables with freeFieldLayout.
+ * Parameters:
+ *		1. field - Shape of the field (its strides are ignored)
+ *		2. type - How values are ordered in storage
+ */
+struct fieldLayout getFieldLayout(const struct fieldDescriptor *field, enum fieldLayoutType type) {
+	struct fieldLayout layout = {.type = type};
+	unsigned int brick = type == LAYOUT_BRICK ? LAYOUT_BRICK_SIZE : type == LAYOUT_MORTON ? LAYOUT_MORTON_SIZE : 0;
+	size_t bricksX, bricksY, bricksZ, brickVolume;
+	unsigned int n;
+
+	layout.brick = brick;
+	layout.xOffsets = malloc(field->nx * sizeof(size_t));
+	layout.yOffsets = malloc(field->ny * sizeof(size_t));
+	layout.zOffsets = malloc(field->nz * sizeof(size_t));
+	if(type == LAYOUT_LINEAR) {
+		for(n = 0; n < field->nx; n++) {
+			layout.xOffsets[n] = n;
+		}
+		for(n = 0; n < field->ny; n++) {
+			layout.yOffsets[n] = (size_t) n*field->nx;
+		}
+		for(n = 0; n < field->nz; n++) {
+			layout.zOffsets[n] = (size_t) n*field->nx*field->ny;
+		}
+		layout.storageCount = (size_t) field->nx*field->ny*field->nz;
+		return layout;
+	}
+	bricksX = (field->nx + brick - 1) / brick;
+	bricksY = (field->ny + brick - 1) / brick;
+	bricksZ = (field->nz + brick - 1) / brick;
+	brickVolume = (size_t) brick*brick*brick;
+	for(n = 0; n < field->nx; n++) { //which brick + where in the brick
+		layout.xOffsets[n] = (n / brick) * brickVolume + (type == LAYOUT_MORTON ? spreadBits3(n % brick) : n % brick);
+	}
+	for(n = 0; n < field->ny; n++) {
+		layout.yOffsets[n] = (n / brick) * bricksX * brickVolume + (type == LAYOUT_MORTON ? spreadBits3(n % brick) << 1 : (n % brick) * brick);
+	}
+	for(n = 0; n < field->nz; n++) {
+		layout.zOffsets[n] = (n / brick) * bricksX * bricksY * brickVolume + (type == LAYOUT_MORTON ? spreadBits3(n % brick) << 2 : (n % brick) * brick * brick);
+	}
+	layout.storageCount = bricksX * bricksY * bricksZ * brickVolume;
+	return layout;
+}
+
+/*
+ * Purpose:
+ *		Free the offset tables of a layout.
+ */
+void freeFieldLayout(struct fieldLayout *layout) {
+	free(layout->xOffsets);
+	free(layout->yOffsets);
+	free(layout->zOffsets);
+}
+
+/*
+ * Purpose:
+ *		Copy a field into a storage layout, unused slots are set to 0.0.
+ * Returns:
+ *		Array of layout->storageCount floats.
+ * Parameters:
+ *		1. values - The field to copy
+ *		2. field - Shape of values
+ *		3. layout - From getFieldLayout for the same shape
+ */
+float *getLayoutData(float *values, const struct fieldDescriptor *field, const struct fieldLayout *layout) {
+	float *layoutValues = calloc(layout->storageCount, sizeof(float));
+	unsigned int i, j, k;
+
+	for(k = 0; k < field->nz; k++) {
+		for(j = 0; j < field->ny; j++) {
+			for(i = 0; i < field->nx; i++) {
+				layoutValues[getLayoutIndex(layout, i, j, k)] = values[getFieldIndex(field, i, j, k)];
+			}
+		}
+	}
+	return layoutValues;
+}
+
+/*
+ * Purpose:
+ *		Parse "nx ny nz [float32|float64]" into a field descriptor.
+ * Returns:
+ *		1 if the line held valid dimensions, 0 otherwise.
+ */
+static int parseFieldHeader(const char *line, struct fieldDescriptor *field) {
+	unsigned int nx, ny, nz;
+	char type[16] = "float32";
+
+	if(sscanf(line, " %u %u %u %15s", &nx, &ny, &nz, type) < 3 || nx == 0 || ny == 0 || nz == 0) {
+		return 0;
+	}
+	*field = getContiguousField(nx, ny, nz);
+	if(strcmp(type, "float64") == 0) {
+		field->type = FIELD_FLOAT64;
+	} else if(strcmp(type, "float32") != 0) {
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Purpose:
+ *		Get the shape of a dataset. It is read from a sidecar file next to the data, named as the data file up to its first '.' plus ".dims"
+ *		(sim_1.txt.clean -> sim_1.dims), holding "nx ny nz [float32|float64]". Without a sidecar the first line of the data file is used
+ *		if it is a header of the form "# nx ny nz [float32|float64]".
+ * Returns:
+ *		1 if a descriptor was found, 0 if the file has no shape information (field is left untouched).
+ * Parameters:
+ *		1. absFilePath - Path of the data file
+ *		2. field - Blank pointer that gets assigned the descriptor
+ */
+int getFieldDescriptor(char *absFilePath, struct fieldDescriptor *field) {
+	char line[256];
+	char *sidecarPath = malloc(strlen(absFilePath) + strlen(".dims") + 1);
+	char *baseName = strrchr(absFilePath, '/');
+	char *extension;
+	FILE *headerFile;
+	int found = 0;
+
+	strcpy(sidecarPath, absFilePath);
+	extension = strchr(sidecarPath + (baseName ? baseName - absFilePath + 1 : 0), '.');
+	if(extension != NULL) {
+		strcpy(extension, ".dims");
+		headerFile = fopen(sidecarPath, "r");
+		if(headerFile != NULL) {
+			found = fgets(line, sizeof(line), headerFile) != NULL && parseFieldHeader(line, field);
+			fclose(headerFile);
+		}
+	}
+	free(sidecarPath);
+	if(!found) {
+		headerFile = fopen(absFilePath, "r");
+		if(headerFile != NULL) {
+			found = fgets(line, sizeof(line), headerFile) != NULL && line[0] == '#' && parseFieldHeader(line + 1, field);
+			fclose(headerFile);
+		}
+	}
+	return found;
 }
 
 /*
@@ -117,10 +428,25 @@ unsigned int *getVerificationData(char *absFilePath, unsigned int *dataLength) {
  *		1. numberOfBits - The number of bits a number uses
  */
 unsigned int numberOfDigits (unsigned int numberOfBits) {
-    if (numberOfBits == 0) return 1;
+    static const unsigned char digits[33] = {1, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 6, 6, 6, 7, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 10}; //digits in 2^n, saves a pow and log10 on every single value get/insert
+    if (numberOfBits < 33) return digits[numberOfBits];
     return floor (log10 (pow(2,numberOfBits))) + 1;
 }
 
+/*
+ * Purpose:
+ *		Get the multiplier used for the value after the decimal point in the 24 bit and byte aligned formats (10 for 1 digit, otherwise 10^(digits-1)).
+ * Returns:
+ *		The decimal multiplier for a precBits sized precision field.
+ * Parameters:
+ *		1. precBits - Number of bits used to represent precision
+ */
+static inline unsigned int getDecimalMultiplier(unsigned int precBits) {
+	static const unsigned int powersOfTen[10] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+	unsigned int digits = numberOfDigits(precBits);
+	return (digits == 1) ? 10 : powersOfTen[digits-1];
+}
+
 /*
  * Purpose:
  * 		Split a float into a floatSplitValue struct that contains 2 ints for the value before and after the decimal (after value is multiplied by multiplier).
@@ -152,339 +478,644 @@ struct floatSplitValue splitFloat(float initialValue, unsigned int multiplier) {
 	return split;
 }
 
-/* 
+/*
  * Purpose:
- *		Using runlength compression, compress an array of floats to runlengthEntry structs (uses malloc because its poor performance and not targeted towards going on an accelerator)
+ *		Get the raw bits of a float, used where values must be compared exactly (0.0 and -0.0 differ, NaNs compare equal to themselves).
  * Returns:
- * 		Array of runlengthEntrys that represent a runlength compressed version of the given values.
- * Parameters:
- * 		1. values - Array of float values that are to be compressed.
- * 		2. count - A count of the number of values in the given data.
- * 		3. newCount - A count of the number of entries in the runlength compressed data.
+ *		The IEEE-754 bits of value.
  */
-struct runlengthEntry *getRunlengthCompressedData(float *allValues, unsigned int count, unsigned int *newCount) {
-	struct runlengthEntry *compressedData = calloc(count, sizeof(struct runlengthEntry));
-	compressedData[0].value = allValues[0]; //Have to initilise the first index then work from there
-	compressedData[0].valueCount = 1;
-	int uci, ci = 0; //ci = compressed array index, uci = uncompressed array index
-
-	for(uci=1; uci < count; uci++) {
-		if(compressedData[ci].value == allValues[uci]) { //If value is continued
-			compressedData[ci].valueCount++;
-		} else { //New value, create an entry to store it
-			ci++;
-			compressedData[ci].value = allValues[uci];
-			compressedData[ci].valueCount = 1;
-		}
-	}
-	*newCount =  ci+1;
-	return compressedData;
+static inline uint32_t floatBits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(float));
+	return bits;
 }
 
 /*
  * Purpose:
- * 		Decompress a runlength compressed set of floats into the original array of floats.
+ *		Write an unsigned value as a little endian base 128 varint (7 bits per byte, top bit set on every byte except the last).
  * Returns:
- * 		Array of floats represented the uncompressed version of the given data.
+ *		The number of bytes written (1 to 10).
  * Parameters:
- * 		1. compressedValues - a array of runlengthEntry structs representing a lsit of runlength compressed floats
- * 		2. count - the number of runlengthEntry structs that compressedValues contains
- * 		3. newCount - blank pointer that gets assigned the number of entries in the returned decompressed data
+ *		1. out - Where to write the varint
+ *		2. value - The value to be written
  */
-float *getRunlengthDecompressedData(struct runlengthEntry *compressedValues, unsigned int count, unsigned int *newCount) {
-	unsigned int i;
-	unsigned int totalCount = 0;
+static inline unsigned int writeVarint(unsigned char *out, uint64_t value) {
+	unsigned int written = 0;
 
-	for(i = 0; i < count; i++) { //find out the number of elements (if decompressed) compressedValues contains
-		totalCount+= compressedValues[i].valueCount;
-	}
-	float *uncompressedValues = malloc(totalCount*sizeof(float));
-	
-	unsigned int newPos = 0;
-	for(i = 0; i < count; i++) {
-		while(compressedValues[i].valueCount != 0) { //"unwrap" the current entry and create elements for it
-			uncompressedValues[newPos] = compressedValues[i].value;
-			newPos++;
-			compressedValues[i].valueCount--;
-		}
+	while(value >= 0x80) {
+		out[written++] = (value & 0x7F) | 0x80;
+		value >>= 7;
 	}
-	*newCount = newPos;
-	return uncompressedValues;
+	out[written++] = value;
+	return written;
 }
 
 /*
  * Purpose:
- * 		Compress the given data into a 24 bit format using the given parameters to cut down the original data.
+ *		Read a varint written by writeVarint.
  * Returns:
- * 		Array of compressedVal (24 bit) values representing a compressed version the original array of 32 bit floats.
+ *		The number of bytes read.
  * Parameters:
- * 		1. uncompressedData - List of 32 bit floats to be compressed
- *		2. count - The number of values in the parameter 1.
- * 		2. magBits - Number of bits to be used to represent the magnitude of the data (bits used for before decimal place).
- *		3. precBits - Number of bits to be used to represent the precision of the data (bits used for after decimal place).
+ *		1. in - Where to read the varint from
+ *		2. value - Blank pointer that gets assigned the value read
  */
-struct compressedVal *get24BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits) {
-	struct compressedVal *compressedData = calloc(count, sizeof(struct compressedVal)); //Create array for new compressed values, dynamic allocation since this part shouldnt be run on accelerator
-	unsigned int multiplier;
-
-	//multiplier for value after decimal
-	if(numberOfDigits(precBits) == 1) {
-		multiplier = 10;
-	} else {
-		multiplier = pow(10, numberOfDigits(precBits)-1); //max number of digits that can be represented by a precBits number
-	}
-	
-	unsigned int i, space, target, ci, uci; //ci = compressed index, uci = uncompressed indexspace is byte space, target is number of bits trying to move
-	struct floatSplitValue value;
+static inline unsigned int readVarint(const unsigned char *in, uint64_t *value) {
+	unsigned int read = 0;
+	unsigned int shift = 0;
+	*value = 0;
 
-	for(i = 0; i < count; i++) {
-		value = splitFloat(uncompressedData[i], multiplier); //turn float into 2 ints representing before and after decimal
-
-		//extracting sign bit
-		if (uncompressedData[i] < 0) {
-			compressedData[i].data[2] = 1 << 7;
-		}
-		if(magBits + 1 == 8) { //Case with 7 bits of magnitude, 16 of precision
-			compressedData[i].data[2] = compressedData[i].data[2] | value.beforeDecimal[0];
-			compressedData[i].data[1] = value.afterDecimal[1];
-			compressedData[i].data[0] = value.afterDecimal[0];
-		} 
-		else if(magBits + 1 < 8) { //Case where some precision bits are in byte 2 (small mag, high prec)
-			compressedData[i].data[2] = compressedData[i].data[2] | (value.beforeDecimal[0] << 7-magBits);
-			compressedData[i].data[2] = compressedData[i].data[2] | value.afterDecimal[2];
-			compressedData[i].data[1] = value.afterDecimal[1];
-			compressedData[i].data[0] = value.afterDecimal[0];
-		} else if(magBits + 1 > 8) { //Case where magnitude takes up 8 or more bits
-			space = 7; //8-sign
-			ci = 2; //start on LHS byte of compressed struct
+	do {
+		*value |= (uint64_t) (in[read] & 0x7F) << shift;
+		shift += 7;
+	} while(in[read++] & 0x80);
+	return read;
+}
 
-			if(magBits >= 17) { //magnitude all 3 bytes
-				uci = 2;
-				target = magBits-16;
-			} else if(magBits >= 9) { // magnitude in byte 2
-				uci = 1;
-				target = magBits - 8;
-			} else { //magnitude in byte 1
-				uci = 0;
-				target = magBits;
-			}
+/*
+ * Purpose:
+ *		Read a varint written by writeVarint without reading past end
+ * Returns:
+ *		Bytes read, 0 if the varint runs past end or is too long
+ */
+static inline unsigned int readBoundedVarint(const unsigned char *in, const unsigned char *end, uint64_t *value) {
+	unsigned int read = 0;
 
-			while (target != 0) {	//shift in magnitude bits
-				if (space >= target) { //If we can fit the current values byte into the compressed byte, we want RHS of our data
-					compressedData[i].data[ci] = compressedData[i].data[ci] | (value.beforeDecimal[uci] << space-target);
-					space = space - target;
-					if(space == 0) { //If there's no space left, move to the next compressed byte
-						ci--;
-						space = 8;
-					}
-					if(uci > 0) { //If we're not on our last byte, decrement
-						uci--;
-						target = 8;
-					} else { //Done, get out of while
-						uci--;
-						target = 0;
-					}
-				} else { //We're trying to squeeze more data than we have free indexes, we want LHS of our data
-					compressedData[i].data[ci] = compressedData[i].data[ci] | (value.beforeDecimal[uci] >> target-space);
-					ci--;
-					target = target-space;
-					space = 8;
-				}
-			}
-			if(magBits >= 17) { //shift in precision
-				compressedData[i].data[0] = compressedData[i].data[0] | (value.afterDecimal[0] & ((uint32_t) pow(2, precBits) - 1));
-			} else {
-				compressedData[i].data[1] = compressedData[i].data[1] | value.afterDecimal[1];
-				compressedData[i].data[0] = value.afterDecimal[0];
-			}
+	*value = 0;
+	do {
+		if(in + read >= end || read == 10) {
+			return 0;
 		}
-	}
-	return compressedData;
+		*value |= (uint64_t) (in[read] & 0x7F) << (7 * read);
+	} while(in[read++] & 0x80);
+	return read;
 }
 
 /*
  * Purpose:
- * 		Decompress the 24 bit format data array into a version of the original data with some precision lost, depending on magnitude and precision sizes.
+ *		Write a literal span (values copied as they are) to the runlength output.
  * Returns:
- * 		Array of floats representing the data contained in the 24 bit format.
+ *		The number of bytes written.
  * Parameters:
- * 		1. allValues - An array of 24 bit compressed values.
- *		2. count - The number of 24 bit compressed values in parameter allValues
- * 		2. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
- *		3. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ *		1. out - Where to write the span
+ *		2. values - The first value of the span
+ *		3. length - Number of values in the span
  */
-float *get24BitDecompressedData(struct compressedVal *allValues, unsigned int count, unsigned int magBits, unsigned int precBits) {
-	float *uncompressed = calloc(count, sizeof(float));
-	unsigned int divider;
-	if(numberOfDigits(precBits) == 1) {
-		divider = 10;
-	} else {
-		divider = pow(10, numberOfDigits(precBits)-1);
-	}
-	unsigned int beforeDp = 0;
-	unsigned int afterDp = 0;
-	int i, signMultiplier;
-
-	for(i = 0; i < count; i++) {
-		beforeDp = 0;
-		afterDp = 0;
-
-		if((allValues[i].data[2] >> 7) == 1) { //if sign bit is set then it's a -ve number represented 
-			signMultiplier = -1;
-		} else {
-			signMultiplier = 1;
-		}
-		if(magBits + 1 < 8) { //Magnitude in byte 2 as well as precision and precision in byte 1 and 0
-			beforeDp = (allValues[i].data[2] >> (7-magBits)) & (uint32_t) (pow(2, magBits)-1); //Shift off the extra precision then AND to keep bits of interest
-			afterDp = (allValues[i].data[2] & (uint32_t) (pow(2,(precBits % 8))-1)) << 16; //use AND to keep the number of bits on RHS we want for precision and shift into place
-			afterDp = afterDp | (allValues[i].data[1] << 8);
-			afterDp = afterDp | allValues[i].data[0];
-		} else if(magBits + 1 == 8) { //Magnitude and sign bit fill up byte 2, precision in other 2 bytes
-			beforeDp = allValues[i].data[2] & (uint32_t) (pow(2, magBits)-1); //Extract RHS 7 bits we want and take precision
-			afterDp = allValues[i].data[1] << 8;
-			afterDp = afterDp | allValues[i].data[0];
-		} else if(magBits+1 > 8) { //Magnitude fills over a byte and more
-			beforeDp = (allValues[i].data[2] & (((uint32_t) pow(2,7)) - 1)) << (magBits - 7); //Extract last 7 bits from the first byte
-			int magBitsLeft = magBits - 7;
-			int precBitsLeft = precBits;
-			int ci = 1; //compressed data index
-
-			while(magBitsLeft != 0) {
-				if(magBitsLeft >= 8) { //Whole byte or more of interest
-					beforeDp = beforeDp | (allValues[i].data[ci] << (magBitsLeft-8));
-					magBitsLeft = magBitsLeft - 8;
-					ci--;
-				} else { //LHS of byte of interest, use masks to extract relevant bits
-					beforeDp = beforeDp | ((((uint32_t) pow(2,8)-1) - ((uint32_t) pow(2,8-magBitsLeft)-1)) & allValues[i].data[ci]) >> (8-magBitsLeft);
-					magBitsLeft = 0;
-				}
-			}
-			while(precBitsLeft != 0) {
-				if(precBitsLeft >= 8) { //Precision is the whole byte
-					afterDp = afterDp | allValues[i].data[ci];
-					precBitsLeft = precBitsLeft - 8;
-				} else { //Precision is on RHS and part on LHS is to be ignored
-					afterDp = ((uint32_t) pow(2, precBits)-1) & allValues[i].data[ci];
-					ci--;
-					precBitsLeft = 0;
-				}
-			}
-		}
-		uncompressed[i] = signMultiplier * (beforeDp + ((float) afterDp) / divider);
-	}
-	return uncompressed;
+static inline unsigned int writeRunlengthLiteral(unsigned char *out, const float *values, unsigned int length) {
+	unsigned int written = writeVarint(out, (uint64_t) length << 1);
+	memcpy(out + written, values, length * sizeof(float));
+	return written + length * sizeof(float);
 }
 
 /*
  * Purpose:
- *		Retrieve and decompress a single value from an array of 24 bit compressed values.
+ *		Find where the run of values equal to values[start] ends, comparing values by their bits one at a time. The vector kernels below
+ *		compare 4 (SSE2), 8 (AVX2) or 16 (AVX-512) at a time and finish off with this.
  * Returns:
- *		Value converted back to float, possibly with precision lost.
+ *		Index of the first value from i on that differs from bits, or count if the run reaches the end.
  * Parameters:
- *		1. allValues - An array of 24 bit compressed values
- *		2. count - The number of 24 bit compressed values in allValues
- * 		2. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
- *		3. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ *		1. values - Array being scanned
+ *		2. i - Index to start comparing from
+ *		3. count - Number of values in the array
+ *		4. bits - Bits of the value the run repeats
  */
-float getSingle24BitValue(struct compressedVal *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
-	unsigned int beforeDp = 0;
-	unsigned int afterDp = 0;
-	unsigned int divider;
-	int signMultiplier = 0;
+static inline unsigned int finishRunEnd(const float *values, unsigned int i, unsigned int count, uint32_t bits) {
+	while(i < count && floatBits(values[i]) == bits) {
+		i++;
+	}
+	return i;
+}
 
-	//setup value to divide integer for after decimal
-	if(numberOfDigits(precBits) == 1) {
-		divider = 10;
-	} else {
-		divider = pow(10, numberOfDigits(precBits)-1);
+static unsigned int findRunEndScalar(const float *values, unsigned int start, unsigned int count) {
+	return finishRunEnd(values, start + 1, count, floatBits(values[start]));
+}
+
+/*
+ * Purpose:
+ *		Fill length floats with the same value, the vector kernels below use this for what is left after their vector stores
+ */
+static void fillRunScalar(float *out, float value, unsigned int length) {
+	unsigned int i;
+
+	for(i = 0; i < length; i++) {
+		out[i] = value;
 	}
+}
 
-	struct compressedVal targetVal = allValues[index];
+#ifdef COMPRESSOR_X86
+__attribute__((target("sse2")))
+static unsigned int findRunEndSSE2(const float *values, unsigned int start, unsigned int count) {
+	uint32_t bits = floatBits(values[start]);
+	__m128i target = _mm_set1_epi32(bits);
+	unsigned int i = start + 1;
+	unsigned int mask;
 
-	//sign bit extraction
-	if(targetVal.data[2] >> 7 == 1) {
-		signMultiplier = -1;
-	} else {
-		signMultiplier = 1;
+	while(i + 4 <= count) {
+		mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (values + i)), target)));
+		if(mask != 0xF) {
+			return i + __builtin_ctz(~mask); //first lane that differs
+		}
+		i += 4;
+	}
+	return finishRunEnd(values, i, count, bits);
+}
+
+__attribute__((target("avx2")))
+static unsigned int findRunEndAVX2(const float *values, unsigned int start, unsigned int count) {
+	uint32_t bits = floatBits(values[start]);
+	__m256i target = _mm256_set1_epi32(bits);
+	unsigned int i = start + 1;
+	unsigned int mask;
+
+	while(i + 8 <= count) {
+		mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (values + i)), target)));
+		if(mask != 0xFF) {
+			return i + __builtin_ctz(~mask);
+		}
+		i += 8;
 	}
+	return finishRunEnd(values, i, count, bits);
+}
 
-	if(magBits + 1 < 8) { //Magnitude in byte 2 as well as precision and precision in byte 1 and 0
-			beforeDp = (targetVal.data[2] >> (7-magBits)) & (uint32_t) (pow(2, magBits)-1); //Shift off the extra precision then AND to keep bits of interest
-			afterDp = (targetVal.data[2] & (uint32_t) (pow(2,(precBits % 8))-1)) << 16; //use AND to keep the number of bits on RHS we want for precision and shift into place
-			afterDp = afterDp | (targetVal.data[1] << 8);
-			afterDp = afterDp | targetVal.data[0];
-		} else if(magBits + 1 == 8) { //Magnitude and sign bit fill up byte 2, precision in other 2 bytes
-			beforeDp = targetVal.data[2] & (uint32_t) (pow(2, magBits)-1); //Extract RHS 7 bits we want and take precision
-			afterDp = targetVal.data[1] << 8;
-			afterDp = afterDp | targetVal.data[0];
-		} else if(magBits+1 > 8) { //Magnitude fills over a byte and more
-			beforeDp = (targetVal.data[2] & (((uint32_t) pow(2,7)) - 1)) << (magBits - 7); //Extract last 7 bits from the first byte
-			magBits = magBits - 7;
-			int precBitsLeft = precBits;
-			int ci = 1; //compressed data index
-
-			while(magBits != 0) { //while magnitude bits left to decompress
-				if(magBits >= 8) { //Whole byte or more of interest
-					beforeDp = beforeDp | (targetVal.data[ci] << (magBits-8));
-					magBits = magBits - 8;
-					ci--;
-				} else { //LHS of byte of interest, use masks to extract relevant bits
-					beforeDp = beforeDp | ((((uint32_t) pow(2,8)-1) - ((uint32_t) pow(2,8-magBits)-1)) & targetVal.data[ci]) >> (8-magBits);
-					magBits = 0;
-				}
+__attribute__((target("avx512f")))
+static unsigned int findRunEndAVX512(const float *values, unsigned int start, unsigned int count) {
+	uint32_t bits = floatBits(values[start]);
+	__m512i target = _mm512_set1_epi32(bits);
+	unsigned int i = start + 1;
+	unsigned int mask;
+
+	while(i + 16 <= count) {
+		mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(values + i), target);
+		if(mask != 0xFFFF) {
+			return i + __builtin_ctz(~mask);
+		}
+		i += 16;
+	}
+	return finishRunEnd(values, i, count, bits);
+}
+
+__attribute__((target("sse2")))
+static void fillRunSSE2(float *out, float value, unsigned int length) {
+	__m128 fill = _mm_set1_ps(value);
+	unsigned int i = 0;
+
+	for(; i + 4 <= length; i += 4) {
+		_mm_storeu_ps(out + i, fill);
+	}
+	fillRunScalar(out + i, value, length - i);
+}
+
+__attribute__((target("avx2")))
+static void fillRunAVX2(float *out, float value, unsigned int length) {
+	__m256 fill = _mm256_set1_ps(value);
+	unsigned int i = 0;
+
+	for(; i + 8 <= length; i += 8) {
+		_mm256_storeu_ps(out + i, fill);
+	}
+	fillRunScalar(out + i, value, length - i);
+}
+
+__attribute__((target("avx512f")))
+static void fillRunAVX512(float *out, float value, unsigned int length) {
+	__m512 fill = _mm512_set1_ps(value);
+	unsigned int i = 0;
+
+	for(; i + 16 <= length; i += 16) {
+		_mm512_storeu_ps(out + i, fill);
+	}
+	fillRunScalar(out + i, value, length - i);
+}
+#endif
+
+/*
+ * Purpose:
+ *		Find where the run of values equal to values[start] ends with the selected kernel.
+ * Returns:
+ *		Index of the first value after start that differs from values[start], or count if the run reaches the end.
+ */
+static inline unsigned int findRunEnd(const float *values, unsigned int start, unsigned int count) {
+	return kernels->findRunEnd(values, start, count);
+}
+
+/*
+ * Purpose:
+ *		Fill length floats with the same value with the selected kernel.
+ */
+static inline void fillRun(float *out, float value, unsigned int length) {
+	kernels->fillRun(out, value, length);
+}
+
+/* 
+ * Purpose:
+ *		Using runlength compression, compress an array of floats into a byte stream of literal spans and run spans (PackBits style).
+ *		Format: varint total value count, then spans. Each span starts with a varint of (length << 1 | isRun). A run span is followed by
+ *		the single repeated float, a literal span by its length floats. Repeats become runs only when that saves space, so the output is never
+ *		more than the raw floats plus RUNLENGTH_MAX_OVERHEAD bytes. Values are compared by their bits so the compression is lossless.
+ * Returns:
+ * 		Exactly sized byte array holding the runlength compressed version of the given values.
+ * Parameters:
+ * 		1. allValues - Array of float values that are to be compressed.
+ * 		2. count - A count of the number of values in the given data.
+ * 		3. newCount - Blank pointer that gets assigned the number of bytes in the runlength compressed data.
+ */
+unsigned char *getRunlengthCompressedData(float *allValues, unsigned int count, unsigned int *newCount) {
+	unsigned char *compressedData = malloc((size_t) count*sizeof(float) + RUNLENGTH_MAX_OVERHEAD); //worst case, trimmed once we know the size
+	unsigned int ci = writeVarint(compressedData, count); //ci = compressed array index
+	unsigned int uci = 0; //uci = uncompressed array index
+	unsigned int literalStart = 0;
+	unsigned int runEnd;
+
+	while(uci < count) {
+		runEnd = findRunEnd(allValues, uci, count); //find how far the current value repeats
+		//a run of 2 only saves space if the literal it splits has a short (<= 3 byte) header, longer runs always do
+		if(runEnd - uci >= 3 || (runEnd - uci == 2 && uci - literalStart < (1U << 20))) { //close off any literal values before the run and write it
+			if(literalStart != uci) {
+				ci += writeRunlengthLiteral(compressedData + ci, allValues + literalStart, uci - literalStart);
 			}
-			while(precBitsLeft != 0) { //while precision bits left to decompress
-				if(precBitsLeft >= 8) { //Precision is the whole byte
-					afterDp = afterDp | targetVal.data[ci];
-					precBitsLeft = precBitsLeft - 8;
-				} else { //Precision is on RHS and part on LHS is to be ignored
-					afterDp = ((uint32_t) pow(2, precBits)-1) & targetVal.data[ci];
-					ci--;
-					precBitsLeft = 0;
-				}
+			ci += writeVarint(compressedData + ci, ((uint64_t) (runEnd - uci) << 1) | 1);
+			memcpy(compressedData + ci, &allValues[uci], sizeof(float));
+			ci += sizeof(float);
+			literalStart = runEnd;
+		}
+		uci = runEnd;
+	}
+	if(literalStart != count) {
+		ci += writeRunlengthLiteral(compressedData + ci, allValues + literalStart, count - literalStart);
+	}
+	*newCount = ci;
+	return realloc(compressedData, ci);
+}
+
+struct runlengthCheckpoint { //a span in the runlength stream and the index of the first value it expands to
+	unsigned int offset;
+	unsigned int start;
+};
+
+/*
+ * Purpose:
+ *		Check that the spans of a runlength stream stay inside its bytes and expand to exactly totalCount values, so the decoders can trust them.
+ * Returns:
+ *		1 if the spans are valid, 0 if the stream is cut short or damaged.
+ * Parameters:
+ *		1. compressedValues - byte array from getRunlengthCompressedData
+ *		2. ci - Offset of the first span
+ *		3. count - the number of bytes in compressedValues
+ *		4. totalCount - Number of values the stream should expand to
+ */
+static int checkRunlengthSpans(const unsigned char *compressedValues, unsigned int ci, unsigned int count, uint64_t totalCount) {
+	const unsigned char *end = compressedValues + count;
+	uint64_t control, length, payload;
+	uint64_t start = 0;
+	unsigned int headerBytes;
+
+	while(ci < count) {
+		if((headerBytes = readBoundedVarint(compressedValues + ci, end, &control)) == 0) {
+			return 0;
+		}
+		ci += headerBytes;
+		length = control >> 1;
+		payload = (control & 1) ? sizeof(float) : length*sizeof(float);
+		if(length == 0 || length > totalCount - start || payload > count - ci) { //the encoder never writes an empty span
+			return 0;
+		}
+		ci += payload;
+		start += length;
+	}
+	return start == totalCount;
+}
+
+/*
+ * Purpose:
+ *		Walk the span headers (a prefix sum of span lengths) and record, for each of parts equal slices of the output, the span its first value is in.
+ * Parameters:
+ *		1. compressedValues - byte array from getRunlengthCompressedData
+ *		2. ci - Offset of the first span
+ *		3. count - the number of bytes in compressedValues
+ *		4. totalCount - Number of values the stream expands to
+ *		5. checkpoints - Array of parts checkpoints that gets filled in
+ *		6. parts - Number of output slices
+ */
+static void findRunlengthCheckpoints(const unsigned char *compressedValues, unsigned int ci, unsigned int count, uint64_t totalCount, struct runlengthCheckpoint *checkpoints, int parts) {
+	uint64_t control;
+	unsigned int start = 0;
+	unsigned int length, headerBytes;
+	int part = 0;
+
+	while(ci < count && part < parts) {
+		headerBytes = readVarint(compressedValues + ci, &control);
+		length = control >> 1;
+		while(part < parts && (uint64_t) part*totalCount/parts < start + length) {
+			checkpoints[part].offset = ci;
+			checkpoints[part].start = start;
+			part++;
+		}
+		ci += headerBytes + ((control & 1) ? 1 : length) * sizeof(float); //skip the payload without reading it
+		start += length;
+	}
+}
+
+/*
+ * Purpose:
+ *		Expand the values in [lo, hi) of a runlength stream, starting from the span at offset ci which expands to values from start onwards.
+ * Parameters:
+ *		1. compressedValues - byte array from getRunlengthCompressedData
+ *		2. ci - Offset of a span that expands to value lo or earlier
+ *		3. count - the number of bytes in compressedValues
+ *		4. start - Index of the first value the span at ci expands to
+ *		5. out - The full output array
+ *		6. lo - First value to write
+ *		7. hi - One past the last value to write
+ */
+static void decodeRunlengthRange(const unsigned char *compressedValues, unsigned int ci, unsigned int count, unsigned int start, float *out, unsigned int lo, unsigned int hi) {
+	uint64_t control;
+	unsigned int length, from, to;
+	float value;
+
+	while(ci < count && start < hi) {
+		ci += readVarint(compressedValues + ci, &control);
+		length = control >> 1;
+		from = start < lo ? lo : start; //clip the span to this slice
+		to = start + length > hi ? hi : start + length;
+		if(control & 1) { //run span, "unwrap" the value length times
+			memcpy(&value, compressedValues + ci, sizeof(float));
+			ci += sizeof(float);
+			if(to > from) {
+				fillRun(out + from, value, to - from);
+			}
+		} else { //literal span, values are stored as they are
+			if(to > from) {
+				memcpy(out + from, compressedValues + ci + (size_t) (from - start) * sizeof(float), (size_t) (to - from) * sizeof(float));
 			}
+			ci += length * sizeof(float);
 		}
-		return signMultiplier * (beforeDp + ((float) afterDp) / divider);
+		start += length;
+	}
 }
 
 /*
  * Purpose:
- *		Compress and insert a floating point value into the array of 24 bit compressed values
+ * 		Decompress a runlength compressed set of floats into the original array of floats. The compressed data is left untouched so it can be decompressed again.
+ *		When built with OpenMP and the output is at least RUNLENGTH_PARALLEL_MIN values, the output is split into one equal slice per thread and
+ *		each thread decodes its slice from the span found for it by a prefix sum over the span lengths.
+ * Returns:
+ * 		Array of floats represented the uncompressed version of the given data, NULL if the data is cut short or damaged.
  * Parameters:
- *		1. allValues - The array of 24 bit compressed values
- *		2. updated - The floating point value to be compressed and inserted to allValues
- *		3. index - The index the new value is to override
- * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
- *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ * 		1. compressedValues - byte array from getRunlengthCompressedData
+ * 		2. count - the number of bytes in compressedValues
+ * 		3. newCount - blank pointer that gets assigned the number of entries in the returned decompressed data
  */
-void insertSingle24BitValue(struct compressedVal *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
-	//clear existing bytes
-	allValues[index].data[2] = 0;
-	allValues[index].data[1] = 0;
-	allValues[index].data[0] = 0;
+float *getRunlengthDecompressedData(unsigned char *compressedValues, unsigned int count, unsigned int *newCount) {
+	uint64_t totalCount;
+	unsigned int ci = readBoundedVarint(compressedValues, compressedValues + count, &totalCount);
+	float *uncompressedValues;
+	struct runlengthCheckpoint *checkpoints;
+	int parts = 1;
+	int p;
+
+	if(ci == 0 || totalCount > UINT_MAX || !checkRunlengthSpans(compressedValues, ci, count, totalCount)) {
+		return NULL;
+	}
+	uncompressedValues = malloc(totalCount*sizeof(float));
+#ifdef _OPENMP
+	if(totalCount >= RUNLENGTH_PARALLEL_MIN) {
+		parts = omp_get_max_threads();
+	}
+#endif
+	if(parts <= 1) {
+		decodeRunlengthRange(compressedValues, ci, count, 0, uncompressedValues, 0, totalCount);
+	} else {
+		checkpoints = malloc(parts * sizeof(struct runlengthCheckpoint));
+		findRunlengthCheckpoints(compressedValues, ci, count, totalCount, checkpoints, parts);
+		#pragma omp parallel for num_threads(parts)
+		for(p = 0; p < parts; p++) {
+			decodeRunlengthRange(compressedValues, checkpoints[p].offset, count, checkpoints[p].start, uncompressedValues, p*totalCount/parts, (p + 1)*totalCount/parts);
+		}
+		free(checkpoints);
+	}
+	*newCount = totalCount;
+	return uncompressedValues;
+}
+
+struct bitWriter { //MSB first bit stream written forwards, used by the XOR predictive codec
+	unsigned char *out;
+	size_t pos;
+	uint64_t buffer;
+	unsigned int bits; //bits in buffer not yet written to out (always < 8 between calls)
+};
 
+struct bitReader { //reads a stream written by a bitWriter
+	const unsigned char *in;
+	size_t pos;
+	size_t end; //bytes in the stream, reads past here give zeros and set overrun
+	uint64_t buffer;
+	unsigned int bits;
+	unsigned int overrun;
+};
+
+/*
+ * Purpose:
+ *		Append the low n bits of value to a bit stream.
+ * Parameters:
+ *		1. writer - The stream to write to
+ *		2. value - Bits to write, anything above the low n bits is ignored
+ *		3. n - Number of bits to write (0 to 32)
+ */
+static inline void writeBits(struct bitWriter *writer, uint32_t value, unsigned int n) {
+	writer->buffer = (writer->buffer << n) | (value & (uint32_t) ((1ULL << n) - 1));
+	writer->bits += n;
+	while(writer->bits >= 8) {
+		writer->bits -= 8;
+		writer->out[writer->pos++] = writer->buffer >> writer->bits;
+	}
+}
+
+/*
+ * Purpose:
+ *		Write out any bits still held by a bit stream, padding the last byte with zeros.
+ * Returns:
+ *		The total number of bytes in the stream.
+ */
+static inline size_t flushBits(struct bitWriter *writer) {
+	if(writer->bits > 0) {
+		writer->out[writer->pos++] = writer->buffer << (8 - writer->bits);
+		writer->bits = 0;
+	}
+	return writer->pos;
+}
+
+/*
+ * Purpose:
+ *		Read the next n bits of a bit stream.
+ * Returns:
+ *		The bits read, in the low n bits. Bits past the end of the stream read as 0 and set reader->overrun.
+ * Parameters:
+ *		1. reader - The stream to read from
+ *		2. n - Number of bits to read (0 to 32)
+ */
+static inline uint32_t readBits(struct bitReader *reader, unsigned int n) {
+	while(reader->bits < n) {
+		if(reader->pos < reader->end) {
+			reader->buffer = (reader->buffer << 8) | reader->in[reader->pos++];
+		} else { //the stream was cut short, keep going on zeros and let the caller check overrun
+			reader->buffer <<= 8;
+			reader->overrun = 1;
+		}
+		reader->bits += 8;
+	}
+	reader->bits -= n;
+	return (reader->buffer >> reader->bits) & (uint32_t) ((1ULL << n) - 1);
+}
+
+/*
+ * Purpose:
+ *		Losslessly compress an array of floats by XORing each value's bits with a predicted value's bits (Gorilla/FPC style).
+ *		The prediction is the value predictorStride entries earlier (1 = previous value, nx = previous row, nx*ny = previous plane of a 3D grid),
+ *		or 0.0 for the first predictorStride values. Each value is written as:
+ *			'0' when it matches the prediction exactly
+ *			'10' + the meaningful bits when the XOR fits in the previous value's leading/trailing zero window
+ *			'11' + 5 bits of leading zeros + 5 bits of (meaningful bits - 1) + the meaningful bits otherwise
+ *		The stream is preceded by varints of the value count and predictorStride.
+ * Returns:
+ *		Exactly sized byte array holding the compressed values.
+ * Parameters:
+ *		1. uncompressedData - Array of float values that are to be compressed
+ *		2. count - Number of values in uncompressedData
+ *		3. newCount - Blank pointer that gets assigned the number of bytes in the compressed data
+ *		4. predictorStride - Distance back to the value used as the prediction (at least 1)
+ */
+unsigned char *getXorPredictiveCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int predictorStride) {
+	unsigned char *compressedData = malloc(((size_t) count*44 + 7)/8 + 2*RUNLENGTH_MAX_OVERHEAD); //44 bits is the most a value can take
+	struct bitWriter writer = {compressedData, 0, 0, 0};
+	unsigned int prevLeading = 33; //no window until the first non matching value
+	unsigned int prevTrailing = 0;
+	unsigned int leading, trailing, meaningful;
+	uint32_t xor;
+	unsigned int i;
+
+	assert(predictorStride > 0);
+	writer.pos = writeVarint(compressedData, count);
+	writer.pos += writeVarint(compressedData + writer.pos, predictorStride);
+	for(i = 0; i < count; i++) {
+		xor = floatBits(uncompressedData[i]) ^ (i >= predictorStride ? floatBits(uncompressedData[i - predictorStride]) : 0);
+		if(xor == 0) {
+			writeBits(&writer, 0, 1);
+			continue;
+		}
+		leading = __builtin_clz(xor);
+		trailing = __builtin_ctz(xor);
+		if(leading >= prevLeading && trailing >= prevTrailing) { //reuse the previous window, saves the 10 bit window header
+			writeBits(&writer, 2, 2);
+			writeBits(&writer, xor >> prevTrailing, 32 - prevLeading - prevTrailing);
+		} else {
+			meaningful = 32 - leading - trailing;
+			writeBits(&writer, 3, 2);
+			writeBits(&writer, leading, 5);
+			writeBits(&writer, meaningful - 1, 5);
+			writeBits(&writer, xor >> trailing, meaningful);
+			prevLeading = leading;
+			prevTrailing = trailing;
+		}
+	}
+	*newCount = flushBits(&writer);
+	return realloc(compressedData, *newCount);
+}
+
+/*
+ * Purpose:
+ *		Decompress data from getXorPredictiveCompressedData. The output is bit exact with the values that were compressed.
+ * Returns:
+ *		Array of the decompressed floats, NULL if the data is cut short or damaged.
+ * Parameters:
+ *		1. compressedValues - byte array from getXorPredictiveCompressedData
+ *		2. count - the number of bytes in compressedValues
+ *		3. newCount - blank pointer that gets assigned the number of values in the returned array
+ */
+float *getXorPredictiveDecompressedData(unsigned char *compressedValues, unsigned int count, unsigned int *newCount) {
+	const unsigned char *end = compressedValues + count;
+	uint64_t totalCount, predictorStride;
+	unsigned int ci, read;
+	struct bitReader reader = {compressedValues, 0, count, 0, 0, 0};
+	float *uncompressedValues;
+	unsigned int leading = 0, trailing = 0, meaningful;
+	uint32_t xor, bits;
+	unsigned int i;
+
+	if((ci = readBoundedVarint(compressedValues, end, &totalCount)) == 0
+		|| (read = readBoundedVarint(compressedValues + ci, end, &predictorStride)) == 0 || predictorStride == 0) {
+		return NULL;
+	}
+	ci += read;
+	if(totalCount > UINT_MAX || totalCount > (uint64_t) (count - ci)*8) { //every value takes at least 1 bit
+		return NULL;
+	}
+	reader.pos = ci;
+	uncompressedValues = malloc(totalCount*sizeof(float));
+	for(i = 0; i < totalCount; i++) {
+		bits = i >= predictorStride ? floatBits(uncompressedValues[i - predictorStride]) : 0;
+		if(readBits(&reader, 1)) {
+			if(readBits(&reader, 1)) { //new window
+				leading = readBits(&reader, 5);
+				meaningful = readBits(&reader, 5) + 1;
+				if(leading + meaningful > 32) { //the encoder never writes a window wider than the value
+					break;
+				}
+				trailing = 32 - leading - meaningful;
+			}
+			xor = readBits(&reader, 32 - leading - trailing) << trailing;
+			bits ^= xor;
+		}
+		memcpy(&uncompressedValues[i], &bits, sizeof(float));
+	}
+	if(i < totalCount || reader.overrun) {
+		free(uncompressedValues);
+		return NULL;
+	}
+	*newCount = totalCount;
+	return uncompressedValues;
+}
+
+/*
+ * Purpose:
+ * 		Compress the given data into a 24 bit format using the given parameters to cut down the original data.
+ * Returns:
+ * 		Array of compressedVal (24 bit) values representing a compressed version the original array of 32 bit floats.
+ * Parameters:
+ * 		1. uncompressedData - List of 32 bit floats to be compressed
+ *		2. count - The number of values in the parameter 1.
+ * 		2. magBits - Number of bits to be used to represent the magnitude of the data (bits used for before decimal place).
+ *		3. precBits - Number of bits to be used to represent the precision of the data (bits used for after decimal place).
+ */
+struct compressedVal *get24BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	struct compressedVal *compressedData = calloc(count + 1, sizeof(struct compressedVal)); //Create array for new compressed values, dynamic allocation since this part shouldnt be run on accelerator. Extra record is padding so the 32 bit load of the last record stays in bounds
 	unsigned int multiplier;
+
+	//multiplier for value after decimal
 	if(numberOfDigits(precBits) == 1) {
 		multiplier = 10;
 	} else {
 		multiplier = pow(10, numberOfDigits(precBits)-1); //max number of digits that can be represented by a precBits number
 	}
+	
 	unsigned int i, space, target, ci, uci; //ci = compressed index, uci = uncompressed indexspace is byte space, target is number of bits trying to move
-	struct floatSplitValue value = splitFloat(updatedValue, multiplier); //turn float into 2 ints representing before and after decimal
+	struct floatSplitValue value;
 
-	if (updatedValue < 0) { //Set the sign bit (1 for -ve, 0 for +ve)
-			allValues[index].data[2] = 1 << 7;
+	for(i = 0; i < count; i++) {
+		value = splitFloat(uncompressedData[i], multiplier); //turn float into 2 ints representing before and after decimal
+
+		//extracting sign bit
+		if (uncompressedData[i] < 0) {
+			compressedData[i].data[2] = 1 << 7;
 		}
 		if(magBits + 1 == 8) { //Case with 7 bits of magnitude, 16 of precision
-			allValues[index].data[2] = allValues[index].data[2] | value.beforeDecimal[0];
-			allValues[index].data[1] = value.afterDecimal[1];
-			allValues[index].data[0] = value.afterDecimal[0];
+			compressedData[i].data[2] = compressedData[i].data[2] | value.beforeDecimal[0];
+			compressedData[i].data[1] = value.afterDecimal[1];
+			compressedData[i].data[0] = value.afterDecimal[0];
 		} 
 		else if(magBits + 1 < 8) { //Case where some precision bits are in byte 2 (small mag, high prec)
-			allValues[index].data[2] = allValues[index].data[2] | (value.beforeDecimal[0] << (7-magBits));
-			allValues[index].data[2] = allValues[index].data[2] | value.afterDecimal[2];
-			allValues[index].data[1] = value.afterDecimal[1];
-			allValues[index].data[0] = value.afterDecimal[0];
+			compressedData[i].data[2] = compressedData[i].data[2] | (value.beforeDecimal[0] << 7-magBits);
+			compressedData[i].data[2] = compressedData[i].data[2] | value.afterDecimal[2];
+			compressedData[i].data[1] = value.afterDecimal[1];
+			compressedData[i].data[0] = value.afterDecimal[0];
 		} else if(magBits + 1 > 8) { //Case where magnitude takes up 8 or more bits
 			space = 7; //8-sign
 			ci = 2; //start on LHS byte of compressed struct
@@ -500,452 +1131,3858 @@ void insertSingle24BitValue(struct compressedVal *allValues, float updatedValue,
 				target = magBits;
 			}
 
-			while (target != 0){ //While we have bits to insert and we've got bytes to extract from
-				if (space >= target) { //If we can fit the current values byte into the compressed byte
-					allValues[index].data[ci] = allValues[index].data[ci] | (value.beforeDecimal[uci] << (space-target));
+			while (target != 0) {	//shift in magnitude bits
+				if (space >= target) { //If we can fit the current values byte into the compressed byte, we want RHS of our data
+					compressedData[i].data[ci] = compressedData[i].data[ci] | (value.beforeDecimal[uci] << space-target);
 					space = space - target;
 					if(space == 0) { //If there's no space left, move to the next compressed byte
 						ci--;
 						space = 8;
 					}
-					uci--;
-					if(uci == 0) { //If we're not on our last byte, decrement;
+					if(uci > 0) { //If we're not on our last byte, decrement
+						uci--;
 						target = 8;
 					} else { //Done, get out of while
+						uci--;
 						target = 0;
 					}
-				} else { //We're trying to squeeze more data than we have free indexes
-					allValues[index].data[ci] = allValues[index].data[ci] | (value.beforeDecimal[uci] >> (target-space));
+				} else { //We're trying to squeeze more data than we have free indexes, we want LHS of our data
+					compressedData[i].data[ci] = compressedData[i].data[ci] | (value.beforeDecimal[uci] >> target-space);
 					ci--;
 					target = target-space;
 					space = 8;
 				}
 			}
-			if(magBits >= 17) { //Extract the magnitude, either in last byte or part of byte 1 and all of last byte
-				allValues[index].data[0] = allValues[index].data[0] | (value.afterDecimal[0] & (((uint32_t) pow(2, precBits)) - 1));
+			if(magBits >= 17) { //shift in precision
+				compressedData[i].data[0] = compressedData[i].data[0] | (value.afterDecimal[0] & ((uint32_t) pow(2, precBits) - 1));
 			} else {
-				allValues[index].data[1] = allValues[index].data[1] | value.afterDecimal[1];
-				allValues[index].data[0] = value.afterDecimal[0];
+				compressedData[i].data[1] = compressedData[i].data[1] | value.afterDecimal[1];
+				compressedData[i].data[0] = value.afterDecimal[0];
 			}
 		}
+	}
+	return compressedData;
 }
 
 /*
  * Purpose:
- *		Compress the given array of floats into a potentially non-byte aligned format of the specified magnitude and precision sizes
+ *		Work out where the magnitude and precision fields sit in a 24 bit record for the given sizes. The masks reproduce exactly what the
+ *		original byte by byte decoder extracted for each magBits case, so every record decodes with one load, two shifts and two ANDs.
  * Returns:
- *		Array of chars representing the compressed version of the uncompressed data passed.
+ *		A layout24Bit struct holding the shifts, masks and divider for the given format.
  * Parameters:
- *		1. uncompressedData - The array of floats to be compressed
- *		2. count - The number of elements in uncompressedData
- *		3. newCount - The number of bytes used for the new compressed representation
- * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
- *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ * 		1. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		2. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
  */
-unsigned char *getVariableBitCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int magBits, unsigned int precBits) {
-	unsigned int ci = (int) ceil(((count*(1+magBits+precBits))/(float)8))-1; //calculate starting index of the value 
-	*newCount = ci+1;
-	unsigned char *compressedData = calloc(ci+1, sizeof(unsigned char));
+static struct layout24Bit get24BitLayout(unsigned int magBits, unsigned int precBits) {
+	struct layout24Bit layout;
+	unsigned int precByte;
 
-	int j;
-	unsigned int space = 8;
-	unsigned int target = 1;
-	struct floatSplitValue value;
-	unsigned int multiplier;
+	layout.multiplier = getDecimalMultiplier(precBits);
+	layout.divider = layout.multiplier;
+	layout.magShift = 23 - magBits; //magnitude always sits directly below the sign bit
+	layout.magMask = (1U << magBits) - 1;
 
-	if(numberOfDigits(precBits) == 1) {
-		multiplier = 10;
-	} else {
-		multiplier = pow(10, numberOfDigits(precBits)); //max number of digits that can be represented by a precBits number
+	if(magBits + 1 < 8) { //precision fills the RHS of byte 2 (only precBits % 8 of it) and all of bytes 1 and 0
+		layout.precShift = 0;
+		layout.precMask = (((1U << (precBits % 8)) - 1) << 16) | 0xFFFF;
+	} else if(magBits + 1 == 8) { //precision is bytes 1 and 0
+		layout.precShift = 0;
+		layout.precMask = 0xFFFF;
+	} else { //precision is taken from the byte the magnitude finished in, at most 8 bits of it
+		precByte = 1 - (magBits - 7)/8;
+		layout.precShift = (precBits == 0) ? 0 : 8*precByte;
+		layout.precMask = (precBits >= 8) ? 0xFF : (1U << precBits) - 1;
 	}
-	unsigned int uci = 0;
-	int i;
+	return layout;
+}
+
+/*
+ * Purpose:
+ *		Read the 3 bytes of a 24 bit record as one integer (data[0] is the least significant byte).
+ * Returns:
+ *		The record in the low 24 bits of an unsigned int.
+ * Parameters:
+ *		1. record - Pointer to the record, the byte after it must be readable (see get24BitCompressedData)
+ */
+static inline uint32_t load24BitRecord(const struct compressedVal *record) {
+	uint32_t word;
+	memcpy(&word, record->data, sizeof(uint32_t)); //unaligned 32 bit load, the top byte belongs to the next record
+	return word & 0xFFFFFF;
+}
+
+/*
+ * Purpose:
+ *		Convert a loaded 24 bit record back to a float without any branches.
+ * Returns:
+ *		Value converted back to float, possibly with precision lost.
+ * Parameters:
+ *		1. word - The record as returned by load24BitRecord
+ *		2. layout - Layout of the record from get24BitLayout
+ */
+static inline float decode24BitRecord(uint32_t word, const struct layout24Bit *layout) {
+	uint32_t beforeDp = (word >> layout->magShift) & layout->magMask;
+	uint32_t afterDp = (word >> layout->precShift) & layout->precMask;
+	float value = beforeDp + ((float) afterDp) / layout->divider;
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(float));
+	bits ^= (word >> 23) << 31; //copy the sign bit across, same as multiplying by -1
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+/*
+ * Purpose:
+ *		Decompress count records one at a time, the vector kernels below use this for what is left after their vector loop
+ */
+static void decode24BitRecordsScalar(const struct compressedVal *records, unsigned int count, float *out, const struct layout24Bit *layout) {
+	unsigned int i;
+
 	for(i = 0; i < count; i++) {
-		target = 1;
-		value = splitFloat(uncompressedData[i], multiplier);
-		if(uncompressedData[i] < 0) { //need to deal with -ve sign
-			compressedData[ci] = compressedData[ci] | (1 << (space-target));
-		}
-		space--;
-		if(space==0) { //move onto next compressed byte if we have to
-			ci--;
-			space = 8;
-		} //space 3
-		if(magBits >= 17) { //magnitude is in 3 bytes
-			uci = 2;
-			target = magBits-16;
-		} else if(magBits >=9) { //magnitude in 2 bytes
-			uci = 1;
-			target = magBits-8;
-		} else { //magnitude only in 1
-			uci = 0; //uci becomes 0
-			target = magBits; //target becomes 4
-		}
-		while(target != 0) {//} && uci >= 0) { //deal with magnitude bits
-			if(space >= target) { //If we can fit target into current compressed byte
-				compressedData[ci] = compressedData[ci] | (value.beforeDecimal[uci] << (space-target));
-				space = space - target;
-				if(space == 0) {
-					ci--;
-					space = 8;
-				}
-				if(uci > 0) { //if not on last byte then move further down
-					uci--;
-					target = 8;
-				} else {
-					uci--;
-					target = 0;
-				}
-			} else { //trying to deal with more bits than space
-				compressedData[ci] = compressedData[ci] | (value.beforeDecimal[uci] >> (target-space)); 
-				ci--;
-				target = target - space;
-				space = 8;
-			}
-		}
-		if(precBits >= 17) { //magnitude is in 3 bytes
-			uci = 2;
-			target = precBits-16;
-		} else if(precBits >=9) { //magnitude in 2 bytes
-			uci = 1;
-			target = precBits-8;
-		} else { //magnitude only in 1
-			uci = 0;
-			target = precBits;
-		}
-		while(target != 0) {//} && uci >= 0) { //deal with magnitude bits
-			if(space >= target) { //If we can fit target into current compressed byte
-				compressedData[ci] = compressedData[ci] | (value.afterDecimal[uci] << (space-target));
-				space = space - target;
-				if(space == 0) {
-					ci--;
-					space = 8;
-				}
-				if(uci > 0) { //if not on last byte then move further down
-					uci--;
-					target = 8;
-				} else {
-					uci--;
-					target = 0;
-				}
-			} else { //trying to deal with more bits than space
-				compressedData[ci] = compressedData[ci] | (value.afterDecimal[uci] >> (target-space));
-				ci--;
-				target = target - space;
-				space = 8;
-			}
-		}
+		out[i] = decode24BitRecord(load24BitRecord(&records[i]), layout);
 	}
-	return compressedData;
 }
 
+#ifdef COMPRESSOR_X86
 /*
  * Purpose:
- *		Decompress the given array of compressed values back into floats (precision can be lost)
+ *		Decompress 4 records with SSSE3, pshufb spreads the 3 byte records out into 4 byte lanes which then go through the same
+ *		shift/mask/convert steps as decode24BitRecord.
+ * Parameters:
+ *		1. records - First of the 4 records, 16 bytes are read from here
+ *		2. out - Where the 4 floats are written
+ *		3. layout - Layout of the records from get24BitLayout
+ */
+__attribute__((target("ssse3")))
+static inline void decode24BitRecordsSSSE3(const struct compressedVal *records, float *out, const struct layout24Bit *layout) {
+	const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	__m128i words = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) records), spread);
+	__m128i beforeDp = _mm_and_si128(_mm_srl_epi32(words, _mm_cvtsi32_si128(layout->magShift)), _mm_set1_epi32(layout->magMask));
+	__m128i afterDp = _mm_and_si128(_mm_srl_epi32(words, _mm_cvtsi32_si128(layout->precShift)), _mm_set1_epi32(layout->precMask));
+	__m128 value = _mm_add_ps(_mm_cvtepi32_ps(beforeDp), _mm_div_ps(_mm_cvtepi32_ps(afterDp), _mm_set1_ps(layout->divider)));
+	__m128i sign = _mm_slli_epi32(_mm_srli_epi32(words, 23), 31);
+
+	_mm_storeu_ps(out, _mm_xor_ps(value, _mm_castsi128_ps(sign)));
+}
+
+/*
+ * Purpose:
+ *		Decompress 8 records with AVX2, each 128 bit lane gets 4 records (the second lane is loaded 12 bytes on) and is spread out with vpshufb.
+ * Parameters:
+ *		1. records - First of the 8 records, 28 bytes are read from here
+ *		2. out - Where the 8 floats are written
+ *		3. layout - Layout of the records from get24BitLayout
+ */
+__attribute__((target("avx2")))
+static inline void decode24BitRecordsAVX2(const struct compressedVal *records, float *out, const struct layout24Bit *layout) {
+	const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+	                                        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	__m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) records)),
+	                                        _mm_loadu_si128((const __m128i *) (records + 4)), 1);
+	__m256i words = _mm256_shuffle_epi8(bytes, spread);
+	__m256i beforeDp = _mm256_and_si256(_mm256_srl_epi32(words, _mm_cvtsi32_si128(layout->magShift)), _mm256_set1_epi32(layout->magMask));
+	__m256i afterDp = _mm256_and_si256(_mm256_srl_epi32(words, _mm_cvtsi32_si128(layout->precShift)), _mm256_set1_epi32(layout->precMask));
+	__m256 value = _mm256_add_ps(_mm256_cvtepi32_ps(beforeDp), _mm256_div_ps(_mm256_cvtepi32_ps(afterDp), _mm256_set1_ps(layout->divider)));
+	__m256i sign = _mm256_slli_epi32(_mm256_srli_epi32(words, 23), 31);
+
+	_mm256_storeu_ps(out, _mm256_xor_ps(value, _mm256_castsi256_ps(sign)));
+}
+
+/*
+ * Purpose:
+ *		Decompress 16 records with AVX-512BW, four 128 bit lanes of 4 records each (loaded 12 bytes apart) spread out with vpshufb.
+ * Parameters:
+ *		1. records - First of the 16 records, 52 bytes are read from here
+ *		2. out - Where the 16 floats are written
+ *		3. layout - Layout of the records from get24BitLayout
+ */
+__attribute__((target("avx512f,avx512bw")))
+static inline void decode24BitRecordsAVX512(const struct compressedVal *records, float *out, const struct layout24Bit *layout) {
+	const __m512i spread = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+	__m512i bytes = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i *) records));
+	__m512i words, beforeDp, afterDp, sign;
+	__m512 value;
+
+	bytes = _mm512_inserti32x4(bytes, _mm_loadu_si128((const __m128i *) (records + 4)), 1);
+	bytes = _mm512_inserti32x4(bytes, _mm_loadu_si128((const __m128i *) (records + 8)), 2);
+	bytes = _mm512_inserti32x4(bytes, _mm_loadu_si128((const __m128i *) (records + 12)), 3);
+	words = _mm512_shuffle_epi8(bytes, spread);
+	beforeDp = _mm512_and_si512(_mm512_srl_epi32(words, _mm_cvtsi32_si128(layout->magShift)), _mm512_set1_epi32(layout->magMask));
+	afterDp = _mm512_and_si512(_mm512_srl_epi32(words, _mm_cvtsi32_si128(layout->precShift)), _mm512_set1_epi32(layout->precMask));
+	value = _mm512_add_ps(_mm512_cvtepi32_ps(beforeDp), _mm512_div_ps(_mm512_cvtepi32_ps(afterDp), _mm512_set1_ps(layout->divider)));
+	sign = _mm512_slli_epi32(_mm512_srli_epi32(words, 23), 31);
+	_mm512_storeu_ps(out, _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(value), sign)));
+}
+
+//vector loads read past the records they decode, so each loop stops while its loads stay inside the array
+__attribute__((target("ssse3")))
+static void decode24BitRecordsSSSE3Kernel(const struct compressedVal *records, unsigned int count, float *out, const struct layout24Bit *layout) {
+	unsigned int i = 0;
+
+	for(; i + 6 <= count; i += 4) {
+		decode24BitRecordsSSSE3(&records[i], &out[i], layout);
+	}
+	decode24BitRecordsScalar(records + i, count - i, out + i, layout);
+}
+
+__attribute__((target("avx2")))
+static void decode24BitRecordsAVX2Kernel(const struct compressedVal *records, unsigned int count, float *out, const struct layout24Bit *layout) {
+	unsigned int i = 0;
+
+	for(; i + 10 <= count; i += 8) {
+		decode24BitRecordsAVX2(&records[i], &out[i], layout);
+	}
+	for(; i + 6 <= count; i += 4) {
+		decode24BitRecordsSSSE3(&records[i], &out[i], layout);
+	}
+	decode24BitRecordsScalar(records + i, count - i, out + i, layout);
+}
+
+__attribute__((target("avx512f,avx512bw,avx2")))
+static void decode24BitRecordsAVX512Kernel(const struct compressedVal *records, unsigned int count, float *out, const struct layout24Bit *layout) {
+	unsigned int i = 0;
+
+	for(; i + 18 <= count; i += 16) {
+		decode24BitRecordsAVX512(&records[i], &out[i], layout);
+	}
+	for(; i + 10 <= count; i += 8) {
+		decode24BitRecordsAVX2(&records[i], &out[i], layout);
+	}
+	for(; i + 6 <= count; i += 4) {
+		decode24BitRecordsSSSE3(&records[i], &out[i], layout);
+	}
+	decode24BitRecordsScalar(records + i, count - i, out + i, layout);
+}
+#endif
+
+/*
+ * Purpose:
+ * 		Decompress the 24 bit format data array into a version of the original data with some precision lost, depending on magnitude and precision sizes.
+ *		Records are decoded 16 (AVX-512), 8 (AVX2) or 4 (SSSE3) at a time by the selected kernel, any left over go through decode24BitRecord.
+ *		Output is bit identical either way.
  * Returns:
- *		Array of floats representing the uncompressed contents of allValues.
+ * 		Array of floats representing the data contained in the 24 bit format.
  * Parameters:
- *		1. allValues - The array of compressed values to be decompressed
- *		2. count - The number of bytes (items) that allValues takes up
- *		3. newCount - The number of uncompressed items in the returned value
+ * 		1. allValues - An array of 24 bit compressed values.
+ *		2. count - The number of 24 bit compressed values in parameter allValues
+ * 		2. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		3. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+float *get24BitDecompressedData(struct compressedVal *allValues, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	float *uncompressed = malloc(count * sizeof(float));
+	struct layout24Bit layout = get24BitLayout(magBits, precBits);
+
+	kernels->decode24BitRecords(allValues, count, uncompressed, &layout);
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Retrieve and decompress a single value from an array of 24 bit compressed values.
+ * Returns:
+ *		Value converted back to float, possibly with precision lost.
+ * Parameters:
+ *		1. allValues - An array of 24 bit compressed values (from get24BitCompressedData, so the padding record is present)
+ *		2. index - The index of the value to decompress
+ * 		3. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		4. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+float getSingle24BitValue(struct compressedVal *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct layout24Bit layout = get24BitLayout(magBits, precBits);
+	return decode24BitRecord(load24BitRecord(&allValues[index]), &layout);
+}
+
+/*
+ * Purpose:
+ *		Compress and insert a floating point value into the array of 24 bit compressed values
+ * Parameters:
+ *		1. allValues - The array of 24 bit compressed values
+ *		2. updated - The floating point value to be compressed and inserted to allValues
+ *		3. index - The index the new value is to override
  * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
  *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
  */
-float *getVariableBitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int *newCount, unsigned int magBits, unsigned int precBits) {
-	float *uncompressed = calloc(count, sizeof(float));
-	unsigned int uci = 0; //uncompressedindex (for storing uncomp values)
-	unsigned int beforeDp;
-	unsigned int afterDp;
-	unsigned int i;
-	int signMultiplier;
-	unsigned int ci = count-1; //compressed index
-	unsigned int target; //how many target bits (how many bits trying to insert)
-	unsigned int uncompBits = 8; //uncompressedbits
-	unsigned int uncompLimit =  (uint32_t) (ceil((8*count)/(1+magBits+precBits)));
-	unsigned int divider;
+void insertSingle24BitValue(struct compressedVal *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	//clear existing bytes
+	allValues[index].data[2] = 0;
+	allValues[index].data[1] = 0;
+	allValues[index].data[0] = 0;
 
+	unsigned int multiplier;
 	if(numberOfDigits(precBits) == 1) {
-		divider = 10;
+		multiplier = 10;
 	} else {
-		divider = pow(10, numberOfDigits(precBits)-1);
+		multiplier = pow(10, numberOfDigits(precBits)-1); //max number of digits that can be represented by a precBits number
 	}
-	divider = divider*10;
+	unsigned int i, space, target, ci, uci; //ci = compressed index, uci = uncompressed indexspace is byte space, target is number of bits trying to move
+	struct floatSplitValue value = splitFloat(updatedValue, multiplier); //turn float into 2 ints representing before and after decimal
 
-	//While still have bytes to decompress
-	while(uci != uncompLimit) {
-		beforeDp = 0;
-		afterDp = 0;
-		target = 1;
-		if(((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2,target)-1) == 1) { //extract sign bit
-			signMultiplier = -1;
-		} else {
-			signMultiplier = 1;
+	if (updatedValue < 0) { //Set the sign bit (1 for -ve, 0 for +ve)
+			allValues[index].data[2] = 1 << 7;
 		}
-		uncompBits--;
+		if(magBits + 1 == 8) { //Case with 7 bits of magnitude, 16 of precision
+			allValues[index].data[2] = allValues[index].data[2] | value.beforeDecimal[0];
+			allValues[index].data[1] = value.afterDecimal[1];
+			allValues[index].data[0] = value.afterDecimal[0];
+		} 
+		else if(magBits + 1 < 8) { //Case where some precision bits are in byte 2 (small mag, high prec)
+			allValues[index].data[2] = allValues[index].data[2] | (value.beforeDecimal[0] << (7-magBits));
+			allValues[index].data[2] = allValues[index].data[2] | value.afterDecimal[2];
+			allValues[index].data[1] = value.afterDecimal[1];
+			allValues[index].data[0] = value.afterDecimal[0];
+		} else if(magBits + 1 > 8) { //Case where magnitude takes up 8 or more bits
+			space = 7; //8-sign
+			ci = 2; //start on LHS byte of compressed struct
 
-		if(uncompBits == 0) { //if we run out of space, move onto next byte
-			ci--;
-			uncompBits = 8;
-		}
+			if(magBits >= 17) { //magnitude all 3 bytes
+				uci = 2;
+				target = magBits-16;
+			} else if(magBits >= 9) { // magnitude in byte 2
+				uci = 1;
+				target = magBits - 8;
+			} else { //magnitude in byte 1
+				uci = 0;
+				target = magBits;
+			}
 
-		//deal with magnitude bits
-		target = magBits; //extract magnitude
-		while(target != 0) {
-			if(target > uncompBits) { //trying to extract more bits than available in current byte
-				//find out the number of useful bits we have (it'll be on RHS) AND to get it then move on
-				beforeDp = beforeDp | (((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1) << (target-uncompBits));
-				ci--;
-				target = target - uncompBits;
-				uncompBits = 8;
-			} else { //got what we want in the current byte
-				beforeDp =  beforeDp | ((allValues[ci] >> (uncompBits-target) & (uint32_t) pow(2, target)-1));
-				uncompBits = uncompBits - target;
-				target = 0;
-				if(uncompBits == 0) {
+			while (target != 0){ //While we have bits to insert and we've got bytes to extract from
+				if (space >= target) { //If we can fit the current values byte into the compressed byte
+					allValues[index].data[ci] = allValues[index].data[ci] | (value.beforeDecimal[uci] << (space-target));
+					space = space - target;
+					if(space == 0) { //If there's no space left, move to the next compressed byte
+						ci--;
+						space = 8;
+					}
+					uci--;
+					if(uci == 0) { //If we're not on our last byte, decrement;
+						target = 8;
+					} else { //Done, get out of while
+						target = 0;
+					}
+				} else { //We're trying to squeeze more data than we have free indexes
+					allValues[index].data[ci] = allValues[index].data[ci] | (value.beforeDecimal[uci] >> (target-space));
 					ci--;
-					uncompBits = 8;
+					target = target-space;
+					space = 8;
 				}
 			}
+			if(magBits >= 17) { //Extract the magnitude, either in last byte or part of byte 1 and all of last byte
+				allValues[index].data[0] = allValues[index].data[0] | (value.afterDecimal[0] & (((uint32_t) pow(2, precBits)) - 1));
+			} else {
+				allValues[index].data[1] = allValues[index].data[1] | value.afterDecimal[1];
+				allValues[index].data[0] = value.afterDecimal[0];
+			}
 		}
+}
+
+/*
+ * Purpose:
+ *		Work out the field positions for a byte aligned record. Same rules as the 24 bit format: sign bit at the top, magnitude directly
+ *		below it and precision in the RHS bits, with the same decimal multiplier for the precision.
+ * Returns:
+ *		An alignedLayout struct holding the masks, shifts and multiplier for the given format.
+ * Parameters:
+ *		1. recordBytes - Size of each record in bytes (1, 2, 3 or 4)
+ * 		2. magBits - Number of bits used to represent magnitude.
+ *		3. precBits - Number of bits used to represent precision (1+magBits+precBits must fit in the record).
+ */
+static inline struct alignedLayout getAlignedLayout(unsigned int recordBytes, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout;
+	assert(1 + magBits + precBits <= 8*recordBytes);
+
+	layout.multiplier = getDecimalMultiplier(precBits);
+	layout.divider = layout.multiplier;
+	layout.recordMask = (recordBytes == 4) ? 0xFFFFFFFF : (1U << 8*recordBytes) - 1;
+	layout.signShift = 8*recordBytes - 1;
+	layout.magMask = (1U << magBits) - 1;
+	layout.precBits = precBits;
+	layout.precMask = (1U << precBits) - 1;
+	return layout;
+}
+
+/*
+ * Purpose:
+ *		Load a byte aligned record as an int with a single 32 bit load (data[0] of the record is the least significant byte).
+ * Returns:
+ *		The record in the low recordBytes*8 bits of an unsigned int.
+ * Parameters:
+ *		1. allValues - The array of records (with the padding added by getAligned*BitCompressedData)
+ *		2. index - Index of the record
+ *		3. recordBytes - Size of each record in bytes, a constant in each caller so the compiler specialises this
+ *		4. layout - Layout from getAlignedLayout
+ */
+static inline uint32_t loadAlignedRecord(const unsigned char *allValues, unsigned int index, unsigned int recordBytes, const struct alignedLayout *layout) {
+	uint32_t word;
+	uint16_t halfWord;
+
+	switch(recordBytes) { //plain loads for the power of 2 sizes so bulk loops vectorise, only 3 byte records need the mask
+		case 1:
+			return allValues[index];
+		case 2:
+			memcpy(&halfWord, allValues + (size_t) index*2, sizeof(uint16_t));
+			return halfWord;
+		case 4:
+			memcpy(&word, allValues + (size_t) index*4, sizeof(uint32_t));
+			return word;
+		default:
+			memcpy(&word, allValues + (size_t) index*recordBytes, sizeof(uint32_t));
+			return word & layout->recordMask;
+	}
+}
+
+/*
+ * Purpose:
+ *		Store the low recordBytes bytes of an int as a byte aligned record.
+ * Parameters:
+ *		1. allValues - The array of records
+ *		2. index - Index of the record
+ *		3. recordBytes - Size of each record in bytes
+ *		4. word - The encoded record
+ */
+static inline void storeAlignedRecord(unsigned char *allValues, unsigned int index, unsigned int recordBytes, uint32_t word) {
+	memcpy(allValues + (size_t) index*recordBytes, &word, recordBytes);
+}
+
+/*
+ * Purpose:
+ *		Encode a float into a byte aligned record. The magnitude wraps if it doesnt fit, as in the 24 bit format, but the precision is
+ *		held at precMask: when the decimal multiplier is bigger than the field (e.g. 3 precision bits for one digit) the top digits
+ *		saturate instead of wrapping round to small fractions.
+ * Returns:
+ *		The encoded record in the low bits of an unsigned int.
+ * Parameters:
+ *		1. value - The float to be encoded
+ *		2. layout - Layout from getAlignedLayout
+ */
+static inline uint32_t encodeAlignedRecord(float value, const struct alignedLayout *layout) {
+	float beforeDp, afterDp;
+	uint32_t before, after;
+	afterDp = modff(value, &beforeDp); //same split as splitFloat without breaking the parts into bytes
+	before = ((uint32_t) fabs(beforeDp)) & layout->magMask;
+	after = (uint32_t) round(fabs(afterDp) * layout->multiplier);
+	after = after > layout->precMask ? layout->precMask : after;
+
+	return ((uint32_t) (value < 0) << layout->signShift) | (before << layout->precBits) | after;
+}
+
+/*
+ * Purpose:
+ *		Convert a byte aligned record back into a float without branches.
+ * Returns:
+ *		Value converted back to float, possibly with precision lost.
+ * Parameters:
+ *		1. word - The record as returned by loadAlignedRecord
+ *		2. layout - Layout from getAlignedLayout
+ */
+static inline float decodeAlignedRecord(uint32_t word, const struct alignedLayout *layout) {
+	uint32_t beforeDp = (word >> layout->precBits) & layout->magMask;
+	uint32_t afterDp = word & layout->precMask;
+	float signMultiplier = 1.0f - 2.0f*(word >> layout->signShift); //1 or -1 without a branch, keeps the loop vectorisable
+
+	return signMultiplier * (beforeDp + ((float) afterDp) / layout->divider);
+}
+
+/*
+ * Purpose:
+ *		Shared body of getAligned*BitCompressedData, see those for details.
+ */
+ALWAYS_INLINE unsigned char *getAlignedCompressedData(float *uncompressedData, unsigned int count, unsigned int recordBytes, unsigned int magBits, unsigned int precBits) {
+	unsigned char *compressedData = calloc((size_t) count*recordBytes + sizeof(uint32_t) - 1, sizeof(unsigned char)); //padding so a 32 bit load of the last record stays in bounds
+	struct alignedLayout layout = getAlignedLayout(recordBytes, magBits, precBits);
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		storeAlignedRecord(compressedData, i, recordBytes, encodeAlignedRecord(uncompressedData[i], &layout));
+	}
+	return compressedData;
+}
+
+/*
+ * Purpose:
+ *		Shared body of getAligned*BitDecompressedData, see those for details.
+ */
+ALWAYS_INLINE float *getAlignedDecompressedData(unsigned char *allValues, unsigned int count, unsigned int recordBytes, unsigned int magBits, unsigned int precBits) {
+	float *uncompressed = malloc(count * sizeof(float));
+	struct alignedLayout layout = getAlignedLayout(recordBytes, magBits, precBits);
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		uncompressed[i] = decodeAlignedRecord(loadAlignedRecord(allValues, i, recordBytes, &layout), &layout);
+	}
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Compress the given data into records of 8/16/24/32 bits, each record holds a sign bit, magBits of magnitude and precBits of precision.
+ *		Every width is specialised at compile time from the same shared code.
+ * Returns:
+ *		Array of count records (plus padding) representing a compressed version of the original array of 32 bit floats.
+ * Parameters:
+ * 		1. uncompressedData - List of 32 bit floats to be compressed
+ *		2. count - The number of values in parameter 1.
+ * 		3. magBits - Number of bits to be used to represent the magnitude of the data (bits used for before decimal place).
+ *		4. precBits - Number of bits to be used to represent the precision of the data (bits used for after decimal place).
+ */
+unsigned char *getAligned8BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedCompressedData(uncompressedData, count, 1, magBits, precBits);
+}
+
+unsigned char *getAligned16BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedCompressedData(uncompressedData, count, 2, magBits, precBits);
+}
+
+unsigned char *getAligned24BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedCompressedData(uncompressedData, count, 3, magBits, precBits);
+}
+
+unsigned char *getAligned32BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedCompressedData(uncompressedData, count, 4, magBits, precBits);
+}
+
+/*
+ * Purpose:
+ * 		Decompress an array of 8/16/24/32 bit records back into floats, possibly with precision lost.
+ * Returns:
+ * 		Array of floats representing the data contained in the records.
+ * Parameters:
+ * 		1. allValues - An array of records from the matching getAligned*BitCompressedData.
+ *		2. count - The number of records in allValues
+ * 		3. magBits - Number of bits that have been used to represent magnitude.
+ *		4. precBits - Number of bits that have been used to represent precision.
+ */
+float *getAligned8BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedDecompressedData(allValues, count, 1, magBits, precBits);
+}
+
+float *getAligned16BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedDecompressedData(allValues, count, 2, magBits, precBits);
+}
+
+float *getAligned24BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedDecompressedData(allValues, count, 3, magBits, precBits);
+}
+
+float *getAligned32BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits) {
+	return getAlignedDecompressedData(allValues, count, 4, magBits, precBits);
+}
+
+/*
+ * Purpose:
+ *		Retrieve and decompress a single value from an array of 8/16/24/32 bit records.
+ * Returns:
+ *		Value converted back to float, possibly with precision lost.
+ * Parameters:
+ *		1. allValues - An array of records from the matching getAligned*BitCompressedData
+ *		2. index - The index of the value to decompress
+ * 		3. magBits - Number of bits that have been used to represent magnitude.
+ *		4. precBits - Number of bits that have been used to represent precision.
+ */
+float getSingleAligned8BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(1, magBits, precBits);
+	return decodeAlignedRecord(loadAlignedRecord(allValues, index, 1, &layout), &layout);
+}
+
+float getSingleAligned16BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(2, magBits, precBits);
+	return decodeAlignedRecord(loadAlignedRecord(allValues, index, 2, &layout), &layout);
+}
+
+float getSingleAligned24BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(3, magBits, precBits);
+	return decodeAlignedRecord(loadAlignedRecord(allValues, index, 3, &layout), &layout);
+}
+
+float getSingleAligned32BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(4, magBits, precBits);
+	return decodeAlignedRecord(loadAlignedRecord(allValues, index, 4, &layout), &layout);
+}
+
+/*
+ * Purpose:
+ *		Compress and insert a floating point value into an array of 8/16/24/32 bit records
+ * Parameters:
+ *		1. allValues - The array of records
+ *		2. updatedValue - The floating point value to be compressed and inserted to allValues
+ *		3. index - The index the new value is to override
+ * 		4. magBits - Number of bits that have been used to represent magnitude.
+ *		5. precBits - Number of bits that have been used to represent precision.
+ */
+void insertSingleAligned8BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(1, magBits, precBits);
+	storeAlignedRecord(allValues, index, 1, encodeAlignedRecord(updatedValue, &layout));
+}
+
+void insertSingleAligned16BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(2, magBits, precBits);
+	storeAlignedRecord(allValues, index, 2, encodeAlignedRecord(updatedValue, &layout));
+}
+
+void insertSingleAligned24BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(3, magBits, precBits);
+	storeAlignedRecord(allValues, index, 3, encodeAlignedRecord(updatedValue, &layout));
+}
+
+void insertSingleAligned32BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct alignedLayout layout = getAlignedLayout(4, magBits, precBits);
+	storeAlignedRecord(allValues, index, 4, encodeAlignedRecord(updatedValue, &layout));
+}
+
+/*
+ * Purpose:
+ *		Convert a float to an IEEE 754 half precision record, rounding to nearest even as F16C does. Values too big become infinity, NaNs
+ *		are kept (quietened) and values below the smallest normal become subnormals.
+ */
+static inline uint16_t floatToHalf(float value) {
+	uint32_t bits, magnitude, exponent, mantissa, shift, half;
+	uint16_t sign;
+
+	memcpy(&bits, &value, sizeof(uint32_t));
+	sign = (bits >> 16) & 0x8000;
+	magnitude = bits & 0x7FFFFFFF;
+	if(magnitude > 0x7F800000) { //NaN
+		return sign | 0x7E00 | ((magnitude >> 13) & 0x3FF);
+	} else if(magnitude >= 0x477FF000) { //65520 and up round past the largest half (65504)
+		return sign | 0x7C00;
+	} else if(magnitude >= 0x38800000) { //normal, a carry out of the mantissa moves up to the next exponent
+		magnitude += 0xFFF + ((magnitude >> 13) & 1);
+		return sign | ((magnitude - 0x38000000) >> 13); //0x38000000 moves the exponent from bias 127 to bias 15
+	} else if(magnitude < 0x33000000) { //below half the smallest subnormal
+		return sign;
+	}
+	exponent = magnitude >> 23;
+	mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+	shift = 126 - exponent; //14 to 24, lines the mantissa up with units of 2^-24
+	half = mantissa >> shift;
+	mantissa &= (1U << shift) - 1;
+	if(mantissa > 1U << (shift - 1) || (mantissa == 1U << (shift - 1) && (half & 1))) {
+		half++;
+	}
+	return sign | half;
+}
+
+/*
+ * Purpose:
+ *		Convert an IEEE 754 half precision record to float, exactly apart from signalling NaNs which are quietened
+ */
+static inline float halfToFloat(uint16_t half) {
+	uint32_t sign = (uint32_t) (half & 0x8000) << 16, exponent = (half >> 10) & 0x1F, mantissa = half & 0x3FF, bits;
+	float value;
+
+	if(exponent == 0x1F) {
+		bits = sign | 0x7F800000 | mantissa << 13 | (mantissa ? 0x400000 : 0); //NaNs come out quiet, as F16C gives them
+	} else if(exponent != 0) {
+		bits = sign | (exponent + 112) << 23 | mantissa << 13;
+	} else {
+		value = mantissa * 0x1p-24f; //subnormal (or zero), exact in float
+		memcpy(&bits, &value, sizeof(uint32_t));
+		bits |= sign;
+	}
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+/*
+ * Purpose:
+ *		Convert a float to a bfloat16 record (the top half of the float), rounding to nearest even
+ */
+static inline uint16_t floatToBFloat16(float value) {
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(uint32_t));
+	if((bits & 0x7FFFFFFF) > 0x7F800000) {
+		return (bits >> 16) | 0x40; //quiet NaN, rounding could carry a NaN into infinity
+	}
+	return (bits + 0x7FFF + ((bits >> 16) & 1)) >> 16;
+}
+
+static inline float bfloat16ToFloat(uint16_t record) {
+	uint32_t bits = (uint32_t) record << 16;
+	float value;
+
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+/*
+ * Purpose:
+ *		Half precision conversion kernels for the dispatch table, records are 2 bytes little endian with no alignment needed
+ */
+static void encodeFloat16Scalar(const float *values, unsigned int count, unsigned char *out) {
+	uint16_t record;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		record = floatToHalf(values[i]);
+		memcpy(out + (size_t) i*2, &record, sizeof(uint16_t));
+	}
+}
+
+static void decodeFloat16Scalar(const unsigned char *records, unsigned int count, float *out) {
+	uint16_t record;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		memcpy(&record, records + (size_t) i*2, sizeof(uint16_t));
+		out[i] = halfToFloat(record);
+	}
+}
+
+#ifdef COMPRESSOR_X86
+__attribute__((target("avx2,f16c")))
+static void encodeFloat16F16C(const float *values, unsigned int count, unsigned char *out) {
+	unsigned int i;
+
+	for(i = 0; i + 8 <= count; i += 8) {
+		_mm_storeu_si128((__m128i *) (out + (size_t) i*2), _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+	}
+	encodeFloat16Scalar(values + i, count - i, out + (size_t) i*2);
+}
+
+__attribute__((target("avx2,f16c")))
+static void decodeFloat16F16C(const unsigned char *records, unsigned int count, float *out) {
+	unsigned int i;
+
+	for(i = 0; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) (records + (size_t) i*2))));
+	}
+	decodeFloat16Scalar(records + (size_t) i*2, count - i, out + i);
+}
+
+__attribute__((target("avx512f,avx2,f16c")))
+static void encodeFloat16AVX512(const float *values, unsigned int count, unsigned char *out) {
+	unsigned int i;
+
+	for(i = 0; i + 16 <= count; i += 16) {
+		_mm256_storeu_si256((__m256i *) (out + (size_t) i*2), _mm512_cvtps_ph(_mm512_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+	}
+	encodeFloat16F16C(values + i, count - i, out + (size_t) i*2);
+}
+
+__attribute__((target("avx512f,avx2,f16c")))
+static void decodeFloat16AVX512(const unsigned char *records, unsigned int count, float *out) {
+	unsigned int i;
+
+	for(i = 0; i + 16 <= count; i += 16) {
+		_mm512_storeu_ps(out + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *) (records + (size_t) i*2))));
+	}
+	decodeFloat16F16C(records + (size_t) i*2, count - i, out + i);
+}
+#endif
+
+/*
+ * Purpose:
+ *		Compress the given data into 16 bit IEEE 754 half precision records (1 sign, 5 exponent, 10 mantissa bits), through the F16C or
+ *		AVX-512 conversion instructions when the CPU has them. Relative error is at most 2^-11 between 6.1e-5 and 65504.
+ * Returns:
+ *		Array of 2*count bytes
+ * Parameters:
+ *		1. uncompressedData - The array of floats to be compressed
+ *		2. count - The number of elements in uncompressedData
+ */
+unsigned char *getFloat16CompressedData(float *uncompressedData, unsigned int count) {
+	unsigned char *compressedData = malloc((size_t) count * 2 + 1);
+
+	kernels->encodeFloat16(uncompressedData, count, compressedData);
+	return compressedData;
+}
+
+/*
+ * Purpose:
+ *		Decompress an array of half precision records
+ * Returns:
+ *		Array of count floats
+ * Parameters:
+ *		1. allValues - The records, from getFloat16CompressedData
+ *		2. count - The number of records
+ */
+float *getFloat16DecompressedData(unsigned char *allValues, unsigned int count) {
+	float *uncompressed = malloc((size_t) count * sizeof(float));
+
+	kernels->decodeFloat16(allValues, count, uncompressed);
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Retrieve and decompress a single half precision record, with the F16C instruction when the build targets it
+ * Returns:
+ *		The float at index
+ * Parameters:
+ *		1. allValues - The records
+ *		2. index - The index of the value desired
+ */
+float getSingleFloat16Value(unsigned char *allValues, unsigned int index) {
+	uint16_t record;
+
+	memcpy(&record, allValues + (size_t) index*2, sizeof(uint16_t));
+#if defined(COMPRESSOR_X86) && defined(__F16C__)
+	return _cvtsh_ss(record);
+#else
+	return halfToFloat(record);
+#endif
+}
+
+/*
+ * Purpose:
+ *		Compress and insert a single value into an array of half precision records
+ * Parameters:
+ *		1. allValues - The records
+ *		2. updatedValue - The floating point value to be compressed and inserted
+ *		3. index - The index the new value is to override
+ */
+void insertSingleFloat16Value(unsigned char *allValues, float updatedValue, unsigned int index) {
+#if defined(COMPRESSOR_X86) && defined(__F16C__)
+	uint16_t record = _cvtss_sh(updatedValue, _MM_FROUND_TO_NEAREST_INT);
+#else
+	uint16_t record = floatToHalf(updatedValue);
+#endif
+
+	memcpy(allValues + (size_t) index*2, &record, sizeof(uint16_t));
+}
+
+/*
+ * Purpose:
+ *		Compress the given data into 16 bit bfloat16 records (1 sign, 8 exponent, 7 mantissa bits): the float's range at a relative error
+ *		of at most 2^-8. The conversion is integer only so the loop vectorises without special instructions.
+ * Returns:
+ *		Array of 2*count bytes
+ * Parameters:
+ *		1. uncompressedData - The array of floats to be compressed
+ *		2. count - The number of elements in uncompressedData
+ */
+unsigned char *getBFloat16CompressedData(float *uncompressedData, unsigned int count) {
+	unsigned char *compressedData = malloc((size_t) count * 2 + 1);
+	uint16_t record;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		record = floatToBFloat16(uncompressedData[i]);
+		memcpy(compressedData + (size_t) i*2, &record, sizeof(uint16_t));
+	}
+	return compressedData;
+}
+
+/*
+ * Purpose:
+ *		Decompress an array of bfloat16 records
+ * Returns:
+ *		Array of count floats
+ * Parameters:
+ *		1. allValues - The records, from getBFloat16CompressedData
+ *		2. count - The number of records
+ */
+float *getBFloat16DecompressedData(unsigned char *allValues, unsigned int count) {
+	float *uncompressed = malloc((size_t) count * sizeof(float));
+	uint16_t record;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		memcpy(&record, allValues + (size_t) i*2, sizeof(uint16_t));
+		uncompressed[i] = bfloat16ToFloat(record);
+	}
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Retrieve and decompress a single bfloat16 record
+ * Returns:
+ *		The float at index
+ * Parameters:
+ *		1. allValues - The records
+ *		2. index - The index of the value desired
+ */
+float getSingleBFloat16Value(unsigned char *allValues, unsigned int index) {
+	uint16_t record;
+
+	memcpy(&record, allValues + (size_t) index*2, sizeof(uint16_t));
+	return bfloat16ToFloat(record);
+}
+
+/*
+ * Purpose:
+ *		Compress and insert a single value into an array of bfloat16 records
+ * Parameters:
+ *		1. allValues - The records
+ *		2. updatedValue - The floating point value to be compressed and inserted
+ *		3. index - The index the new value is to override
+ */
+void insertSingleBFloat16Value(unsigned char *allValues, float updatedValue, unsigned int index) {
+	uint16_t record = floatToBFloat16(updatedValue);
+
+	memcpy(allValues + (size_t) index*2, &record, sizeof(uint16_t));
+}
+
+#define CODEBOOK_SAMPLE (1 << 18) //most values a codebook is trained on, spread evenly over the data
+#define CODEBOOK_ITERATIONS 20 //Lloyd-Max passes, most fields settle well before this
+
+static int compareFloats(const void *a, const void *b) {
+	float x = *(const float *) a, y = *(const float *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Purpose:
+ *		Build a scalar quantisation codebook with the Lloyd-Max algorithm (k-means in one dimension) on an even sample of the values.
+ *		Starting from the sample quantiles, each pass moves every entry to the mean of the sample values nearest to it. When the sample
+ *		has no more distinct values than entries the codebook is those values, so low cardinality fields are stored exactly.
+ * Parameters:
+ *		1. values - The data to train on, non finite values are left out
+ *		2. count - The number of elements in values
+ *		3. entries - The number of codebook entries
+ *		4. codebook - Gets the entries in ascending order
+ */
+static void buildCodebook(const float *values, unsigned int count, unsigned int entries, float *codebook) {
+	unsigned int stride = count > CODEBOOK_SAMPLE ? count / CODEBOOK_SAMPLE : 1, sampleCount = 0, distinct = 0, e, i, iteration, lo, hi;
+	float *sample = malloc(((size_t) count / stride + 1) * sizeof(float));
+	double sum;
+	int changed;
+
+	for(i = 0; i < count; i += stride) {
+		if(isfinite(values[i])) {
+			sample[sampleCount++] = values[i];
+		}
+	}
+	qsort(sample, sampleCount, sizeof(float), compareFloats);
+	for(i = 0; i < sampleCount && distinct <= entries; i++) {
+		if(i == 0 || sample[i] != sample[i - 1]) {
+			distinct++;
+		}
+	}
+	if(distinct <= entries) { //the duplicates left at the top are never picked, findCodebookEntry takes the first of equal entries
+		for(i = 0, e = 0; i < sampleCount; i++) {
+			if(i == 0 || sample[i] != sample[i - 1]) {
+				codebook[e++] = sample[i];
+			}
+		}
+		for(; e < entries; e++) {
+			codebook[e] = e > 0 ? codebook[e - 1] : 0.0f;
+		}
+		free(sample);
+		return;
+	}
+	for(e = 0; e < entries; e++) {
+		codebook[e] = sample[(size_t) (2*e + 1) * sampleCount / (2*entries)];
+	}
+	for(iteration = 0, changed = 1; iteration < CODEBOOK_ITERATIONS && changed; iteration++) {
+		changed = 0;
+		for(e = 0, lo = 0; e < entries; e++, lo = hi) { //the cell of entry e runs up to the midpoint with the next entry
+			sum = 0;
+			for(hi = lo; hi < sampleCount && (e == entries - 1 || sample[hi] <= (codebook[e] + codebook[e + 1]) / 2); hi++) {
+				sum += sample[hi];
+			}
+			if(hi > lo && (float) (sum / (hi - lo)) != codebook[e]) {
+				codebook[e] = sum / (hi - lo);
+				changed = 1;
+			}
+		}
+	}
+	free(sample);
+}
+
+/*
+ * Purpose:
+ *		Find the codebook entry nearest a value. The binary search is branch free (the halving step is a conditional move) so stencil
+ *		inserts dont stall on mispredicted compares. Values outside the codebook take the end entries and NaNs entry 0.
+ */
+static inline unsigned int findCodebookEntry(const float *codebook, unsigned int entries, float value) {
+	const float *base = codebook;
+	unsigned int n = entries, half, index;
+
+	while(n > 1) { //base ends on the last entry below value, or entry 0 when there is none
+		half = n / 2;
+		base = base[half] < value ? base + half : base;
+		n -= half;
+	}
+	index = base - codebook;
+	if(index + 1 < entries && codebook[index + 1] - value < value - codebook[index]) {
+		index++;
+	}
+	return index;
+}
+
+static void decodeCodebookScalar(const float *codebook, const unsigned char *indices, unsigned int count, unsigned int indexBits, float *out) {
+	unsigned int i;
+	uint16_t entry;
+
+	if(indexBits == 8) {
+		for(i = 0; i < count; i++) {
+			out[i] = codebook[indices[i]];
+		}
+		return;
+	}
+	for(i = 0; i < count; i++) {
+		memcpy(&entry, indices + (size_t) i*2, sizeof(uint16_t));
+		out[i] = codebook[entry];
+	}
+}
+
+#ifdef COMPRESSOR_X86
+/*
+ * Purpose:
+ *		Decode codebook indices 8 at a time with AVX2, the indices are widened to 32 bits and the entries fetched with vgatherdps
+ */
+__attribute__((target("avx2")))
+static void decodeCodebookAVX2(const float *codebook, const unsigned char *indices, unsigned int count, unsigned int indexBits, float *out) {
+	unsigned int i = 0;
+	__m256i entries;
+
+	for(; i + 8 <= count; i += 8) {
+		if(indexBits == 8) {
+			entries = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (indices + i)));
+		} else {
+			entries = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (indices + (size_t) i*2)));
+		}
+		_mm256_storeu_ps(out + i, _mm256_i32gather_ps(codebook, entries, 4));
+	}
+	decodeCodebookScalar(codebook, indices + (size_t) i * (indexBits / 8), count - i, indexBits, out + i);
+}
+
+__attribute__((target("avx512f")))
+static void decodeCodebookAVX512(const float *codebook, const unsigned char *indices, unsigned int count, unsigned int indexBits, float *out) {
+	unsigned int i = 0;
+	__m512i entries;
+
+	for(; i + 16 <= count; i += 16) {
+		if(indexBits == 8) {
+			entries = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *) (indices + i)));
+		} else {
+			entries = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *) (indices + (size_t) i*2)));
+		}
+		_mm512_storeu_ps(out + i, _mm512_i32gather_ps(entries, codebook, 4));
+	}
+	decodeCodebookScalar(codebook, indices + (size_t) i * (indexBits / 8), count - i, indexBits, out + i);
+}
+#endif
+
+/*
+ * Purpose:
+ *		Compress the given data by scalar quantisation: a codebook of 2^indexBits floats trained on the data (see buildCodebook) followed by
+ *		the index of the nearest entry for each value. With 8 bit indices every value takes one byte and reads back with a single table lookup.
+ * Returns:
+ *		Array of CODEBOOK_BYTES(count, indexBits) bytes, the codebook first, NULL if indexBits isnt 8 or 16
+ * Parameters:
+ *		1. uncompressedData - The array of floats to be compressed
+ *		2. count - The number of elements in uncompressedData
+ *		3. indexBits - 8 or 16
+ */
+unsigned char *getCodebookCompressedData(float *uncompressedData, unsigned int count, unsigned int indexBits) {
+	unsigned int entries, i;
+	unsigned char *compressedData, *indices;
+	float *codebook;
+	uint16_t entry;
+
+	if(indexBits != 8 && indexBits != 16) { //CODEBOOK_ENTRIES shifts by indexBits and the indices are stored as bytes or 16 bit words
+		return NULL;
+	}
+	entries = CODEBOOK_ENTRIES(indexBits);
+	compressedData = malloc(CODEBOOK_BYTES(count, indexBits));
+	codebook = (float *) compressedData;
+	indices = compressedData + entries * sizeof(float);
+	buildCodebook(uncompressedData, count, entries, codebook);
+	for(i = 0; i < count; i++) {
+		entry = findCodebookEntry(codebook, entries, uncompressedData[i]);
+		if(indexBits == 8) {
+			indices[i] = entry;
+		} else {
+			memcpy(indices + (size_t) i*2, &entry, sizeof(uint16_t));
+		}
+	}
+	return compressedData;
+}
+
+/*
+ * Purpose:
+ *		Decompress codebook indices, through the gather kernels when the CPU has them
+ * Returns:
+ *		Array of count floats, NULL if indexBits isnt 8 or 16
+ * Parameters:
+ *		1. allValues - The codebook and indices, from getCodebookCompressedData
+ *		2. count - The number of indices
+ *		3. indexBits - 8 or 16
+ */
+float *getCodebookDecompressedData(unsigned char *allValues, unsigned int count, unsigned int indexBits) {
+	float *uncompressed;
+
+	if(indexBits != 8 && indexBits != 16) { //the kernels read anything but 8 bit indices as 16 bit
+		return NULL;
+	}
+	uncompressed = malloc((size_t) count * sizeof(float) + 1);
+	kernels->decodeCodebook((const float *) allValues, allValues + CODEBOOK_ENTRIES(indexBits) * sizeof(float), count, indexBits, uncompressed);
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Store the nearest codebook entry to a value at one index, the codebook itself doesnt change. Nothing is stored if indexBits isnt 8 or 16.
+ * Parameters:
+ *		1. allValues - The codebook and indices
+ *		2. updatedValue - The floating point value to be compressed and inserted
+ *		3. index - The index the new value is to override
+ *		4. indexBits - 8 or 16
+ */
+void insertSingleCodebookValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int indexBits) {
+	unsigned int entries;
+	uint16_t entry;
+
+	if(indexBits != 8 && indexBits != 16) {
+		return;
+	}
+	entries = CODEBOOK_ENTRIES(indexBits);
+	entry = findCodebookEntry((const float *) allValues, entries, updatedValue);
+	if(indexBits == 8) {
+		allValues[entries * sizeof(float) + index] = entry;
+	} else {
+		memcpy(allValues + entries * sizeof(float) + (size_t) index*2, &entry, sizeof(uint16_t));
+	}
+}
+
+/*
+ * Purpose:
+ *		Divide two fixed point integers rounding half away from zero, which matches how splitFloat rounds the precision.
+ * Returns:
+ *		numerator/denominator rounded to the nearest integer.
+ * Parameters:
+ *		1. numerator - Value to be divided
+ *		2. denominator - Value to divide by (must be positive)
+ */
+static inline int32_t roundedDivide(int64_t numerator, int64_t denominator) {
+	if(numerator < 0) {
+		return -((-numerator + denominator/2) / denominator);
+	}
+	return (numerator + denominator/2) / denominator;
+}
+
+/*
+ * Purpose:
+ *		Retrieve a single value from an array of 24 bit compressed values as a signed fixed point integer (magnitude * multiplier + precision),
+ *		all values in a field share the same multiplier so arithmetic can then be done on the integers directly.
+ * Returns:
+ *		The value in fixed point, e.g. 31.15115 in 1-5-18 (multiplier 100000) is 3115115.
+ * Parameters:
+ *		1. allValues - An array of 24 bit compressed values (from get24BitCompressedData)
+ *		2. index - The index of the value to retrieve
+ * 		3. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		4. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+int32_t getSingle24BitFixedValue(struct compressedVal *allValues, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct layout24Bit layout = get24BitLayout(magBits, precBits);
+	uint32_t word = load24BitRecord(&allValues[index]);
+	int32_t magnitude = ((word >> layout.magShift) & layout.magMask) * layout.multiplier + ((word >> layout.precShift) & layout.precMask);
+	int32_t sign = -(int32_t) (word >> 23); //0 or -1
+
+	return (magnitude ^ sign) - sign;
+}
+
+/*
+ * Purpose:
+ *		Insert a fixed point value into an array of 24 bit compressed values without going through float when precision is in the RHS bits
+ *		of the record (magBits <= 7, which covers 1-5-18 and 1-7-16), other layouts are converted to float and inserted as usual.
+ * Parameters:
+ *		1. allValues - The array of 24 bit compressed values
+ *		2. fixedValue - The fixed point value to be inserted (as from getSingle24BitFixedValue)
+ *		3. index - The index the new value is to override
+ * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+void insertSingle24BitFixedValue(struct compressedVal *allValues, int32_t fixedValue, unsigned int index, unsigned int magBits, unsigned int precBits) {
+	struct layout24Bit layout = get24BitLayout(magBits, precBits);
+	uint32_t magnitude = (fixedValue < 0) ? -(uint32_t) fixedValue : (uint32_t) fixedValue;
+	uint32_t word;
+
+	if(magBits > 7) { //precision doesnt sit in the RHS bits, go through float like insertSingle24BitValue
+		insertSingle24BitValue(allValues, (float) fixedValue / layout.multiplier, index, magBits, precBits);
+		return;
+	}
+	//out of range results wrap in their own fields as the float path does, they must not spill into the sign bit
+	word = ((uint32_t) (fixedValue < 0) << 23) | (((magnitude / layout.multiplier) & layout.magMask) << layout.magShift)
+		| ((magnitude % layout.multiplier) & layout.precMask);
+	allValues[index].data[2] = (word >> 16) & 0xFF;
+	allValues[index].data[1] = (word >> 8) & 0xFF;
+	allValues[index].data[0] = word & 0xFF;
+}
+
+/*
+ * Purpose:
+ *		Convert a float to fixed point using the same split and rounding as the 24 bit compression.
+ * Returns:
+ *		The fixed point representation of value.
+ * Parameters:
+ *		1. value - The float to convert
+ *		2. precBits - Number of bits used to represent precision, sets the multiplier
+ */
+int32_t floatToFixedPoint(float value, unsigned int precBits) {
+	unsigned int multiplier = getDecimalMultiplier(precBits);
+	float beforeDp, afterDp;
+	int32_t magnitude;
+
+	afterDp = modff(value, &beforeDp);
+	magnitude = (int32_t) fabs(beforeDp) * multiplier + (int32_t) round(fabs(afterDp) * multiplier);
+	return (value < 0) ? -magnitude : magnitude;
+}
+
+/*
+ * Purpose:
+ *		Convert a fixed point value back to float, gives the same float as decompressing the record it came from.
+ * Returns:
+ *		The float representation of fixedValue.
+ * Parameters:
+ *		1. fixedValue - The fixed point value to convert
+ *		2. precBits - Number of bits used to represent precision, sets the multiplier
+ */
+float fixedPointToFloat(int32_t fixedValue, unsigned int precBits) {
+	unsigned int multiplier = getDecimalMultiplier(precBits);
+	uint32_t magnitude = (fixedValue < 0) ? -(uint32_t) fixedValue : (uint32_t) fixedValue;
+	int signMultiplier = (fixedValue < 0) ? -1 : 1;
+
+	return signMultiplier * ((magnitude / multiplier) + ((float) (magnitude % multiplier)) / (float) multiplier);
+}
+
+/*
+ * Purpose:
+ *		Add two fixed point values that share the same multiplier.
+ * Returns:
+ *		a + b in fixed point.
+ */
+int32_t fixedPointAdd(int32_t a, int32_t b) {
+	return a + b;
+}
+
+/*
+ * Purpose:
+ *		Scale a fixed point value by numerator/denominator, rounding to the nearest representable value.
+ * Returns:
+ *		value * numerator / denominator in fixed point.
+ * Parameters:
+ *		1. value - The fixed point value to scale
+ *		2. numerator - Scale factor numerator
+ *		3. denominator - Scale factor denominator (must be positive)
+ */
+int32_t fixedPointScale(int32_t value, int32_t numerator, int32_t denominator) {
+	return roundedDivide((int64_t) value * numerator, denominator);
+}
+
+/*
+ * Purpose:
+ *		Average a list of fixed point values (e.g. the neighbours of a point in a stencil), rounding to the nearest representable value.
+ * Returns:
+ *		The mean of values in fixed point, 0 if count is 0.
+ * Parameters:
+ *		1. values - The fixed point values to average
+ *		2. count - The number of values
+ */
+int32_t fixedPointAverage(int32_t *values, unsigned int count) {
+	int64_t total = 0;
+	unsigned int i;
+
+	if(count == 0) {
+		return 0;
+	}
+	for(i = 0; i < count; i++) {
+		total+= values[i];
+	}
+	return roundedDivide(total, count);
+}
+
+/*
+ * Purpose:
+ *		Compress the given array of floats into a potentially non-byte aligned format of the specified magnitude and precision sizes
+ * Returns:
+ *		Array of chars representing the compressed version of the uncompressed data passed.
+ * Parameters:
+ *		1. uncompressedData - The array of floats to be compressed
+ *		2. count - The number of elements in uncompressedData
+ *		3. newCount - The number of bytes used for the new compressed representation
+ * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+unsigned char *getVariableBitCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int magBits, unsigned int precBits) {
+	unsigned int ci = (int) ceil(((count*(1+magBits+precBits))/(float)8))-1; //calculate starting index of the value 
+	*newCount = ci+1;
+	unsigned char *compressedData = calloc(ci+1, sizeof(unsigned char));
+
+	int j;
+	unsigned int space = 8;
+	unsigned int target = 1;
+	struct floatSplitValue value;
+	unsigned int multiplier;
+
+	if(numberOfDigits(precBits) == 1) {
+		multiplier = 10;
+	} else {
+		multiplier = pow(10, numberOfDigits(precBits)); //max number of digits that can be represented by a precBits number
+	}
+	unsigned int uci = 0;
+	int i;
+	for(i = 0; i < count; i++) {
+		target = 1;
+		value = splitFloat(uncompressedData[i], multiplier);
+		if(uncompressedData[i] < 0) { //need to deal with -ve sign
+			compressedData[ci] = compressedData[ci] | (1 << (space-target));
+		}
+		space--;
+		if(space==0) { //move onto next compressed byte if we have to
+			ci--;
+			space = 8;
+		} //space 3
+		if(magBits >= 17) { //magnitude is in 3 bytes
+			uci = 2;
+			target = magBits-16;
+		} else if(magBits >=9) { //magnitude in 2 bytes
+			uci = 1;
+			target = magBits-8;
+		} else { //magnitude only in 1
+			uci = 0; //uci becomes 0
+			target = magBits; //target becomes 4
+		}
+		while(target != 0) {//} && uci >= 0) { //deal with magnitude bits
+			if(space >= target) { //If we can fit target into current compressed byte
+				compressedData[ci] = compressedData[ci] | (value.beforeDecimal[uci] << (space-target));
+				space = space - target;
+				if(space == 0) {
+					ci--;
+					space = 8;
+				}
+				if(uci > 0) { //if not on last byte then move further down
+					uci--;
+					target = 8;
+				} else {
+					uci--;
+					target = 0;
+				}
+			} else { //trying to deal with more bits than space
+				compressedData[ci] = compressedData[ci] | (value.beforeDecimal[uci] >> (target-space)); 
+				ci--;
+				target = target - space;
+				space = 8;
+			}
+		}
+		if(precBits >= 17) { //magnitude is in 3 bytes
+			uci = 2;
+			target = precBits-16;
+		} else if(precBits >=9) { //magnitude in 2 bytes
+			uci = 1;
+			target = precBits-8;
+		} else { //magnitude only in 1
+			uci = 0;
+			target = precBits;
+		}
+		while(target != 0) {//} && uci >= 0) { //deal with magnitude bits
+			if(space >= target) { //If we can fit target into current compressed byte
+				compressedData[ci] = compressedData[ci] | (value.afterDecimal[uci] << (space-target));
+				space = space - target;
+				if(space == 0) {
+					ci--;
+					space = 8;
+				}
+				if(uci > 0) { //if not on last byte then move further down
+					uci--;
+					target = 8;
+				} else {
+					uci--;
+					target = 0;
+				}
+			} else { //trying to deal with more bits than space
+				compressedData[ci] = compressedData[ci] | (value.afterDecimal[uci] >> (target-space));
+				ci--;
+				target = target - space;
+				space = 8;
+			}
+		}
+	}
+	return compressedData;
+}
+
+/*
+ * Purpose:
+ *		Decompress the given array of compressed values back into floats (precision can be lost)
+ * Returns:
+ *		Array of floats representing the uncompressed contents of allValues.
+ * Parameters:
+ *		1. allValues - The array of compressed values to be decompressed
+ *		2. count - The number of bytes (items) that allValues takes up
+ *		3. newCount - The number of uncompressed items in the returned value
+ * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+float *getVariableBitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int *newCount, unsigned int magBits, unsigned int precBits) {
+	float *uncompressed = calloc(count, sizeof(float));
+	unsigned int uci = 0; //uncompressedindex (for storing uncomp values)
+	unsigned int beforeDp;
+	unsigned int afterDp;
+	unsigned int i;
+	int signMultiplier;
+	unsigned int ci = count-1; //compressed index
+	unsigned int target; //how many target bits (how many bits trying to insert)
+	unsigned int uncompBits = 8; //uncompressedbits
+	unsigned int uncompLimit =  (uint32_t) (ceil((8*count)/(1+magBits+precBits)));
+	unsigned int divider;
+
+	if(numberOfDigits(precBits) == 1) {
+		divider = 10;
+	} else {
+		divider = pow(10, numberOfDigits(precBits)-1);
+	}
+	divider = divider*10;
+
+	//While still have bytes to decompress
+	while(uci != uncompLimit) {
+		beforeDp = 0;
+		afterDp = 0;
+		target = 1;
+		if(((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2,target)-1) == 1) { //extract sign bit
+			signMultiplier = -1;
+		} else {
+			signMultiplier = 1;
+		}
+		uncompBits--;
+
+		if(uncompBits == 0) { //if we run out of space, move onto next byte
+			ci--;
+			uncompBits = 8;
+		}
+
+		//deal with magnitude bits
+		target = magBits; //extract magnitude
+		while(target != 0) {
+			if(target > uncompBits) { //trying to extract more bits than available in current byte
+				//find out the number of useful bits we have (it'll be on RHS) AND to get it then move on
+				beforeDp = beforeDp | (((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1) << (target-uncompBits));
+				ci--;
+				target = target - uncompBits;
+				uncompBits = 8;
+			} else { //got what we want in the current byte
+				beforeDp =  beforeDp | ((allValues[ci] >> (uncompBits-target) & (uint32_t) pow(2, target)-1));
+				uncompBits = uncompBits - target;
+				target = 0;
+				if(uncompBits == 0) {
+					ci--;
+					uncompBits = 8;
+				}
+			}
+		}
+
+		//deal with precision bits
+		target = precBits;
+		while(target != 0) {
+			if(target > uncompBits) { //trying to extract more bits than available in current byte
+				//find out the number of useful bits we have (it'll be on RHS) AND to get it then move on
+				afterDp = afterDp | (((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1) << (target-uncompBits));
+				ci--;
+				target = target - uncompBits;
+				uncompBits = 8;
+			} else { //got what we want in the current byte
+				afterDp = afterDp | ((((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2, target)-1)));
+				uncompBits = uncompBits - target;
+				target = 0;
+				if(uncompBits == 0) {
+					ci--;
+					uncompBits = 8;
+				}
+			}
+		}
+		uncompressed[uci] = signMultiplier * (beforeDp + ((float) afterDp) / divider);
+		uci++;
+	}
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Retrieve and decompress a float from the given compressed array
+ * Returns:
+ *		Floating point number decompressed from the array (precision can be lost)
+ * Parameters:
+ *		1. allValues - The array of compressed values
+ *		2. byteCount - The number of bytes (items) that allValues takes up
+ *		3. targetIndex - The index (in the index in uncompressed version of allValues) of the value desired.
+ * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+float getSingleVariableBitValue(unsigned char *allValues, unsigned int byteCount, unsigned int targetIndex, unsigned int magBits, unsigned int precBits) {
+	int startByte = floor(targetIndex*(1+magBits+precBits)/8);
+	int startIndex = (targetIndex*(1+magBits+precBits)) % 8;
+	startByte =  byteCount-1-startByte;
+	startIndex = 7-startIndex;
+	unsigned int divider;
+	if(numberOfDigits(precBits) == 1) {
+		divider = 10;
+	} else {
+		divider = pow(10, numberOfDigits(precBits)-1);
+	}
+	divider = divider*10;
+	unsigned int beforeDp;
+	unsigned int afterDp;
+	int i, signMultiplier;
+	unsigned int ci = startByte;
+	unsigned int target; //how many target bits
+	unsigned int uncompBits = startIndex+1; //uncompressedbits
+
+	beforeDp = 0;
+	afterDp = 0;
+	target = 1;
+
+	//deal with sign
+	if(((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2,target)-1) == 1) { //extract sign bit
+		signMultiplier = -1;
+	} else {
+		signMultiplier = 1;
+	}
+	uncompBits--;
+	if(uncompBits == 0) { //if we run out of space, move onto next byte
+		ci--;
+		uncompBits = 8;
+	}
+
+	//deal with magnitude bits
+	target = magBits; //extract magnitude
+	while(target != 0) {
+		if(target > uncompBits) { //trying to extract more bits than available in current byte
+			//find out the number of useful bits we have (it'll be on RHS) AND to get it then move on
+			beforeDp = beforeDp | (((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1) << (target-uncompBits));
+			ci--;
+			target = target - uncompBits;
+			uncompBits = 8;
+		} else { //got what we want in the current byte
+			beforeDp =  beforeDp | ((allValues[ci] >> (uncompBits-target) & (uint32_t) pow(2, target)-1));
+			uncompBits = uncompBits - target;
+			target = 0;
+			if(uncompBits == 0) {
+				ci--;
+				uncompBits = 8;
+			}
+		}
+	}
+
+	//deal with precision bits
+	target = precBits;
+	while(target != 0) {
+		if(target > uncompBits) { //trying to extract more bits than available in current byte
+			afterDp = afterDp | (((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1) << (target-uncompBits));
+			ci--;
+			target = target - uncompBits;
+			uncompBits = 8;
+		} else { //got what we want in the current byte
+			afterDp = afterDp | ((((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2, target)-1)));
+			uncompBits = uncompBits - target;
+			target = 0;
+			if(uncompBits == 0) {
+				ci--;
+				uncompBits = 8;
+			}
+		}
+	}
+	return signMultiplier * (beforeDp + ((float) afterDp) / divider);
+}
+
+/*
+ * Purpose:
+ *		Compress and insert a given float into the given compressed array
+ * Parameters:
+ *		1. allValues - The array of compressed values
+ *		2. byteCount - The number of bytes (items) that allValues takes up
+ *		3. targetIndex - The index (in the index in uncompressed version of allValues) where value is to be inserted into
+ *		4. value - Floating point value to be inserted
+ * 		5. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
+ *		6. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ */
+void insertSingleVariableBitValue (unsigned char *allValues, unsigned int byteCount, unsigned int targetIndex, float value, unsigned int magBits, unsigned int precBits) {
+	int startByte = floor(targetIndex*(1+magBits+precBits)/8);
+	int startIndex = (targetIndex*(1+magBits+precBits)) % 8;
+	startByte =  byteCount-1-startByte;
+	startIndex = 7-startIndex;
+	unsigned int ci = startByte;
+	int j;
+	unsigned int space = startIndex;
+	unsigned int target = 1;
+	struct floatSplitValue split;
+	unsigned int multiplier;
+
+	if(numberOfDigits(precBits) == 1) {
+		multiplier = 10;
+	} else {
+		multiplier = pow(10, numberOfDigits(precBits)); //max number of digits that can be represented by a precBits number
+	}
+	int totalToZero = 1+magBits+precBits;
+	int currentCount = startIndex;
+	int ind = ci;
+	while(totalToZero != 0) {
+
+		allValues[ind] &= ~(1UL << currentCount);
+		currentCount--;
+		totalToZero--;
+		if(currentCount == -1) {
+			currentCount = 7;
+			ind--;
+		}
+	}
+
+	unsigned int uci = 0; //current floats index
+
+		target = 1;
+		split = splitFloat(value, multiplier);
+
+		if(value < 0) { //need to deal with -ve sign
+
+			allValues[ci] = allValues[ci
+				] | (1 << (startIndex));
+		}
+
+		if(space==0) { //move onto next compressed byte if we have to
+			ci--;
+			space = 8;
+		} //space 3
+		if(magBits >= 17) { //magnitude is in 3 bytes
+			uci = 2;
+			target = magBits-16;
+		} else if(magBits >=9) { //magnitude in 2 bytes
+			uci = 1;
+			target = magBits-8;
+		} else { //magnitude only in 1
+			uci = 0; //uci becomes 0
+			target = magBits; //target becomes 4
+		}
+
+		//while(target != 0 && uci >= 0) { //deal with magnitude bits
+		while(target != 0) {//} && uci >= 0) { //deal with magnitude bits
+			if(space >= target) { //If we can fit target into current compressed byte, need to store whats behind
+
+				allValues[ci] = allValues[ci] | (split.beforeDecimal[uci] << (space-target));
+
+				space = space - target;
+				if(space == 0) {
+					ci--;
+					space = 8;
+				}
+				if(uci > 0) { //if not on last byte then move further down
+					uci--;
+					target = 8;
+				} else {
+					uci--;
+					target = 0;
+				}
+			} else { //trying to deal with more bits than space
+				allValues[ci] = allValues[ci] | (split.beforeDecimal[uci] >> (target-space)); 
+				ci--;
+				target = target - space;
+				space = 8;
+			}
+		}
+		if(precBits >= 17) { //magnitude is in 3 bytes
+			uci = 2;
+			target = precBits-16;
+		} else if(precBits >=9) { //magnitude in 2 bytes
+			uci = 1;
+			target = precBits-8;
+		} else { //magnitude only in 1
+			uci = 0;
+			target = precBits;
+		}
+		while(target != 0) {//deal with prec bits
+			if(space >= target) { //If we can fit target into current compressed byte
+				allValues[ci] = allValues[ci] | (split.afterDecimal[uci] << (space-target));
+				space = space - target;
+				if(space == 0) {
+					ci--;
+					space = 8;
+				}
+				if(uci > 0) { //if not on last byte then move further down
+					uci--;
+					target = 8;
+				} else {
+					uci--;
+					target = 0;
+				}
+			} else { //trying to deal with more bits than space
+				allValues[ci] = allValues[ci] | (split.afterDecimal[uci] >> (target-space));
+				ci--;
+				target = target - space;
+				space = 8;
+			}
+		}
+}
+/*
+ * Purpose:
+ *		Set up a variableBitStream to read or write the records of a variable bit compressed array in index order. Reading and writing the
+ *		whole array this way avoids the per record position maths and read-modify-write of getSingleVariableBitValue/insertSingleVariableBitValue.
+ * Parameters:
+ *		1. stream - The stream to set up
+ *		2. allValues - The compressed array, byteCount bytes long
+ *		3. byteCount - The number of bytes in allValues
+ * 		4. magBits - Number of bits used to represent magnitude
+ *		5. precBits - Number of bits used to represent precision
+ */
+void startVariableBitStream(struct variableBitStream *stream, unsigned char *allValues, unsigned int byteCount, unsigned int magBits, unsigned int precBits) {
+	stream->values = allValues;
+	stream->byteCount = byteCount;
+	stream->next = 0;
+	stream->buffer = 0;
+	stream->bits = 0;
+	stream->magBits = magBits;
+	stream->precBits = precBits;
+	stream->divider = 10 * getDecimalMultiplier(precBits); //same scaling as getVariableBitCompressedData/getVariableBitDecompressedData
+	stream->multiplier = numberOfDigits(precBits) == 1 ? 10 : 10 * getDecimalMultiplier(precBits);
+}
+
+/*
+ * Purpose:
+ *		Append the low n bits (at most 24) of value to a variable bit stream, whole bytes are stored as soon as they fill
+ */
+static inline void pushVariableBits(struct variableBitStream *stream, uint32_t value, unsigned int n) {
+	stream->buffer = (stream->buffer << n) | (value & (uint32_t) ((1ULL << n) - 1));
+	stream->bits += n;
+	while(stream->bits >= 8) {
+		stream->bits -= 8;
+		stream->values[stream->byteCount - 1 - stream->next++] = stream->buffer >> stream->bits;
+	}
+}
+
+/*
+ * Purpose:
+ *		Take the next n bits (at most 24) of a variable bit stream
+ */
+static inline uint32_t pullVariableBits(struct variableBitStream *stream, unsigned int n) {
+	while(stream->bits < n) {
+		stream->buffer = (stream->buffer << 8) | stream->values[stream->byteCount - 1 - stream->next++];
+		stream->bits += 8;
+	}
+	stream->bits -= n;
+	return (stream->buffer >> stream->bits) & (uint32_t) ((1ULL << n) - 1);
+}
+
+#define VARIABLE_BIT_KERNEL_BITS 25 //widest record the vector kernels decode, a record plus its offset in the first byte must fit 32 bit lanes
+#define VARIABLE_BIT_KERNEL_MIN 32 //fewest records readVariableBitValues hands to a vector kernel
+
+#ifdef COMPRESSOR_X86
+/*
+ * Purpose:
+ *		Decompress records of a variable bit array 8 at a time with AVX2. Each lane gathers the 4 stream bytes its record starts in; the
+ *		stream runs backwards through memory so a little endian load of the 4 bytes ending at the record's first byte gives them in stream
+ *		order. The record is then shifted to the top and back down and split the same way as readVariableBitValues.
+ * Returns:
+ *		How many records were decoded, this stops early once a gather would read before the start of values
+ * Parameters:
+ *		1. values - The compressed array
+ *		2. byteCount - Number of bytes in values
+ *		3. bit - Stream bit the first record starts at
+ *		4. count - Number of records wanted
+ *		5. out - Where the floats are written
+ * 		6. magBits - Number of bits used to represent magnitude
+ *		7. precBits - Number of bits used to represent precision
+ *		8. divider - Scaling of the precision field, from startVariableBitStream
+ */
+__attribute__((target("avx2")))
+static unsigned int decodeVariableBitsAVX2(const unsigned char *values, size_t byteCount, size_t bit, unsigned int count, float *out, unsigned int magBits,
+	unsigned int precBits, float divider) {
+	unsigned int recordBits = 1 + magBits + precBits;
+	const __m256i lanes = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(recordBits));
+	const __m128i down = _mm_cvtsi32_si128(32 - recordBits);
+	const __m128i precShift = _mm_cvtsi32_si128(precBits);
+	const __m128i signShift = _mm_cvtsi32_si128(recordBits - 1);
+	const __m256i magMask = _mm256_set1_epi32((1U << magBits) - 1);
+	const __m256i precMask = _mm256_set1_epi32((1U << precBits) - 1);
+	const __m256 scale = _mm256_set1_ps(divider);
+	__m256i offsets, words, records;
+	__m256 value;
+	unsigned int i;
+
+	if(recordBits > VARIABLE_BIT_KERNEL_BITS) {
+		return 0;
+	}
+	for(i = 0; i + 8 <= count; i += 8, bit += 8*recordBits) {
+		if(bit/8 + (bit%8 + 7*recordBits)/8 + 4 > byteCount) { //last lane would read before values
+			break;
+		}
+		offsets = _mm256_add_epi32(lanes, _mm256_set1_epi32(bit % 8)); //bit offsets from the start of the first record's byte
+		words = _mm256_i32gather_epi32((const int *) (values + byteCount - 4 - bit/8), _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_srli_epi32(offsets, 3)), 1);
+		records = _mm256_srl_epi32(_mm256_sllv_epi32(words, _mm256_and_si256(offsets, _mm256_set1_epi32(7))), down);
+		value = _mm256_add_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(records, precShift), magMask)),
+			_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(records, precMask)), scale));
+		_mm256_storeu_ps(out + i, _mm256_xor_ps(value, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srl_epi32(records, signShift), 31))));
+	}
+	return i;
+}
+
+/*
+ * Purpose:
+ *		decodeVariableBitsAVX2 with 16 lanes
+ */
+__attribute__((target("avx512f")))
+static unsigned int decodeVariableBitsAVX512(const unsigned char *values, size_t byteCount, size_t bit, unsigned int count, float *out, unsigned int magBits,
+	unsigned int precBits, float divider) {
+	unsigned int recordBits = 1 + magBits + precBits;
+	const __m512i lanes = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(recordBits));
+	const __m128i down = _mm_cvtsi32_si128(32 - recordBits);
+	const __m128i precShift = _mm_cvtsi32_si128(precBits);
+	const __m128i signShift = _mm_cvtsi32_si128(recordBits - 1);
+	const __m512i magMask = _mm512_set1_epi32((1U << magBits) - 1);
+	const __m512i precMask = _mm512_set1_epi32((1U << precBits) - 1);
+	const __m512 scale = _mm512_set1_ps(divider);
+	__m512i offsets, words, records, sign;
+	__m512 value;
+	unsigned int i;
+
+	if(recordBits > VARIABLE_BIT_KERNEL_BITS) {
+		return 0;
+	}
+	for(i = 0; i + 16 <= count; i += 16, bit += 16*recordBits) {
+		if(bit/8 + (bit%8 + 15*recordBits)/8 + 4 > byteCount) {
+			break;
+		}
+		offsets = _mm512_add_epi32(lanes, _mm512_set1_epi32(bit % 8));
+		words = _mm512_i32gather_epi32(_mm512_sub_epi32(_mm512_setzero_si512(), _mm512_srli_epi32(offsets, 3)), values + byteCount - 4 - bit/8, 1);
+		records = _mm512_srl_epi32(_mm512_sllv_epi32(words, _mm512_and_si512(offsets, _mm512_set1_epi32(7))), down);
+		value = _mm512_add_ps(_mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srl_epi32(records, precShift), magMask)),
+			_mm512_div_ps(_mm512_cvtepi32_ps(_mm512_and_si512(records, precMask)), scale));
+		sign = _mm512_slli_epi32(_mm512_srl_epi32(records, signShift), 31);
+		_mm512_storeu_ps(out + i, _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(value), sign)));
+	}
+	i += decodeVariableBitsAVX2(values, byteCount, bit, count - i, out + i, magBits, precBits, divider);
+	return i;
+}
+
+/*
+ * Purpose:
+ *		Gather records of a variable bit array 8 at a time with AVX2 as decodeVariableBitsAVX2 does, leaving each as a right aligned int
+ * Returns:
+ *		How many records were extracted
+ */
+__attribute__((target("avx2")))
+static unsigned int extractVariableBitsAVX2(const unsigned char *values, size_t byteCount, size_t bit, unsigned int count, uint32_t *out,
+	unsigned int recordBits) {
+	const __m256i lanes = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(recordBits));
+	const __m128i down = _mm_cvtsi32_si128(32 - recordBits);
+	__m256i offsets, words;
+	unsigned int i;
+
+	if(recordBits > VARIABLE_BIT_KERNEL_BITS) {
+		return 0;
+	}
+	for(i = 0; i + 8 <= count; i += 8, bit += 8*recordBits) {
+		if(bit/8 + (bit%8 + 7*recordBits)/8 + 4 > byteCount) {
+			break;
+		}
+		offsets = _mm256_add_epi32(lanes, _mm256_set1_epi32(bit % 8));
+		words = _mm256_i32gather_epi32((const int *) (values + byteCount - 4 - bit/8), _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_srli_epi32(offsets, 3)), 1);
+		_mm256_storeu_si256((__m256i *) (out + i), _mm256_srl_epi32(_mm256_sllv_epi32(words, _mm256_and_si256(offsets, _mm256_set1_epi32(7))), down));
+	}
+	return i;
+}
+
+/*
+ * Purpose:
+ *		extractVariableBitsAVX2 with 16 lanes
+ */
+__attribute__((target("avx512f")))
+static unsigned int extractVariableBitsAVX512(const unsigned char *values, size_t byteCount, size_t bit, unsigned int count, uint32_t *out,
+	unsigned int recordBits) {
+	const __m512i lanes = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(recordBits));
+	const __m128i down = _mm_cvtsi32_si128(32 - recordBits);
+	__m512i offsets, words;
+	unsigned int i;
+
+	if(recordBits > VARIABLE_BIT_KERNEL_BITS) {
+		return 0;
+	}
+	for(i = 0; i + 16 <= count; i += 16, bit += 16*recordBits) {
+		if(bit/8 + (bit%8 + 15*recordBits)/8 + 4 > byteCount) {
+			break;
+		}
+		offsets = _mm512_add_epi32(lanes, _mm512_set1_epi32(bit % 8));
+		words = _mm512_i32gather_epi32(_mm512_sub_epi32(_mm512_setzero_si512(), _mm512_srli_epi32(offsets, 3)), values + byteCount - 4 - bit/8, 1);
+		_mm512_storeu_si512(out + i, _mm512_srl_epi32(_mm512_sllv_epi32(words, _mm512_and_si512(offsets, _mm512_set1_epi32(7))), down));
+	}
+	i += extractVariableBitsAVX2(values, byteCount, bit, count - i, out + i, recordBits);
+	return i;
+}
+#endif
+
+/*
+ * Purpose:
+ *		Decompress the next count records of a variable bit stream, giving the same values as getSingleVariableBitValue. Long reads go
+ *		through the selected vector kernel first, the stream then picks up wherever the kernel stopped.
+ * Parameters:
+ *		1. stream - Stream set up by startVariableBitStream on the compressed array
+ *		2. values - Array of at least count floats to decompress into
+ *		3. count - Number of records to read
+ */
+void readVariableBitValues(struct variableBitStream *stream, float *values, unsigned int count) {
+	unsigned int i = 0, sign, beforeDp, afterDp;
+	size_t bit;
+
+	if(kernels->decodeVariableBits != NULL && count >= VARIABLE_BIT_KERNEL_MIN) {
+		bit = (size_t) stream->next * 8 - stream->bits;
+		i = kernels->decodeVariableBits(stream->values, stream->byteCount, bit, count, values, stream->magBits, stream->precBits, stream->divider);
+		if(i > 0) {
+			bit += (size_t) i * (1 + stream->magBits + stream->precBits);
+			stream->next = bit / 8;
+			stream->bits = 0;
+			if(bit % 8) {
+				pullVariableBits(stream, bit % 8); //leave the rest of the byte buffered
+			}
+		}
+	}
+	for(; i < count; i++) {
+		sign = pullVariableBits(stream, 1);
+		beforeDp = pullVariableBits(stream, stream->magBits);
+		afterDp = pullVariableBits(stream, stream->precBits);
+		values[i] = (sign ? -1 : 1) * (beforeDp + afterDp / stream->divider);
+	}
+}
+
+/*
+ * Purpose:
+ *		Compress count floats onto the end of a variable bit stream, each record is written once in full so the destination doesnt need
+ *		clearing first. Magnitude and precision parts too big for their fields keep only their low bits. Call flushVariableBitStream after the
+ *		last record.
+ * Parameters:
+ *		1. stream - Stream set up by startVariableBitStream on the destination array
+ *		2. values - Floats to compress
+ *		3. count - Number of values to write
+ */
+void writeVariableBitValues(struct variableBitStream *stream, const float *values, unsigned int count) {
+	struct floatSplitValue split;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		split = splitFloat(values[i], stream->multiplier);
+		pushVariableBits(stream, values[i] < 0, 1);
+		pushVariableBits(stream, split.beforeDecimal[0] | split.beforeDecimal[1] << 8 | split.beforeDecimal[2] << 16, stream->magBits);
+		pushVariableBits(stream, split.afterDecimal[0] | split.afterDecimal[1] << 8 | split.afterDecimal[2] << 16, stream->precBits);
+	}
+}
+
+/*
+ * Purpose:
+ *		Store the bits a variable bit stream is still holding, padding the last byte with zeros as getVariableBitCompressedData does
+ */
+void flushVariableBitStream(struct variableBitStream *stream) {
+	if(stream->bits > 0) {
+		stream->values[stream->byteCount - 1 - stream->next++] = stream->buffer << (8 - stream->bits);
+		stream->bits = 0;
+	}
+}
+
+/*
+ * Purpose:
+ *		Move a variableBitStream to the start of record index. A writer keeps the bits before the record in its buffer so the byte they share
+ *		is rewritten whole.
+ */
+static void seekVariableBitStream(struct variableBitStream *stream, unsigned int index, int writing) {
+	size_t bit = (size_t) index * (1 + stream->magBits + stream->precBits);
+
+	stream->next = bit / 8;
+	stream->buffer = 0;
+	stream->bits = 0;
+	if(bit % 8 == 0) {
+		return;
+	}
+	if(writing) {
+		stream->buffer = stream->values[stream->byteCount - 1 - stream->next] >> (8 - bit % 8);
+		stream->bits = bit % 8;
+	} else {
+		pullVariableBits(stream, bit % 8);
+	}
+}
+
+/*
+ * Purpose:
+ *		Finish a writer set up by seekVariableBitStream, keeping the bits after the last record written
+ */
+static void flushVariableBitStreamRange(struct variableBitStream *stream) {
+	unsigned char *last;
+
+	if(stream->bits > 0) {
+		last = &stream->values[stream->byteCount - 1 - stream->next];
+		*last = (stream->buffer << (8 - stream->bits)) | (*last & ((1U << (8 - stream->bits)) - 1));
+		stream->bits = 0;
+	}
+}
+
+#define TRUNCATED_FLOAT_CHUNK 256 //records converted per pass, small enough to stay in L1 between unpacking and converting
+
+/*
+ * Purpose:
+ *		Read the next count records of a variable bit stream as right aligned ints (sign, magnitude and precision fields run together),
+ *		through the selected vector kernel when there is one
+ */
+static void readVariableBitRecords(struct variableBitStream *stream, uint32_t *records, unsigned int count) {
+	unsigned int i = 0, recordBits = 1 + stream->magBits + stream->precBits;
+	size_t bit;
+
+	if(kernels->extractVariableBits != NULL && count >= VARIABLE_BIT_KERNEL_MIN) {
+		bit = (size_t) stream->next * 8 - stream->bits;
+		i = kernels->extractVariableBits(stream->values, stream->byteCount, bit, count, records, recordBits);
+		if(i > 0) { //pick the stream up where the kernel stopped, as readVariableBitValues does
+			bit += (size_t) i * recordBits;
+			stream->next = bit / 8;
+			stream->bits = 0;
+			if(bit % 8) {
+				pullVariableBits(stream, bit % 8);
+			}
+		}
+	}
+	for(; i < count; i++) {
+		records[i] = pullVariableBits(stream, 1 + stream->magBits) << stream->precBits;
+		records[i] |= pullVariableBits(stream, stream->precBits);
+	}
+}
+
+/*
+ * Purpose:
+ *		Append count right aligned records to a variable bit stream, the inverse of readVariableBitRecords
+ */
+static void writeVariableBitRecords(struct variableBitStream *stream, const uint32_t *records, unsigned int count) {
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		pushVariableBits(stream, records[i] >> stream->precBits, 1 + stream->magBits); //two pushes as records can be up to 32 bits
+		pushVariableBits(stream, records[i], stream->precBits);
+	}
+}
+
+/*
+ * Purpose:
+ *		Get the field positions for a truncated float format
+ * Parameters:
+ *		1. expBits - Number of exponent bits, 1 to 8
+ *		2. mantBits - Number of mantissa bits kept, 1 to 23
+ *		3. bias - Exponent bias, stored exponent = IEEE exponent - 127 + bias. TRUNCATED_FLOAT_BIAS(expBits) centres the range on 1.0,
+ *			 bigger biases trade range above 1 for range below it. Must be 127 or less and at least 2^expBits - 129.
+ */
+static inline struct truncatedFloatLayout getTruncatedFloatLayout(unsigned int expBits, unsigned int mantBits, unsigned int bias) {
+	struct truncatedFloatLayout layout;
+
+	layout.mantBits = mantBits;
+	layout.mantMask = (1U << mantBits) - 1;
+	layout.expMask = (1U << expBits) - 1;
+	layout.rebias = 127 - bias;
+	layout.round = mantBits < 23 ? 1U << (22 - mantBits) : 0;
+	layout.signShift = expBits + mantBits;
+	return layout;
+}
+
+/*
+ * Purpose:
+ *		Compress a float to a truncated float record with integer operations only, so loops of it vectorise. The mantissa is rounded to
+ *		nearest (a carry moves up into the exponent), values below the smallest normal the format holds flush to signed zero and values
+ *		above its largest saturate to it. With 8 exponent bits and bias 127 infinities and NaNs keep their IEEE meaning.
+ * Returns:
+ *		The record, right aligned
+ */
+static inline uint32_t encodeTruncatedFloat(float value, const struct truncatedFloatLayout *layout) {
+	uint32_t bits, magnitude, exponent, mantissa;
+
+	memcpy(&bits, &value, sizeof(uint32_t));
+	magnitude = bits & 0x7FFFFFFF;
+	mantissa = magnitude > 0x7F800000 ? 1U << (layout->mantBits - 1) : 0; //NaNs stay NaN once their low payload bits are shaved off
+	magnitude += magnitude < 0x7F800000 ? layout->round : 0;
+	exponent = magnitude >> 23;
+	mantissa |= (magnitude & 0x7FFFFF) >> (23 - layout->mantBits);
+	if(exponent <= layout->rebias) {
+		exponent = layout->rebias; //stored as 0
+		mantissa = 0;
+	} else if(exponent - layout->rebias > layout->expMask) {
+		exponent = layout->expMask + layout->rebias;
+		mantissa = layout->mantMask;
+	}
+	return (bits >> 31) << layout->signShift | (exponent - layout->rebias) << layout->mantBits | mantissa;
+}
+
+/*
+ * Purpose:
+ *		Decompress a truncated float record, stored exponent 0 is zero
+ */
+static inline float decodeTruncatedFloat(uint32_t record, const struct truncatedFloatLayout *layout) {
+	uint32_t exponent = (record >> layout->mantBits) & layout->expMask;
+	uint32_t bits = (record >> layout->signShift) << 31 | (exponent ? (exponent + layout->rebias) << 23 | (record & layout->mantMask) << (23 - layout->mantBits) : 0);
+	float value;
+
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+/*
+ * Purpose:
+ *		Decompress the next count records of a stream set up with the truncated float widths, a chunk at a time so the unpacking can use
+ *		the vector kernels and the conversion loop vectorises
+ */
+static void readTruncatedFloats(struct variableBitStream *stream, float *values, unsigned int count, const struct truncatedFloatLayout *layout) {
+	uint32_t records[TRUNCATED_FLOAT_CHUNK];
+	unsigned int i, j, n;
+
+	for(i = 0; i < count; i += n) {
+		n = count - i < TRUNCATED_FLOAT_CHUNK ? count - i : TRUNCATED_FLOAT_CHUNK;
+		readVariableBitRecords(stream, records, n);
+		for(j = 0; j < n; j++) {
+			values[i + j] = decodeTruncatedFloat(records[j], layout);
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Compress count floats onto the end of a stream set up with the truncated float widths
+ */
+static void writeTruncatedFloats(struct variableBitStream *stream, const float *values, unsigned int count, const struct truncatedFloatLayout *layout) {
+	uint32_t records[TRUNCATED_FLOAT_CHUNK];
+	unsigned int i, j, n;
+
+	for(i = 0; i < count; i += n) {
+		n = count - i < TRUNCATED_FLOAT_CHUNK ? count - i : TRUNCATED_FLOAT_CHUNK;
+		for(j = 0; j < n; j++) {
+			records[j] = encodeTruncatedFloat(values[i + j], layout);
+		}
+		writeVariableBitRecords(stream, records, n);
+	}
+}
+
+/*
+ * Purpose:
+ *		Compress the given array of floats into truncated float records: the sign, a re-biased exponent of expBits and the top mantBits
+ *		of the mantissa, packed back to back in the variable bit stream order. Relative error is at most 2^-(mantBits+1) across the whole
+ *		range the exponent covers.
+ * Returns:
+ *		Array of chars holding the records, the same size as a variable bit array with magBits = expBits and precBits = mantBits
+ * Parameters:
+ *		1. uncompressedData - The array of floats to be compressed
+ *		2. count - The number of elements in uncompressedData
+ *		3. newCount - The number of bytes used for the new compressed representation
+ *		4. expBits - Number of exponent bits, 1 to 8
+ *		5. mantBits - Number of mantissa bits kept, 1 to 23
+ *		6. bias - Exponent bias, see getTruncatedFloatLayout
+ */
+unsigned char *getTruncatedFloatCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int expBits, unsigned int mantBits,
+	unsigned int bias) {
+	struct truncatedFloatLayout layout = getTruncatedFloatLayout(expBits, mantBits, bias);
+	struct variableBitStream stream;
+	unsigned char *compressedData;
+
+	*newCount = ((size_t) count * (1 + expBits + mantBits) + 7) / 8;
+	compressedData = malloc(*newCount > 0 ? *newCount : 1);
+	startVariableBitStream(&stream, compressedData, *newCount, expBits, mantBits);
+	writeTruncatedFloats(&stream, uncompressedData, count, &layout);
+	flushVariableBitStream(&stream);
+	return compressedData;
+}
+
+/*
+ * Purpose:
+ *		Decompress an array of truncated float records
+ * Returns:
+ *		Array of count floats
+ * Parameters:
+ *		1. allValues - The records, from getTruncatedFloatCompressedData
+ *		2. byteCount - The number of bytes allValues takes up
+ *		3. count - The number of records to decompress
+ *		4. expBits - Number of exponent bits the records were written with
+ *		5. mantBits - Number of mantissa bits the records were written with
+ *		6. bias - Exponent bias the records were written with
+ */
+float *getTruncatedFloatDecompressedData(unsigned char *allValues, unsigned int byteCount, unsigned int count, unsigned int expBits, unsigned int mantBits,
+	unsigned int bias) {
+	struct truncatedFloatLayout layout = getTruncatedFloatLayout(expBits, mantBits, bias);
+	struct variableBitStream stream;
+	float *uncompressed = malloc((size_t) count * sizeof(float));
+
+	startVariableBitStream(&stream, allValues, byteCount, expBits, mantBits);
+	readTruncatedFloats(&stream, uncompressed, count, &layout);
+	return uncompressed;
+}
+
+/*
+ * Purpose:
+ *		Retrieve and decompress a single truncated float record
+ * Returns:
+ *		The float at index
+ * Parameters:
+ *		1. allValues - The records
+ *		2. byteCount - The number of bytes allValues takes up
+ *		3. index - The index of the value desired
+ *		4. expBits - Number of exponent bits the records were written with
+ *		5. mantBits - Number of mantissa bits the records were written with
+ *		6. bias - Exponent bias the records were written with
+ */
+float getSingleTruncatedFloatValue(unsigned char *allValues, unsigned int byteCount, unsigned int index, unsigned int expBits, unsigned int mantBits,
+	unsigned int bias) {
+	struct truncatedFloatLayout layout = getTruncatedFloatLayout(expBits, mantBits, bias);
+	struct variableBitStream stream;
+	uint32_t record;
+
+	startVariableBitStream(&stream, allValues, byteCount, expBits, mantBits);
+	seekVariableBitStream(&stream, index, 0);
+	readVariableBitRecords(&stream, &record, 1);
+	return decodeTruncatedFloat(record, &layout);
+}
+
+/*
+ * Purpose:
+ *		Compress and insert a single value into an array of truncated float records, the records either side are left alone
+ * Parameters:
+ *		1. allValues - The records
+ *		2. byteCount - The number of bytes allValues takes up
+ *		3. index - The index the new value is to override
+ *		4. value - The floating point value to be compressed and inserted
+ *		5. expBits - Number of exponent bits the records were written with
+ *		6. mantBits - Number of mantissa bits the records were written with
+ *		7. bias - Exponent bias the records were written with
+ */
+void insertSingleTruncatedFloatValue(unsigned char *allValues, unsigned int byteCount, unsigned int index, float value, unsigned int expBits,
+	unsigned int mantBits, unsigned int bias) {
+	struct truncatedFloatLayout layout = getTruncatedFloatLayout(expBits, mantBits, bias);
+	struct variableBitStream stream;
+	uint32_t record = encodeTruncatedFloat(value, &layout);
+
+	startVariableBitStream(&stream, allValues, byteCount, expBits, mantBits);
+	seekVariableBitStream(&stream, index, 1);
+	writeVariableBitRecords(&stream, &record, 1);
+	flushVariableBitStreamRange(&stream);
+}
+
+/*
+ * Purpose:
+ *		Split count records of width bytes into width planes, plane b holds byte b of every record
+ */
+static void shuffleBytesScalar(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	size_t i;
+	unsigned int b;
+
+	for(b = 0; b < width; b++) {
+		for(i = 0; i < count; i++) {
+			out[b*count + i] = in[i*width + b];
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Undo shuffleBytesScalar
+ */
+static void unshuffleBytesScalar(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	size_t i;
+	unsigned int b;
+
+	for(b = 0; b < width; b++) {
+		for(i = 0; i < count; i++) {
+			out[i*width + b] = in[b*count + i];
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		Transpose an 8x8 bit matrix held in a 64 bit int, bit 8*row + column moves to bit 8*column + row
+ */
+static inline uint64_t transpose8x8Bits(uint64_t x) {
+	uint64_t t;
+
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+	x ^= t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+	x ^= t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+	x ^= t ^ (t << 28);
+	return x;
+}
+
+/*
+ * Purpose:
+ *		Split a byte plane into 8 bit rows, bit i of byte j of row k is bit k of in[8j + i]
+ * Parameters:
+ *		1. in - The byte plane
+ *		2. bytes - Bytes in the plane, a multiple of 8
+ *		3. out - bytes bytes for the rows, row k starts at out + k*bytes/8
+ *		4. start - First group of 8 bytes to transpose, the vector kernels do the ones before it
+ */
+static void transposeBitsFrom(const unsigned char *in, size_t bytes, unsigned char *out, size_t start) {
+	size_t j, rowBytes = bytes / 8;
+	uint64_t x;
+	unsigned int k;
+
+	for(j = start; j < rowBytes; j++) {
+		memcpy(&x, in + 8*j, sizeof(uint64_t)); //bytes are rows of the matrix (little endian), bits are columns
+		x = transpose8x8Bits(x);
+		for(k = 0; k < 8; k++) {
+			out[k*rowBytes + j] = x >> (8*k);
+		}
+	}
+}
+
+static void transposeBitsScalar(const unsigned char *in, size_t bytes, unsigned char *out) {
+	transposeBitsFrom(in, bytes, out, 0);
+}
+
+/*
+ * Purpose:
+ *		Undo transposeBitsFrom for the groups from start on
+ */
+static void untransposeBitsFrom(const unsigned char *in, size_t bytes, unsigned char *out, size_t start) {
+	size_t j, rowBytes = bytes / 8;
+	uint64_t x;
+	unsigned int k;
+
+	for(j = start; j < rowBytes; j++) {
+		x = 0;
+		for(k = 0; k < 8; k++) {
+			x |= (uint64_t) in[k*rowBytes + j] << (8*k);
+		}
+		x = transpose8x8Bits(x);
+		memcpy(out + 8*j, &x, sizeof(uint64_t));
+	}
+}
+
+static void untransposeBitsScalar(const unsigned char *in, size_t bytes, unsigned char *out) {
+	untransposeBitsFrom(in, bytes, out, 0);
+}
+
+#ifdef COMPRESSOR_X86
+/*
+ * Purpose:
+ *		Byte shuffle 16 records at a time with SSSE3, plane b of a block is the OR of one pshufb of each of the width input vectors.
+ *		Inlined with constant widths so the mask loops unroll, the masks are built once per call.
+ */
+__attribute__((target("ssse3")))
+ALWAYS_INLINE void shuffleBytesSSSE3Body(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	__m128i masks[8][8], vectors[8], plane;
+	unsigned char mask[16];
+	unsigned int v, b, e;
+	size_t i;
+
+	for(v = 0; v < width; v++) {
+		for(b = 0; b < width; b++) {
+			for(e = 0; e < 16; e++) { //byte b of record e sits at e*width + b of the block
+				mask[e] = (e*width + b) / 16 == v ? (e*width + b) % 16 : 0x80;
+			}
+			masks[v][b] = _mm_loadu_si128((const __m128i *) mask);
+		}
+	}
+	for(i = 0; i + 16 <= count; i += 16) {
+		for(v = 0; v < width; v++) {
+			vectors[v] = _mm_loadu_si128((const __m128i *) (in + i*width + 16*v));
+		}
+		for(b = 0; b < width; b++) {
+			plane = _mm_shuffle_epi8(vectors[0], masks[0][b]);
+			for(v = 1; v < width; v++) {
+				plane = _mm_or_si128(plane, _mm_shuffle_epi8(vectors[v], masks[v][b]));
+			}
+			_mm_storeu_si128((__m128i *) (out + b*count + i), plane);
+		}
+	}
+	for(b = 0; b < width; b++) {
+		for(e = i; e < count; e++) {
+			out[b*count + e] = in[e*width + b];
+		}
+	}
+}
+
+/*
+ * Purpose:
+ *		The inverse of shuffleBytesSSSE3Body, vector v of a block is the OR of one pshufb of each plane
+ */
+__attribute__((target("ssse3")))
+ALWAYS_INLINE void unshuffleBytesSSSE3Body(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	__m128i masks[8][8], planes[8], vector;
+	unsigned char mask[16];
+	unsigned int v, b, t;
+	size_t i;
+
+	for(b = 0; b < width; b++) {
+		for(v = 0; v < width; v++) {
+			for(t = 0; t < 16; t++) { //byte 16v + t of the block is byte (16v + t) % width of record (16v + t) / width
+				mask[t] = (16*v + t) % width == b ? (16*v + t) / width : 0x80;
+			}
+			masks[b][v] = _mm_loadu_si128((const __m128i *) mask);
+		}
+	}
+	for(i = 0; i + 16 <= count; i += 16) {
+		for(b = 0; b < width; b++) {
+			planes[b] = _mm_loadu_si128((const __m128i *) (in + b*count + i));
+		}
+		for(v = 0; v < width; v++) {
+			vector = _mm_shuffle_epi8(planes[0], masks[0][v]);
+			for(b = 1; b < width; b++) {
+				vector = _mm_or_si128(vector, _mm_shuffle_epi8(planes[b], masks[b][v]));
+			}
+			_mm_storeu_si128((__m128i *) (out + i*width + 16*v), vector);
+		}
+	}
+	for(b = 0; b < width; b++) {
+		for(t = i; t < count; t++) {
+			out[t*width + b] = in[b*count + t];
+		}
+	}
+}
+
+//widths above 8 dont gain from the pshufb version, the scalar loops are already streaming whole planes
+__attribute__((target("ssse3")))
+static void shuffleBytesSSSE3(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	switch(width) {
+		case 3: shuffleBytesSSSE3Body(in, count, 3, out); break;
+		case 4: shuffleBytesSSSE3Body(in, count, 4, out); break;
+		case 2: case 5: case 6: case 7: case 8: shuffleBytesSSSE3Body(in, count, width, out); break;
+		default: shuffleBytesScalar(in, count, width, out);
+	}
+}
+
+__attribute__((target("ssse3")))
+static void unshuffleBytesSSSE3(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	switch(width) {
+		case 3: unshuffleBytesSSSE3Body(in, count, 3, out); break;
+		case 4: unshuffleBytesSSSE3Body(in, count, 4, out); break;
+		case 2: case 5: case 6: case 7: case 8: unshuffleBytesSSSE3Body(in, count, width, out); break;
+		default: unshuffleBytesScalar(in, count, width, out);
+	}
+}
+
+/*
+ * Purpose:
+ *		transposeBitsFrom with SSE2, pmovmskb gathers the top bit of 16 bytes (two rows' worth of one bit) and paddb moves the next bit up
+ */
+__attribute__((target("sse2")))
+static void transposeBitsSSE2(const unsigned char *in, size_t bytes, unsigned char *out) {
+	size_t j, rowBytes = bytes / 8;
+	unsigned int k, mask;
+	uint16_t bits;
+	__m128i x;
+
+	for(j = 0; j + 2 <= rowBytes; j += 2) {
+		x = _mm_loadu_si128((const __m128i *) (in + 8*j));
+		for(k = 8; k-- > 0;) {
+			mask = _mm_movemask_epi8(x);
+			bits = mask;
+			memcpy(out + k*rowBytes + j, &bits, sizeof(uint16_t));
+			x = _mm_add_epi8(x, x);
+		}
+	}
+	transposeBitsFrom(in, bytes, out, j);
+}
+
+__attribute__((target("avx2")))
+static void transposeBitsAVX2(const unsigned char *in, size_t bytes, unsigned char *out) {
+	size_t j, rowBytes = bytes / 8;
+	uint32_t mask;
+	unsigned int k;
+	__m256i x;
+
+	for(j = 0; j + 4 <= rowBytes; j += 4) {
+		x = _mm256_loadu_si256((const __m256i *) (in + 8*j));
+		for(k = 8; k-- > 0;) {
+			mask = _mm256_movemask_epi8(x);
+			memcpy(out + k*rowBytes + j, &mask, sizeof(uint32_t));
+			x = _mm256_add_epi8(x, x);
+		}
+	}
+	transposeBitsFrom(in, bytes, out, j);
+}
+
+/*
+ * Purpose:
+ *		untransposeBitsFrom with SSE2. 16 bytes of each of the 8 rows are interleaved with unpacks so each vector holds the 8 row bytes
+ *		of two groups, then pmovmskb gathers bit i of those rows, which is output byte i of each group.
+ */
+__attribute__((target("sse2")))
+static void untransposeBitsSSE2(const unsigned char *in, size_t bytes, unsigned char *out) {
+	size_t j, rowBytes = bytes / 8;
+	__m128i rows[8], pairs[8], quads[8], groups[8], x;
+	unsigned int k, g, i, mask;
+
+	for(j = 0; j + 16 <= rowBytes; j += 16) {
+		for(k = 0; k < 8; k++) {
+			rows[k] = _mm_loadu_si128((const __m128i *) (in + k*rowBytes + j));
+		}
+		for(k = 0; k < 4; k++) { //rows 2k and 2k+1 side by side, groups 0-7 then 8-15
+			pairs[2*k] = _mm_unpacklo_epi8(rows[2*k], rows[2*k + 1]);
+			pairs[2*k + 1] = _mm_unpackhi_epi8(rows[2*k], rows[2*k + 1]);
+		}
+		for(k = 0; k < 2; k++) { //rows 4k to 4k+3, four groups per vector
+			quads[4*k] = _mm_unpacklo_epi16(pairs[4*k], pairs[4*k + 2]);
+			quads[4*k + 1] = _mm_unpackhi_epi16(pairs[4*k], pairs[4*k + 2]);
+			quads[4*k + 2] = _mm_unpacklo_epi16(pairs[4*k + 1], pairs[4*k + 3]);
+			quads[4*k + 3] = _mm_unpackhi_epi16(pairs[4*k + 1], pairs[4*k + 3]);
+		}
+		for(g = 0; g < 4; g++) { //all 8 rows, groups 4g to 4g+3 over two vectors
+			groups[2*g] = _mm_unpacklo_epi32(quads[g], quads[4 + g]);
+			groups[2*g + 1] = _mm_unpackhi_epi32(quads[g], quads[4 + g]);
+		}
+		for(g = 0; g < 8; g++) {
+			x = groups[g];
+			for(i = 8; i-- > 0;) {
+				mask = _mm_movemask_epi8(x);
+				out[8*(j + 2*g) + i] = mask;
+				out[8*(j + 2*g + 1) + i] = mask >> 8;
+				x = _mm_add_epi8(x, x);
+			}
+		}
+	}
+	untransposeBitsFrom(in, bytes, out, j);
+}
+#endif
+
+/*
+ * Purpose:
+ *		Split count records of width bytes into width planes, plane b holds byte b of every record. Bytes in the same position of
+ *		neighbouring records (e.g. the sign and magnitude byte of 24 bit records) are much more alike than the bytes of one record, so the
+ *		planes suit an entropy coder or generic compressor better than the records.
+ * Parameters:
+ *		1. in - count records of width bytes
+ *		2. count - Number of records
+ *		3. width - Bytes per record
+ *		4. out - count*width bytes for the planes
+ */
+void shuffleBytes(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	kernels->shuffleBytes(in, count, width, out);
+}
+
+/*
+ * Purpose:
+ *		Undo shuffleBytes
+ */
+void unshuffleBytes(const unsigned char *in, size_t count, unsigned int width, unsigned char *out) {
+	kernels->unshuffleBytes(in, count, width, out);
+}
+
+/*
+ * Purpose:
+ *		Split count records of width bytes into 8*width bit planes, as the bitshuffle filter does. Plane 8b + k holds bit k of byte b of every
+ *		record, 8 records to a byte, so bits that rarely change (signs, the top of the magnitude, exponents) become long runs of the same
+ *		byte. The last count % 8 records dont fill a byte of each plane and are copied after the planes as they are.
+ * Parameters:
+ *		1. in - count records of width bytes
+ *		2. count - Number of records
+ *		3. width - Bytes per record
+ *		4. out - count*width bytes for the planes
+ *		5. scratch - count*width bytes of working space, not out. It can be in when in isnt needed afterwards, so a caller shuffling
+ *		   block after block doesnt allocate per block
+ */
+void shuffleBits(unsigned char *in, size_t count, unsigned int width, unsigned char *out, unsigned char *scratch) {
+	size_t planeBytes = count & ~(size_t) 7;
+	unsigned int b;
+
+	kernels->shuffleBytes(in, planeBytes, width, out);
+	for(b = 0; b < width; b++) {
+		kernels->transposeBits(out + b*planeBytes, planeBytes, scratch + b*planeBytes);
+	}
+	memcpy(out, scratch, planeBytes*width);
+	memcpy(out + planeBytes*width, in + planeBytes*width, (count - planeBytes) * width); //the tail of in is never used as scratch
+}
+
+/*
+ * Purpose:
+ *		Undo shuffleBits, scratch is as for shuffleBits
+ */
+void unshuffleBits(unsigned char *in, size_t count, unsigned int width, unsigned char *out, unsigned char *scratch) {
+	size_t planeBytes = count & ~(size_t) 7;
+	unsigned int b;
+
+	for(b = 0; b < width; b++) {
+		kernels->untransposeBits(in + b*planeBytes, planeBytes, out + b*planeBytes);
+	}
+	kernels->unshuffleBytes(out, planeBytes, width, scratch);
+	memcpy(out, scratch, planeBytes*width);
+	memcpy(out + planeBytes*width, in + planeBytes*width, (count - planeBytes) * width);
+}
+
+#define RANS_PROB_BITS 12 //symbol frequencies are scaled to sum to 2^RANS_PROB_BITS, so the decode table is 4KB of slots
+#define RANS_PROB_SCALE (1U << RANS_PROB_BITS)
+#define RANS_LOWER_BOUND (1U << 23) //states stay in [2^23, 2^31) and are renormalised a byte at a time
+#define RANS_STREAMS 4 //interleaved states, byte i is coded by state i % RANS_STREAMS so consecutive decodes dont wait on each other
+
+struct ransSlot { //what a decode table slot gives: the symbol and how to step the state past it
+	uint16_t freq;
+	uint16_t offset; //slot - start of the symbol's range
+	uint8_t symbol;
+};
+
+/*
+ * Purpose:
+ *		Scale the byte counts of a block to frequencies summing to RANS_PROB_SCALE, every byte that occurs keeps a frequency of at least 1
+ */
+static void normaliseFrequencies(const uint32_t *counts, unsigned int total, uint32_t *freqs) {
+	uint32_t sum = 0;
+	unsigned int s, largest = 0;
+
+	for(s = 0; s < 256; s++) {
+		freqs[s] = counts[s] ? (uint32_t) (((uint64_t) counts[s] * RANS_PROB_SCALE) / total) : 0;
+		if(counts[s] && freqs[s] == 0) {
+			freqs[s] = 1;
+		}
+		sum += freqs[s];
+		largest = freqs[s] > freqs[largest] ? s : largest;
+	}
+	while(sum > RANS_PROB_SCALE) { //rare bytes rounded up to 1, take the excess from the most common ones
+		for(s = 0, largest = 0; s < 256; s++) {
+			largest = freqs[s] > freqs[largest] ? s : largest;
+		}
+		freqs[largest]--;
+		sum--;
+	}
+	freqs[largest] += RANS_PROB_SCALE - sum;
+}
+
+/*
+ * Purpose:
+ *		Entropy code one block: a mode byte and the block length, then either the raw bytes (mode 0, when coding wouldnt make it smaller)
+ *		or (mode 1) a 256 bit map of the bytes present, their frequencies and the length and bytes of the rANS stream
+ * Returns:
+ *		Bytes written to out, at most length + ENTROPY_BLOCK_OVERHEAD
+ * Parameters:
+ *		1. in - The block
+ *		2. length - Bytes in the block, 1 to ENTROPY_BLOCK
+ *		3. out - Where the coded block goes
+ *		4. scratch - 2*ENTROPY_BLOCK + 64 bytes for the rANS stream, which is written backwards
+ */
+static size_t encodeEntropyBlock(const unsigned char *in, unsigned int length, unsigned char *out, unsigned char *scratch) {
+	uint32_t counts[256] = {0}, freqs[256], starts[256], states[RANS_STREAMS], x, xMax;
+	unsigned char *end = scratch + 2*ENTROPY_BLOCK + 64, *ptr = end;
+	size_t o;
+	unsigned int i, s, r, start = 0;
+	uint16_t freq;
+
+	for(i = 0; i < length; i++) {
+		counts[in[i]]++;
+	}
+	normaliseFrequencies(counts, length, freqs);
+	for(s = 0; s < 256; s++) {
+		starts[s] = start;
+		start += freqs[s];
+	}
+	for(r = 0; r < RANS_STREAMS; r++) {
+		states[r] = RANS_LOWER_BOUND;
+	}
+	for(i = length; i-- > 0;) { //backwards, so the decoder reads forwards
+		s = in[i];
+		x = states[i % RANS_STREAMS];
+		xMax = ((RANS_LOWER_BOUND >> RANS_PROB_BITS) << 8) * freqs[s];
+		while(x >= xMax) {
+			*--ptr = x & 0xFF;
+			x >>= 8;
+		}
+		states[i % RANS_STREAMS] = ((x / freqs[s]) << RANS_PROB_BITS) + (x % freqs[s]) + starts[s];
+	}
+	for(r = RANS_STREAMS; r-- > 0;) { //state 0 is read first
+		ptr -= 4;
+		memcpy(ptr, &states[r], sizeof(uint32_t));
+	}
+
+	out[0] = 1;
+	o = 1 + writeVarint(out + 1, length);
+	memset(out + o, 0, 32);
+	for(s = 0; s < 256; s++) {
+		if(freqs[s]) {
+			out[o + s/8] |= 1 << (s % 8);
+		}
+	}
+	o += 32;
+	for(s = 0; s < 256; s++) {
+		if(freqs[s]) {
+			freq = freqs[s];
+			memcpy(out + o, &freq, sizeof(uint16_t));
+			o += 2;
+		}
+	}
+	if(o + 3 + (end - ptr) >= 1 + 3 + (size_t) length) { //coding wouldnt save anything, store the block as it is
+		out[0] = 0;
+		o = 1 + writeVarint(out + 1, length);
+		memcpy(out + o, in, length);
+		return o + length;
+	}
+	o += writeVarint(out + o, end - ptr);
+	memcpy(out + o, ptr, end - ptr);
+	return o + (end - ptr);
+}
+
+/*
+ * Purpose:
+ *		Take the next symbol off a rANS state and renormalise it
+ */
+static inline unsigned char decodeRansSymbol(uint32_t *x, const struct ransSlot *table, const unsigned char **ptr, const unsigned char *end) {
+	const struct ransSlot *slot = &table[*x & (RANS_PROB_SCALE - 1)];
+
+	*x = slot->freq * (*x >> RANS_PROB_BITS) + slot->offset;
+	while(*x < RANS_LOWER_BOUND && *ptr < end) {
+		*x = (*x << 8) | *(*ptr)++;
+	}
+	return slot->symbol;
+}
+
+/*
+ * Purpose:
+ *		Decode one block written by encodeEntropyBlock
+ * Returns:
+ *		Bytes of in used, 0 if the block is damaged or its output wouldnt fit in outEnd
+ */
+static size_t decodeEntropyBlock(const unsigned char *in, const unsigned char *inEnd, unsigned char *out, const unsigned char *outEnd, unsigned int *length) {
+	struct ransSlot table[RANS_PROB_SCALE];
+	uint32_t states[RANS_STREAMS], x0, x1, x2, x3, start = 0;
+	const unsigned char *ptr = in + 1, *end;
+	unsigned int i, s, slot, read;
+	uint64_t value;
+	uint16_t freq;
+
+	if(in >= inEnd || (read = readBoundedVarint(ptr, inEnd, &value)) == 0 || value == 0 || value > ENTROPY_BLOCK || value > (uint64_t) (outEnd - out)) {
+		return 0;
+	}
+	*length = value;
+	ptr += read;
+	if(in[0] == 0) {
+		if((uint64_t) (inEnd - ptr) < *length) {
+			return 0;
+		}
+		memcpy(out, ptr, *length);
+		return ptr + *length - in;
+	}
+	if(in[0] != 1 || inEnd - ptr < 32) {
+		return 0;
+	}
+	end = ptr + 32;
+	for(s = 0; s < 256; s++) {
+		if(ptr[s/8] & (1 << (s % 8))) {
+			if(inEnd - end < 2) {
+				return 0;
+			}
+			memcpy(&freq, end, sizeof(uint16_t));
+			end += 2;
+			if(freq == 0 || start + freq > RANS_PROB_SCALE) {
+				return 0;
+			}
+			for(slot = start; slot < start + freq; slot++) {
+				table[slot].freq = freq;
+				table[slot].offset = slot - start;
+				table[slot].symbol = s;
+			}
+			start += freq;
+		}
+	}
+	if(start != RANS_PROB_SCALE || (read = readBoundedVarint(end, inEnd, &value)) == 0 || value > (uint64_t) (inEnd - end - read)
+		|| value < 4 * RANS_STREAMS) {
+		return 0;
+	}
+	ptr = end + read;
+	end = ptr + value;
+	for(i = 0; i < RANS_STREAMS; i++) {
+		memcpy(&states[i], ptr, sizeof(uint32_t));
+		ptr += 4;
+	}
+	x0 = states[0];
+	x1 = states[1];
+	x2 = states[2];
+	x3 = states[3];
+	for(i = 0; i + 4 <= *length; i += 4) {
+		out[i] = decodeRansSymbol(&x0, table, &ptr, end);
+		out[i + 1] = decodeRansSymbol(&x1, table, &ptr, end);
+		out[i + 2] = decodeRansSymbol(&x2, table, &ptr, end);
+		out[i + 3] = decodeRansSymbol(&x3, table, &ptr, end);
+	}
+	if(i < *length) {
+		out[i++] = decodeRansSymbol(&x0, table, &ptr, end);
+	}
+	if(i < *length) {
+		out[i++] = decodeRansSymbol(&x1, table, &ptr, end);
+	}
+	if(i < *length) {
+		out[i++] = decodeRansSymbol(&x2, table, &ptr, end);
+	}
+	return end - in;
+}
+
+/*
+ * Purpose:
+ *		Losslessly entropy code an array of bytes (e.g. from getVariableBitCompressedData, or shuffleBytes on 24 bit records) with an order 0
+ *		rANS coder. The bytes are coded in blocks of ENTROPY_BLOCK, each with its own frequency table, and blocks coding wouldnt shrink are
+ *		stored as they are.
+ * Returns:
+ *		The coded bytes, a varint of the input size followed by the blocks
+ * Parameters:
+ *		1. data - Bytes to code
+ *		2. bytes - Number of bytes in data
+ *		3. newBytes - Gets the number of coded bytes, at most getEntropyCompressedSize(bytes)
+ */
+unsigned char *getEntropyCompressedData(const unsigned char *data, size_t bytes, size_t *newBytes) {
+	unsigned char *compressed = malloc(getEntropyCompressedSize(bytes));
+	unsigned char *scratch = malloc(2*ENTROPY_BLOCK + 64);
+	size_t offset = 0, o;
+	unsigned int length;
+
+	o = writeVarint(compressed, bytes);
+	for(; offset < bytes; offset += length) {
+		length = bytes - offset < ENTROPY_BLOCK ? bytes - offset : ENTROPY_BLOCK;
+		o += encodeEntropyBlock(data + offset, length, compressed + o, scratch);
+	}
+	free(scratch);
+	*newBytes = o;
+	return realloc(compressed, o);
+}
+
+/*
+ * Purpose:
+ *		Most bytes getEntropyCompressedData can give for an input of bytes
+ */
+size_t getEntropyCompressedSize(size_t bytes) {
+	return bytes + (bytes / ENTROPY_BLOCK + 1) * ENTROPY_BLOCK_OVERHEAD + 10;
+}
+
+/*
+ * Purpose:
+ *		Decode bytes coded by getEntropyCompressedData
+ * Returns:
+ *		The original bytes, or NULL if the coded data is damaged
+ * Parameters:
+ *		1. compressed - The coded bytes
+ *		2. bytes - Number of coded bytes
+ *		3. newBytes - Gets the number of decoded bytes
+ */
+unsigned char *getEntropyDecompressedData(const unsigned char *compressed, size_t bytes, size_t *newBytes) {
+	const unsigned char *in, *end = compressed + bytes;
+	unsigned char *data;
+	unsigned int read, length;
+	size_t offset = 0, used;
+	uint64_t total;
+
+	if((read = readBoundedVarint(compressed, end, &total)) == 0 || total / ENTROPY_BLOCK > bytes) { //every block takes at least 2 bytes
+		return NULL;
+	}
+	data = malloc(total > 0 ? total : 1);
+	for(in = compressed + read; offset < total; in += used, offset += length) {
+		used = decodeEntropyBlock(in, end, data + offset, data + total, &length);
+		if(used == 0) {
+			free(data);
+			return NULL;
+		}
+	}
+	*newBytes = total;
+	return data;
+}
+
+/*
+ * Purpose:
+ *		Adapters from the codec interface to the compression functions above, the codec's parameters fill in the format arguments
+ */
+static unsigned char *compressRunlengthCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned int newCount;
+	unsigned char *compressed = getRunlengthCompressedData(values, count, &newCount);
+
+	*bytes = newCount;
+	return compressed;
+}
+
+static float *decompressRunlengthCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	unsigned int newCount;
+	float *values = getRunlengthDecompressedData(compressed, bytes, &newCount);
+
+	if(values != NULL && newCount != count) { //the block holds a different number of values than the caller expects
+		free(values);
+		return NULL;
+	}
+	return values;
+}
+
+static size_t runlengthCodecSize(const struct codec *codec, unsigned int count) {
+	return (size_t) count*sizeof(float) + RUNLENGTH_MAX_OVERHEAD;
+}
+
+static unsigned char *compressXorCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned int newCount;
+	unsigned char *compressed = getXorPredictiveCompressedData(values, count, &newCount, codec->parameter);
+
+	*bytes = newCount;
+	return compressed;
+}
+
+static float *decompressXorCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	unsigned int newCount;
+	float *values = getXorPredictiveDecompressedData(compressed, bytes, &newCount);
+
+	if(values != NULL && newCount != count) { //the block holds a different number of values than the caller expects
+		free(values);
+		return NULL;
+	}
+	return values;
+}
+
+static size_t xorCodecSize(const struct codec *codec, unsigned int count) {
+	return ((size_t) count*44 + 7)/8 + 2*RUNLENGTH_MAX_OVERHEAD;
+}
+
+static unsigned char *compress24BitCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	*bytes = ((size_t) count + 1) * sizeof(struct compressedVal);
+	return (unsigned char *) get24BitCompressedData(values, count, codec->magBits, codec->precBits);
+}
+
+static size_t codec24BitSize(const struct codec *codec, unsigned int count) {
+	return ((size_t) count + 1) * sizeof(struct compressedVal);
+}
+
+static float *decompress24BitCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	if(bytes < codec24BitSize(codec, count)) { //the block is too small to hold count records
+		return NULL;
+	}
+	return get24BitDecompressedData((struct compressedVal *) compressed, count, codec->magBits, codec->precBits);
+}
+
+static float get24BitCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	return getSingle24BitValue((struct compressedVal *) compressed, index, codec->magBits, codec->precBits);
+}
+
+static void set24BitCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	insertSingle24BitValue((struct compressedVal *) compressed, value, index, codec->magBits, codec->precBits);
+}
+
+static void get24BitCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	struct layout24Bit layout = get24BitLayout(codec->magBits, codec->precBits);
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		values[i] = decode24BitRecord(load24BitRecord((struct compressedVal *) compressed + start + i), &layout);
+	}
+}
+
+static unsigned char *compressAlignedCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	*bytes = (size_t) count * codec->parameter;
+	switch(codec->parameter) {
+		case 1:
+			return getAligned8BitCompressedData(values, count, codec->magBits, codec->precBits);
+		case 2:
+			return getAligned16BitCompressedData(values, count, codec->magBits, codec->precBits);
+		case 3:
+			return getAligned24BitCompressedData(values, count, codec->magBits, codec->precBits);
+		default:
+			return getAligned32BitCompressedData(values, count, codec->magBits, codec->precBits);
+	}
+}
+
+static float *decompressAlignedCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	if(bytes < (size_t) count * codec->parameter) {
+		return NULL;
+	}
+	switch(codec->parameter) {
+		case 1:
+			return getAligned8BitDecompressedData(compressed, count, codec->magBits, codec->precBits);
+		case 2:
+			return getAligned16BitDecompressedData(compressed, count, codec->magBits, codec->precBits);
+		case 3:
+			return getAligned24BitDecompressedData(compressed, count, codec->magBits, codec->precBits);
+		default:
+			return getAligned32BitDecompressedData(compressed, count, codec->magBits, codec->precBits);
+	}
+}
+
+static size_t alignedCodecSize(const struct codec *codec, unsigned int count) {
+	return (size_t) count * codec->parameter + sizeof(uint32_t) - 1;
+}
+
+static float getAlignedCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	struct alignedLayout layout = getAlignedLayout(codec->parameter, codec->magBits, codec->precBits);
+
+	return decodeAlignedRecord(loadAlignedRecord(compressed, index, codec->parameter, &layout), &layout);
+}
+
+static void setAlignedCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	struct alignedLayout layout = getAlignedLayout(codec->parameter, codec->magBits, codec->precBits);
+
+	storeAlignedRecord(compressed, index, codec->parameter, encodeAlignedRecord(value, &layout));
+}
+
+static void getAlignedCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	struct alignedLayout layout = getAlignedLayout(codec->parameter, codec->magBits, codec->precBits);
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		values[i] = decodeAlignedRecord(loadAlignedRecord(compressed, start + i, codec->parameter, &layout), &layout);
+	}
+}
+
+static void setAlignedCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values) {
+	struct alignedLayout layout = getAlignedLayout(codec->parameter, codec->magBits, codec->precBits);
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		storeAlignedRecord(compressed, start + i, codec->parameter, encodeAlignedRecord(values[i], &layout));
+	}
+}
+
+static unsigned char *compressVariableBitCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned int newCount;
+	unsigned char *compressed = getVariableBitCompressedData(values, count, &newCount, codec->magBits, codec->precBits);
+
+	*bytes = newCount;
+	return compressed;
+}
+
+static size_t variableBitCodecSize(const struct codec *codec, unsigned int count) {
+	return ((size_t) count * (1 + codec->magBits + codec->precBits) + 7) / 8;
+}
+
+static float *decompressVariableBitCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	float *values;
+	struct variableBitStream stream;
+
+	if(bytes < variableBitCodecSize(codec, count)) {
+		return NULL;
+	}
+	values = malloc((size_t) count * sizeof(float));
+	startVariableBitStream(&stream, compressed, bytes, codec->magBits, codec->precBits);
+	readVariableBitValues(&stream, values, count);
+	return values;
+}
+
+static float getVariableBitCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	return getSingleVariableBitValue(compressed, bytes, index, codec->magBits, codec->precBits);
+}
+
+static void setVariableBitCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	insertSingleVariableBitValue(compressed, bytes, index, value, codec->magBits, codec->precBits);
+}
+
+static void getVariableBitCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	struct variableBitStream stream;
+
+	startVariableBitStream(&stream, compressed, bytes, codec->magBits, codec->precBits);
+	seekVariableBitStream(&stream, start, 0);
+	readVariableBitValues(&stream, values, count);
+}
+
+static void setVariableBitCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values) {
+	struct variableBitStream stream;
+
+	startVariableBitStream(&stream, compressed, bytes, codec->magBits, codec->precBits);
+	seekVariableBitStream(&stream, start, 1);
+	writeVariableBitValues(&stream, values, count);
+	flushVariableBitStreamRange(&stream);
+}
+
+static unsigned char *compressTruncatedFloatCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned int newCount;
+	unsigned char *compressed = getTruncatedFloatCompressedData(values, count, &newCount, codec->magBits, codec->precBits, codec->parameter);
+
+	*bytes = newCount;
+	return compressed;
+}
+
+static float *decompressTruncatedFloatCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	if(bytes < variableBitCodecSize(codec, count)) {
+		return NULL;
+	}
+	return getTruncatedFloatDecompressedData(compressed, bytes, count, codec->magBits, codec->precBits, codec->parameter);
+}
+
+static float getTruncatedFloatCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	return getSingleTruncatedFloatValue(compressed, bytes, index, codec->magBits, codec->precBits, codec->parameter);
+}
+
+static void setTruncatedFloatCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	insertSingleTruncatedFloatValue(compressed, bytes, index, value, codec->magBits, codec->precBits, codec->parameter);
+}
+
+static void getTruncatedFloatCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	struct truncatedFloatLayout layout = getTruncatedFloatLayout(codec->magBits, codec->precBits, codec->parameter);
+	struct variableBitStream stream;
+
+	startVariableBitStream(&stream, compressed, bytes, codec->magBits, codec->precBits);
+	seekVariableBitStream(&stream, start, 0);
+	readTruncatedFloats(&stream, values, count, &layout);
+}
+
+static void setTruncatedFloatCodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values) {
+	struct truncatedFloatLayout layout = getTruncatedFloatLayout(codec->magBits, codec->precBits, codec->parameter);
+	struct variableBitStream stream;
+
+	startVariableBitStream(&stream, compressed, bytes, codec->magBits, codec->precBits);
+	seekVariableBitStream(&stream, start, 1);
+	writeTruncatedFloats(&stream, values, count, &layout);
+	flushVariableBitStreamRange(&stream);
+}
+
+static unsigned char *compressFloat16Codec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	*bytes = (size_t) count * 2;
+	return getFloat16CompressedData(values, count);
+}
+
+static float *decompressFloat16Codec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	if(bytes < (size_t) count * 2) {
+		return NULL;
+	}
+	return getFloat16DecompressedData(compressed, count);
+}
+
+static size_t float16CodecSize(const struct codec *codec, unsigned int count) {
+	return (size_t) count * 2;
+}
+
+static float getFloat16CodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	return getSingleFloat16Value(compressed, index);
+}
+
+static void setFloat16CodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	insertSingleFloat16Value(compressed, value, index);
+}
+
+static void getFloat16CodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	kernels->decodeFloat16(compressed + (size_t) start*2, count, values);
+}
+
+static void setFloat16CodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values) {
+	kernels->encodeFloat16(values, count, compressed + (size_t) start*2);
+}
+
+static unsigned char *compressBFloat16Codec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	*bytes = (size_t) count * 2;
+	return getBFloat16CompressedData(values, count);
+}
+
+static float *decompressBFloat16Codec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	if(bytes < (size_t) count * 2) {
+		return NULL;
+	}
+	return getBFloat16DecompressedData(compressed, count);
+}
+
+static float getBFloat16CodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	return getSingleBFloat16Value(compressed, index);
+}
+
+static void setBFloat16CodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	insertSingleBFloat16Value(compressed, value, index);
+}
+
+static void getBFloat16CodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	uint16_t record;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) { //integer only conversion, vectorises without special instructions
+		memcpy(&record, compressed + ((size_t) start + i)*2, sizeof(uint16_t));
+		values[i] = bfloat16ToFloat(record);
+	}
+}
+
+static void setBFloat16CodecBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values) {
+	uint16_t record;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		record = floatToBFloat16(values[i]);
+		memcpy(compressed + ((size_t) start + i)*2, &record, sizeof(uint16_t));
+	}
+}
+
+static unsigned char *compressCodebookCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned char *compressed = getCodebookCompressedData(values, count, codec->parameter);
+
+	*bytes = compressed ? CODEBOOK_BYTES(count, codec->parameter) : 0;
+	return compressed;
+}
+
+static float *decompressCodebookCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	if((codec->parameter != 8 && codec->parameter != 16) || bytes < CODEBOOK_BYTES(count, codec->parameter)) {
+		return NULL;
+	}
+	return getCodebookDecompressedData(compressed, count, codec->parameter);
+}
+
+static size_t codebookCodecSize(const struct codec *codec, unsigned int count) {
+	return CODEBOOK_BYTES(count, codec->parameter);
+}
+
+static float getCodebookCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index) {
+	return getSingleCodebookValue(compressed, index, codec->parameter);
+}
+
+static void setCodebookCodecValue(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value) {
+	insertSingleCodebookValue(compressed, value, index, codec->parameter);
+}
+
+enum shuffleType { //what the entropy coded codecs do to their records before coding them, held in the codec parameter
+	SHUFFLE_NONE,
+	SHUFFLE_BYTES,
+	SHUFFLE_BITS
+};
+
+//scratch is only used for SHUFFLE_BITS, see shuffleBits
+static void shuffleCodecRecords(const struct codec *codec, unsigned char *in, size_t count, unsigned int width, unsigned char *out, unsigned char *scratch) {
+	if(codec->parameter == SHUFFLE_BITS) {
+		shuffleBits(in, count, width, out, scratch);
+	} else {
+		shuffleBytes(in, count, width, out);
+	}
+}
+
+static void unshuffleCodecRecords(const struct codec *codec, unsigned char *in, size_t count, unsigned int width, unsigned char *out, unsigned char *scratch) {
+	if(codec->parameter == SHUFFLE_BITS) {
+		unshuffleBits(in, count, width, out, scratch);
+	} else {
+		unshuffleBytes(in, count, width, out);
+	}
+}
+
+//with SHUFFLE_BITS the records are pulled out of the stream into 32 bit ints first, bit planes of packed bytes would mix up the fields
+static unsigned char *compressVariableBitEntropyCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	size_t packedBytes;
+	unsigned char *packed = compressVariableBitCodec(codec, values, count, &packedBytes);
+	unsigned char *compressed, *planes;
+	struct variableBitStream stream;
+	uint32_t *records;
+
+	if(codec->parameter == SHUFFLE_BITS) {
+		records = malloc((size_t) count * sizeof(uint32_t) + 1);
+		planes = malloc((size_t) count * sizeof(uint32_t) + 1);
+		startVariableBitStream(&stream, packed, packedBytes, codec->magBits, codec->precBits);
+		readVariableBitRecords(&stream, records, count);
+		shuffleBits((unsigned char *) records, count, sizeof(uint32_t), planes, (unsigned char *) records);
+		compressed = getEntropyCompressedData(planes, (size_t) count * sizeof(uint32_t), bytes);
+		free(records);
+		free(planes);
+	} else {
+		compressed = getEntropyCompressedData(packed, packedBytes, bytes);
+	}
+	free(packed);
+	return compressed;
+}
+
+static float *decompressVariableBitEntropyCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	size_t packedBytes = variableBitCodecSize(codec, count), decodedBytes;
+	unsigned char *decoded = getEntropyDecompressedData(compressed, bytes, &decodedBytes), *packed = decoded;
+	struct variableBitStream stream;
+	uint32_t *records;
+	float *values;
+
+	if(decoded == NULL || decodedBytes != (codec->parameter == SHUFFLE_BITS ? (size_t) count * sizeof(uint32_t) : packedBytes)) {
+		free(decoded);
+		return NULL;
+	}
+	if(codec->parameter == SHUFFLE_BITS) {
+		records = malloc((size_t) count * sizeof(uint32_t) + 1);
+		unshuffleBits(decoded, count, sizeof(uint32_t), (unsigned char *) records, decoded);
+		packed = malloc(packedBytes + 1);
+		startVariableBitStream(&stream, packed, packedBytes, codec->magBits, codec->precBits);
+		writeVariableBitRecords(&stream, records, count);
+		flushVariableBitStream(&stream);
+		free(records);
+		free(decoded);
+	}
+	values = decompressVariableBitCodec(codec, packed, packedBytes, count);
+	free(packed);
+	return values;
+}
+
+static size_t variableBitEntropyCodecSize(const struct codec *codec, unsigned int count) {
+	return getEntropyCompressedSize(codec->parameter == SHUFFLE_BITS ? (size_t) count * sizeof(uint32_t) : variableBitCodecSize(codec, count));
+}
+
+static unsigned char *compress24BitEntropyCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	struct compressedVal *records = get24BitCompressedData(values, count, codec->magBits, codec->precBits);
+	unsigned char *planes = malloc((size_t) count * sizeof(struct compressedVal) + 1);
+	unsigned char *compressed;
+
+	shuffleCodecRecords(codec, (unsigned char *) records, count, sizeof(struct compressedVal), planes, (unsigned char *) records);
+	compressed = getEntropyCompressedData(planes, (size_t) count * sizeof(struct compressedVal), bytes);
+	free(records);
+	free(planes);
+	return compressed;
+}
+
+static float *decompress24BitEntropyCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	size_t planeBytes;
+	unsigned char *planes = getEntropyDecompressedData(compressed, bytes, &planeBytes);
+	struct compressedVal *records;
+	float *values;
+
+	if(planes == NULL || planeBytes != (size_t) count * sizeof(struct compressedVal)) {
+		free(planes);
+		return NULL;
+	}
+	records = calloc((size_t) count + 1, sizeof(struct compressedVal)); //with the padding record get24BitDecompressedData expects
+	unshuffleCodecRecords(codec, planes, count, sizeof(struct compressedVal), (unsigned char *) records, planes);
+	values = get24BitDecompressedData(records, count, codec->magBits, codec->precBits);
+	free(planes);
+	free(records);
+	return values;
+}
+
+static size_t codec24BitEntropySize(const struct codec *codec, unsigned int count) {
+	return getEntropyCompressedSize((size_t) count * sizeof(struct compressedVal));
+}
+
+static unsigned char *compressFloatEntropyCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned char *planes = malloc((size_t) count * sizeof(float) * (codec->parameter == SHUFFLE_BITS ? 2 : 1) + 1); //the values arent ours to use as scratch
+	unsigned char *compressed;
+
+	shuffleCodecRecords(codec, (unsigned char *) values, count, sizeof(float), planes, planes + (size_t) count * sizeof(float));
+	compressed = getEntropyCompressedData(planes, (size_t) count * sizeof(float), bytes);
+	free(planes);
+	return compressed;
+}
+
+static float *decompressFloatEntropyCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	size_t planeBytes;
+	unsigned char *planes = getEntropyDecompressedData(compressed, bytes, &planeBytes);
+	float *values;
+
+	if(planes == NULL || planeBytes != (size_t) count * sizeof(float)) {
+		free(planes);
+		return NULL;
+	}
+	values = malloc((size_t) count * sizeof(float) + 1);
+	unshuffleCodecRecords(codec, planes, count, sizeof(float), (unsigned char *) values, planes);
+	free(planes);
+	return values;
+}
+
+static size_t floatEntropyCodecSize(const struct codec *codec, unsigned int count) {
+	return getEntropyCompressedSize((size_t) count * sizeof(float));
+}
+
+#define VARIABLE_BIT_CODEC(codecName, mag, prec) {.name = codecName, .magBits = mag, .precBits = prec, .compress = compressVariableBitCodec, \
+	.decompress = decompressVariableBitCodec, .compressedSize = variableBitCodecSize, .get = getVariableBitCodecValue, .set = setVariableBitCodecValue, \
+	.getBatch = getVariableBitCodecBatch, .setBatch = setVariableBitCodecBatch}
+#define ALIGNED_CODEC(codecName, recordBytes, mag, prec) {.name = codecName, .magBits = mag, .precBits = prec, .parameter = recordBytes, \
+	.compress = compressAlignedCodec, .decompress = decompressAlignedCodec, .compressedSize = alignedCodecSize, .get = getAlignedCodecValue, \
+	.set = setAlignedCodecValue, .getBatch = getAlignedCodecBatch, .setBatch = setAlignedCodecBatch}
+#define TRUNCATED_FLOAT_CODEC(codecName, exp, mant) {.name = codecName, .magBits = exp, .precBits = mant, .parameter = TRUNCATED_FLOAT_BIAS(exp), \
+	.compress = compressTruncatedFloatCodec, .decompress = decompressTruncatedFloatCodec, .compressedSize = variableBitCodecSize, \
+	.get = getTruncatedFloatCodecValue, .set = setTruncatedFloatCodecValue, .getBatch = getTruncatedFloatCodecBatch, .setBatch = setTruncatedFloatCodecBatch}
+
+static const struct codec builtinCodecs[] = { //the formats and parameters the benchmarks use
+	{.name = "Runlength", .lossless = 1, .compress = compressRunlengthCodec, .decompress = decompressRunlengthCodec, .compressedSize = runlengthCodecSize},
+	{.name = "XOR Predictive (previous value)", .lossless = 1, .parameter = 1, .compress = compressXorCodec, .decompress = decompressXorCodec, .compressedSize = xorCodecSize},
+	{.name = "24 Bit Lossy", .magBits = 5, .precBits = 18, .compress = compress24BitCodec, .decompress = decompress24BitCodec, .compressedSize = codec24BitSize,
+		.get = get24BitCodecValue, .set = set24BitCodecValue, .getBatch = get24BitCodecBatch},
+	VARIABLE_BIT_CODEC("21 Bit Lossy", 5, 15),
+	VARIABLE_BIT_CODEC("18 Bit Lossy", 5, 12),
+	VARIABLE_BIT_CODEC("15 Bit Lossy", 5, 9),
+	VARIABLE_BIT_CODEC("12 Bit Lossy", 5, 6),
+	ALIGNED_CODEC("16 Bit Aligned", 2, 5, 10),
+	ALIGNED_CODEC("8 Bit Aligned", 1, 3, 4), //4 precision bits so every decimal digit fits
+	TRUNCATED_FLOAT_CODEC("24 Bit Truncated Float", 8, 15),
+	TRUNCATED_FLOAT_CODEC("16 Bit Truncated Float", 5, 10),
+	TRUNCATED_FLOAT_CODEC("12 Bit Truncated Float", 5, 6),
+	{.name = "16 Bit Half Float", .magBits = 5, .precBits = 10, .compress = compressFloat16Codec, .decompress = decompressFloat16Codec,
+		.compressedSize = float16CodecSize, .get = getFloat16CodecValue, .set = setFloat16CodecValue, .getBatch = getFloat16CodecBatch,
+		.setBatch = setFloat16CodecBatch},
+	{.name = "16 Bit BFloat16", .magBits = 8, .precBits = 7, .compress = compressBFloat16Codec, .decompress = decompressBFloat16Codec,
+		.compressedSize = float16CodecSize, .get = getBFloat16CodecValue, .set = setBFloat16CodecValue, .getBatch = getBFloat16CodecBatch,
+		.setBatch = setBFloat16CodecBatch},
+	{.name = "8 Bit Codebook", .trained = 1, .parameter = 8, .compress = compressCodebookCodec, .decompress = decompressCodebookCodec,
+		.compressedSize = codebookCodecSize, .get = getCodebookCodecValue, .set = setCodebookCodecValue},
+	{.name = "16 Bit Codebook", .trained = 1, .parameter = 16, .compress = compressCodebookCodec, .decompress = decompressCodebookCodec,
+		.compressedSize = codebookCodecSize, .get = getCodebookCodecValue, .set = setCodebookCodecValue},
+	{.name = "24 Bit Lossy Shuffled + rANS", .magBits = 5, .precBits = 18, .parameter = SHUFFLE_BYTES, .compress = compress24BitEntropyCodec, .decompress = decompress24BitEntropyCodec,
+		.compressedSize = codec24BitEntropySize},
+	{.name = "21 Bit Lossy + rANS", .magBits = 5, .precBits = 15, .compress = compressVariableBitEntropyCodec, .decompress = decompressVariableBitEntropyCodec,
+		.compressedSize = variableBitEntropyCodecSize},
+	{.name = "12 Bit Lossy + rANS", .magBits = 5, .precBits = 6, .compress = compressVariableBitEntropyCodec, .decompress = decompressVariableBitEntropyCodec,
+		.compressedSize = variableBitEntropyCodecSize},
+	{.name = "24 Bit Lossy Bitshuffled + rANS", .magBits = 5, .precBits = 18, .parameter = SHUFFLE_BITS, .compress = compress24BitEntropyCodec,
+		.decompress = decompress24BitEntropyCodec, .compressedSize = codec24BitEntropySize},
+	{.name = "21 Bit Lossy Bitshuffled + rANS", .magBits = 5, .precBits = 15, .parameter = SHUFFLE_BITS, .compress = compressVariableBitEntropyCodec,
+		.decompress = decompressVariableBitEntropyCodec, .compressedSize = variableBitEntropyCodecSize},
+	{.name = "32 Bit Float Shuffled + rANS", .lossless = 1, .parameter = SHUFFLE_BYTES, .compress = compressFloatEntropyCodec,
+		.decompress = decompressFloatEntropyCodec, .compressedSize = floatEntropyCodecSize},
+	{.name = "32 Bit Float Bitshuffled + rANS", .lossless = 1, .parameter = SHUFFLE_BITS, .compress = compressFloatEntropyCodec,
+		.decompress = decompressFloatEntropyCodec, .compressedSize = floatEntropyCodecSize}
+};
+
+static const struct codec *registeredCodecs[MAX_CODECS];
+static unsigned int registeredCodecCount = 0;
+static int builtinCodecsRegistered = 0;
+
+/*
+ * Purpose:
+ *		Register the codecs in builtinCodecs the first time the registry is used
+ */
+static void registerBuiltinCodecs() {
+	unsigned int i;
+
+	if(builtinCodecsRegistered) {
+		return;
+	}
+	builtinCodecsRegistered = 1;
+	for(i = 0; i < sizeof(builtinCodecs)/sizeof(builtinCodecs[0]); i++) {
+		registerCodec(&builtinCodecs[i]);
+	}
+}
+
+/*
+ * Purpose:
+ *		Add a codec to the registry, after the built in codecs. The codec is kept by pointer so it must outlive its use.
+ * Returns:
+ *		1 if the codec was added, 0 if the registry is full or a codec with the same name is already registered
+ * Parameters:
+ *		1. codec - The codec to add, it needs at least name, compress and decompress
+ */
+int registerCodec(const struct codec *codec) {
+	registerBuiltinCodecs();
+	if(registeredCodecCount == MAX_CODECS || findCodec(codec->name) != NULL) {
+		return 0;
+	}
+	registeredCodecs[registeredCodecCount++] = codec;
+	return 1;
+}
+
+/*
+ * Purpose:
+ *		Get the number of registered codecs, built in ones included
+ */
+unsigned int getCodecCount() {
+	registerBuiltinCodecs();
+	return registeredCodecCount;
+}
+
+/*
+ * Purpose:
+ *		Get a registered codec by its position in the registry (0 to getCodecCount()-1)
+ * Returns:
+ *		The codec, or NULL if index is out of range
+ */
+const struct codec *getCodec(unsigned int index) {
+	registerBuiltinCodecs();
+	return index < registeredCodecCount ? registeredCodecs[index] : NULL;
+}
+
+/*
+ * Purpose:
+ *		Look up a registered codec by name
+ * Returns:
+ *		The codec, or NULL if no codec has that name
+ */
+const struct codec *findCodec(const char *name) {
+	unsigned int i;
+
+	registerBuiltinCodecs();
+	for(i = 0; i < registeredCodecCount; i++) {
+		if(strcmp(registeredCodecs[i]->name, name) == 0) {
+			return registeredCodecs[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Purpose:
+ *		Decompress count values starting at index start of a random access codec, through getBatch if the codec has one
+ * Parameters:
+ *		1. codec - A codec with get
+ *		2. compressed - Array returned by the codec's compress
+ *		3. bytes - Size of compressed in bytes
+ *		4. start - Index of the first value
+ *		5. count - Number of values
+ *		6. values - Array of at least count floats to decompress into
+ */
+void codecGetBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values) {
+	unsigned int i;
+
+	if(codec->getBatch) {
+		codec->getBatch(codec, compressed, bytes, start, count, values);
+		return;
+	}
+	for(i = 0; i < count; i++) {
+		values[i] = codec->get(codec, compressed, bytes, start + i);
+	}
+}
+
+/*
+ * Purpose:
+ *		Compress and store count values starting at index start of a random access codec, through setBatch if the codec has one
+ * Parameters:
+ *		1. codec - A codec with set
+ *		2. compressed - Array returned by the codec's compress
+ *		3. bytes - Size of compressed in bytes
+ *		4. start - Index of the first value
+ *		5. count - Number of values
+ *		6. values - Values to store
+ */
+void codecSetBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values) {
+	unsigned int i;
+
+	if(codec->setBatch) {
+		codec->setBatch(codec, compressed, bytes, start, count, values);
+		return;
+	}
+	for(i = 0; i < count; i++) {
+		codec->set(codec, compressed, bytes, start + i, values[i]);
+	}
+}
+
+/*
+ * Purpose:
+ *		Compress a 3D field with a codec. Fields from variable bit codecs are decoded and encoded inline by getFieldValue/setFieldValue,
+ *		other codecs go through their get and set.
+ * Returns:
+ *		The compressed field, free it with freeCompressedField
+ * Parameters:
+ *		1. codec - Codec to compress with, it needs get and set for the field accessors to work
+ *		2. values - layout->storageCount floats stored in layout order
+ *		3. nx - Size of the field in x
+ *		4. ny - Size of the field in y
+ *		5. nz - Size of the field in z
+ *		6. layout - Storage order of values, kept by pointer so it must outlive the field
+ */
+struct compressedField getCompressedField(const struct codec *codec, float *values, unsigned int nx, unsigned int ny, unsigned int nz, const struct fieldLayout *layout) {
+	struct compressedField field = {.codec = codec, .nx = nx, .ny = ny, .nz = nz, .layout = layout};
+
+	field.values = codec->compress(codec, values, layout->storageCount, &field.bytes);
+	if(codec->get == getVariableBitCodecValue) {
+		field.recordBits = 1 + codec->magBits + codec->precBits;
+		field.precBits = codec->precBits;
+		field.magMask = (1U << codec->magBits) - 1;
+		field.precMask = (1U << codec->precBits) - 1;
+		field.divider = 10 * getDecimalMultiplier(codec->precBits); //same scaling as startVariableBitStream
+		field.multiplier = numberOfDigits(codec->precBits) == 1 ? 10 : 10 * getDecimalMultiplier(codec->precBits);
+	}
+	return field;
+}
+
+/*
+ * Purpose:
+ *		Free the records of a compressed field
+ */
+void freeCompressedField(struct compressedField *field) {
+	free(field->values);
+	field->values = NULL;
+	field->bytes = 0;
+}
+
+/*
+ * Purpose:
+ *		Change the magnitude and precision widths of a copy of a lossy codec, checking they fit its format. Byte aligned codecs get the
+ *		smallest record size that holds the new widths.
+ * Returns:
+ *		1 if the widths were set, 0 if the codec has fixed widths (lossless codecs) or they dont fit (codec is left untouched)
+ * Parameters:
+ *		1. codec - Codec to change, a copy of a registered codec
+ *		2. magBits - Number of bits to represent magnitude
+ *		3. precBits - Number of bits to represent precision
+ */
+int setCodecWidths(struct codec *codec, unsigned int magBits, unsigned int precBits) {
+	unsigned int recordBits = 1 + magBits + precBits;
+
+	if(precBits == 0 || magBits > 24 || precBits > 24) {
+		return 0;
+	}
+	if(codec->compress == compressVariableBitCodec || codec->compress == compressVariableBitEntropyCodec) {
+		if(codec->parameter == SHUFFLE_BITS && recordBits > 32) { //bit shuffled records are held in 32 bit ints
+			return 0;
+		}
+	} else if(codec->compress == compress24BitCodec || codec->compress == compress24BitEntropyCodec) {
+		if(recordBits != 24) {
+			return 0;
+		}
+	} else if(codec->compress == compressAlignedCodec) {
+		if(recordBits > 32) {
+			return 0;
+		}
+		codec->parameter = (recordBits + 7) / 8;
+	} else if(codec->compress == compressTruncatedFloatCodec) {
+		if(magBits == 0 || magBits > 8 || precBits > 23) {
+			return 0;
+		}
+		codec->parameter = TRUNCATED_FLOAT_BIAS(magBits);
+	} else {
+		return 0;
+	}
+	codec->magBits = magBits;
+	codec->precBits = precBits;
+	return 1;
+}
+
+/*
+ * Purpose:
+ *		Write the low bytes of value to a file, least significant first, so streams read back the same on any machine
+ */
+static int writeLittleEndian(FILE *file, uint64_t value, unsigned int bytes) {
+	unsigned char buffer[8];
+	unsigned int i;
+
+	for(i = 0; i < bytes; i++) {
+		buffer[i] = (value >> 8*i) & 0xFF;
+	}
+	return fwrite(buffer, 1, bytes, file) == bytes;
+}
+
+/*
+ * Purpose:
+ *		Read a value written by writeLittleEndian
+ * Returns:
+ *		1 on success, 0 if the file ended first
+ */
+static int readLittleEndian(FILE *file, uint64_t *value, unsigned int bytes) {
+	unsigned char buffer[8];
+	unsigned int i;
+
+	if(fread(buffer, 1, bytes, file) != bytes) {
+		return 0;
+	}
+	*value = 0;
+	for(i = 0; i < bytes; i++) {
+		*value |= (uint64_t) buffer[i] << 8*i;
+	}
+	return 1;
+}
+
+/*
+ * Purpose:
+ *		Start a field stream: magic, version, codec name, widths, codec parameter and field shape. Blocks written by writeFieldStreamBlock
+ *		follow, then writeFieldStreamEnd.
+ * Returns:
+ *		1 on success, 0 if the file couldnt be written
+ * Parameters:
+ *		1. file - Where the stream goes, it can be a pipe
+ *		2. header - The codec (a registered codec or a copy of one from setCodecWidths) and the shape (0s when unknown)
+ */
+int writeFieldStreamHeader(FILE *file, const struct fieldStreamHeader *header) {
+	size_t nameLength = strlen(header->codec.name);
 
-		//deal with precision bits
-		target = precBits;
-		while(target != 0) {
-			if(target > uncompBits) { //trying to extract more bits than available in current byte
-				//find out the number of useful bits we have (it'll be on RHS) AND to get it then move on
-				afterDp = (afterDp | ((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1)) << (target-uncompBits);
-				ci--;
-				target = target - uncompBits;
-				uncompBits = 8;
-			} else { //got what we want in the current byte
-				afterDp = afterDp | ((((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2, target)-1)));
-				uncompBits = uncompBits - target;
-				target = 0;
-				if(uncompBits == 0) {
-					ci--;
-					uncompBits = 8;
-				}
-			}
-		}
-		uncompressed[uci] = signMultiplier * (beforeDp + ((float) afterDp) / divider);
-		uci++;
+	if(nameLength > 255) {
+		return 0;
 	}
-	return uncompressed;
+	return fwrite(FIELD_STREAM_MAGIC, 1, 4, file) == 4 && writeLittleEndian(file, FIELD_STREAM_VERSION, 1) && writeLittleEndian(file, nameLength, 1)
+		&& fwrite(header->codec.name, 1, nameLength, file) == nameLength && writeLittleEndian(file, header->codec.magBits, 1)
+		&& writeLittleEndian(file, header->codec.precBits, 1) && writeLittleEndian(file, header->codec.parameter, 8)
+		&& writeLittleEndian(file, header->nx, 4) && writeLittleEndian(file, header->ny, 4) && writeLittleEndian(file, header->nz, 4);
 }
 
 /*
  * Purpose:
- *		Retrieve and decompress a float from the given compressed array
+ *		Check a codec parameter read from a field stream against what the codec's format allows, the decoders index and shift by it
  * Returns:
- *		Floating point number decompressed from the array (precision can be lost)
+ *		1 if the parameter is usable, 0 if the stream is damaged
  * Parameters:
- *		1. allValues - The array of compressed values
- *		2. byteCount - The number of bytes (items) that allValues takes up
- *		3. targetIndex - The index (in the index in uncompressed version of allValues) of the value desired.
- * 		4. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
- *		5. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ *		1. codec - Codec from the stream, with the stream's widths already set
+ *		2. parameter - Parameter read from the stream
  */
-float getSingleVariableBitValue(unsigned char *allValues, unsigned int byteCount, unsigned int targetIndex, unsigned int magBits, unsigned int precBits) {
-	int startByte = floor(targetIndex*(1+magBits+precBits)/8);
-	int startIndex = (targetIndex*(1+magBits+precBits)) % 8;
-	startByte =  byteCount-1-startByte;
-	startIndex = 7-startIndex;
-	unsigned int divider;
-	if(numberOfDigits(precBits) == 1) {
-		divider = 10;
-	} else {
-		divider = pow(10, numberOfDigits(precBits)-1);
+static int checkCodecParameter(const struct codec *codec, uint64_t parameter) {
+	if(parameter > UINT_MAX) {
+		return 0;
 	}
-	divider = divider*10;
-	unsigned int beforeDp;
-	unsigned int afterDp;
-	int i, signMultiplier;
-	unsigned int ci = startByte;
-	unsigned int target; //how many target bits
-	unsigned int uncompBits = startIndex+1; //uncompressedbits
+	if(codec->compress == compressAlignedCodec || codec->compress == compress24BitCodec || codec->compress == compressVariableBitCodec
+		|| codec->compress == compressRunlengthCodec || codec->compress == compressFloat16Codec || codec->compress == compressBFloat16Codec) {
+		return parameter == codec->parameter; //record bytes follow from the widths, the rest dont use it
+	} else if(codec->compress == compressTruncatedFloatCodec) {
+		return parameter <= 127 && parameter + 129 >= (1U << codec->magBits); //exponent bias range from getTruncatedFloatLayout
+	} else if(codec->compress == compressCodebookCodec) {
+		return parameter == 8 || parameter == 16;
+	} else if(codec->compress == compressXorCodec) {
+		return parameter > 0;
+	} else if(codec->compress == compressVariableBitEntropyCodec) {
+		return parameter < SHUFFLE_BITS || (parameter == SHUFFLE_BITS && 1 + codec->magBits + codec->precBits <= 32);
+	} else if(codec->compress == compress24BitEntropyCodec || codec->compress == compressFloatEntropyCodec) {
+		return parameter <= SHUFFLE_BITS;
+	}
+	return 1; //codecs registered from outside check their own parameter
+}
 
-	beforeDp = 0;
-	afterDp = 0;
-	target = 1;
+/*
+ * Purpose:
+ *		Read the start of a field stream. The codec is looked up by name in the registry, so codecs registered by the program that wrote
+ *		the stream must be registered before reading it.
+ * Returns:
+ *		1 on success, 0 if the file isnt a field stream, is from a newer version, is cut short, names a codec that isnt registered
+ *		or has widths or a parameter the codec cant use
+ * Parameters:
+ *		1. file - Stream written by writeFieldStreamHeader
+ *		2. header - Blank header that gets the codec (with the stream's widths and parameter) and the shape
+ */
+int readFieldStreamHeader(FILE *file, struct fieldStreamHeader *header) {
+	char magic[4], name[256];
+	uint64_t version, nameLength, magBits, precBits, parameter, nx, ny, nz;
+	const struct codec *codec;
 
-	//deal with sign
-	if(((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2,target)-1) == 1) { //extract sign bit
-		signMultiplier = -1;
-	} else {
-		signMultiplier = 1;
+	if(fread(magic, 1, 4, file) != 4 || memcmp(magic, FIELD_STREAM_MAGIC, 4) != 0 || !readLittleEndian(file, &version, 1)
+		|| version != FIELD_STREAM_VERSION || !readLittleEndian(file, &nameLength, 1)) {
+		return 0;
 	}
-	uncompBits--;
-	if(uncompBits == 0) { //if we run out of space, move onto next byte
-		ci--;
-		uncompBits = 8;
+	if(fread(name, 1, nameLength, file) != nameLength) {
+		return 0;
 	}
-
-	//deal with magnitude bits
-	target = magBits; //extract magnitude
-	while(target != 0) {
-		if(target > uncompBits) { //trying to extract more bits than available in current byte
-			//find out the number of useful bits we have (it'll be on RHS) AND to get it then move on
-			beforeDp = beforeDp | (((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1) << (target-uncompBits));
-			ci--;
-			target = target - uncompBits;
-			uncompBits = 8;
-		} else { //got what we want in the current byte
-			beforeDp =  beforeDp | ((allValues[ci] >> (uncompBits-target) & (uint32_t) pow(2, target)-1));
-			uncompBits = uncompBits - target;
-			target = 0;
-			if(uncompBits == 0) {
-				ci--;
-				uncompBits = 8;
-			}
-		}
+	name[nameLength] = '\0';
+	if(!readLittleEndian(file, &magBits, 1) || !readLittleEndian(file, &precBits, 1) || !readLittleEndian(file, &parameter, 8)
+		|| !readLittleEndian(file, &nx, 4) || !readLittleEndian(file, &ny, 4) || !readLittleEndian(file, &nz, 4)) {
+		return 0;
 	}
-
-	//deal with precision bits
-	target = precBits;
-	while(target != 0) {
-		if(target > uncompBits) { //trying to extract more bits than available in current byte
-			afterDp = (afterDp | ((allValues[ci]) & (uint32_t) pow(2, uncompBits)-1)) << (target-uncompBits);
-			ci--;
-			target = target - uncompBits;
-			uncompBits = 8;
-		} else { //got what we want in the current byte
-			afterDp = afterDp | ((((allValues[ci] >> (uncompBits-target)) & (uint32_t) pow(2, target)-1)));
-			uncompBits = uncompBits - target;
-			target = 0;
-			if(uncompBits == 0) {
-				ci--;
-				uncompBits = 8;
-			}
-		}
+	codec = findCodec(name);
+	if(codec == NULL) {
+		return 0;
 	}
-	return signMultiplier * (beforeDp + ((float) afterDp) / divider);
+	header->codec = *codec;
+	if((magBits != codec->magBits || precBits != codec->precBits) && !setCodecWidths(&header->codec, magBits, precBits)) {
+		return 0;
+	}
+	if(!checkCodecParameter(&header->codec, parameter)) {
+		return 0;
+	}
+	header->codec.parameter = parameter;
+	header->nx = nx;
+	header->ny = ny;
+	header->nz = nz;
+	return 1;
 }
 
 /*
  * Purpose:
- *		Compress and insert a given float into the given compressed array
+ *		Compress a block of values on its own and append it to a field stream as its value count, compressed size and compressed bytes
+ * Returns:
+ *		1 on success, 0 if the file couldnt be written
  * Parameters:
- *		1. allValues - The array of compressed values
- *		2. byteCount - The number of bytes (items) that allValues takes up
- *		3. targetIndex - The index (in the index in uncompressed version of allValues) where value is to be inserted into
- *		4. value - Floating point value to be inserted
- * 		5. magBits - Number of bits that have been used to represent magnitude in the 24 bit notation.
- *		6. precBits - Number of bits that have been used to represent precision in the 24 bit notation.
+ *		1. file - Stream started by writeFieldStreamHeader
+ *		2. codec - Codec from the stream's header
+ *		3. values - The block
+ *		4. count - Number of values in the block, 1 to FIELD_STREAM_MAX_BLOCK
+ *		5. bytes - Gets the compressed size of the block
  */
-void insertSingleVariableBitValue (unsigned char *allValues, unsigned int byteCount, unsigned int targetIndex, float value, unsigned int magBits, unsigned int precBits) {
-	int startByte = floor(targetIndex*(1+magBits+precBits)/8);
-	int startIndex = (targetIndex*(1+magBits+precBits)) % 8;
-	startByte =  byteCount-1-startByte;
-	startIndex = 7-startIndex;
-	unsigned int ci = startByte;
-	int j;
-	unsigned int space = startIndex;
-	unsigned int target = 1;
-	struct floatSplitValue split;
-	unsigned int multiplier;
+int writeFieldStreamBlock(FILE *file, const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	unsigned char *compressed;
+	int written;
 
-	if(numberOfDigits(precBits) == 1) {
-		multiplier = 10;
-	} else {
-		multiplier = pow(10, numberOfDigits(precBits)); //max number of digits that can be represented by a precBits number
+	if(count == 0 || count > FIELD_STREAM_MAX_BLOCK) {
+		return 0;
 	}
-	int totalToZero = 1+magBits+precBits;
-	int currentCount = startIndex;
-	int ind = ci;
-	while(totalToZero != 0) {
+	compressed = codec->compress(codec, values, count, bytes);
+	written = writeLittleEndian(file, count, 4) && writeLittleEndian(file, *bytes, 8) && fwrite(compressed, 1, *bytes, file) == *bytes;
+	free(compressed);
+	return written;
+}
 
-		allValues[ind] &= ~(1UL << currentCount);
-		currentCount--;
-		totalToZero--;
-		if(currentCount == -1) {
-			currentCount = 7;
-			ind--;
-		}
-	}
+/*
+ * Purpose:
+ *		Finish a field stream with an empty block
+ */
+int writeFieldStreamEnd(FILE *file) {
+	return writeLittleEndian(file, 0, 4) && fflush(file) == 0;
+}
 
-	unsigned int uci = 0; //current floats index
+/*
+ * Purpose:
+ *		Read the next block of a field stream without decompressing it, so its size can be reported or it can be skipped cheaply
+ * Returns:
+ *		1 if a block was read, 0 at the end of the stream, -1 if the stream is cut short or the block is bigger than its codec allows
+ * Parameters:
+ *		1. file - Stream positioned after its header or a previous block
+ *		2. codec - Codec from the stream's header, used to bound the block size
+ *		3. compressed - Gets the malloced compressed bytes of the block, free them after use
+ *		4. count - Gets the number of values in the block
+ *		5. bytes - Gets the size of compressed
+ */
+int readFieldStreamBlock(FILE *file, const struct codec *codec, unsigned char **compressed, unsigned int *count, size_t *bytes) {
+	uint64_t blockCount, blockBytes, limit;
 
-		target = 1;
-		split = splitFloat(value, multiplier);
+	if(!readLittleEndian(file, &blockCount, 4)) {
+		return -1;
+	}
+	if(blockCount == 0) {
+		return 0;
+	}
+	limit = codec->compressedSize ? codec->compressedSize(codec, blockCount) : 2*blockCount*sizeof(float) + 4096; //codecs without a bound (zfp) get some slack
+	if(blockCount > FIELD_STREAM_MAX_BLOCK || !readLittleEndian(file, &blockBytes, 8) || blockBytes > limit) {
+		return -1;
+	}
+	*compressed = calloc(blockBytes + sizeof(uint64_t), 1); //zeroed slack for decoders that load a whole word at the last record, as compress leaves
+	if(fread(*compressed, 1, blockBytes, file) != blockBytes) {
+		free(*compressed);
+		return -1;
+	}
+	*count = blockCount;
+	*bytes = blockBytes;
+	return 1;
+}
 
-		if(value < 0) { //need to deal with -ve sign
+static const struct codecKernels scalarKernels = {ISA_SCALAR, findRunEndScalar, fillRunScalar, decode24BitRecordsScalar, NULL, NULL,
+	encodeFloat16Scalar, decodeFloat16Scalar, shuffleBytesScalar, unshuffleBytesScalar, transposeBitsScalar, untransposeBitsScalar,
+	decodeCodebookScalar};
+#ifdef COMPRESSOR_X86
+static const struct codecKernels sse2Kernels = {ISA_SSE2, findRunEndSSE2, fillRunSSE2, decode24BitRecordsScalar, NULL, NULL,
+	encodeFloat16Scalar, decodeFloat16Scalar, shuffleBytesScalar, unshuffleBytesScalar, transposeBitsSSE2, untransposeBitsSSE2,
+	decodeCodebookScalar};
+static const struct codecKernels ssse3Kernels = {ISA_SSSE3, findRunEndSSE2, fillRunSSE2, decode24BitRecordsSSSE3Kernel, NULL, NULL,
+	encodeFloat16Scalar, decodeFloat16Scalar, shuffleBytesSSSE3, unshuffleBytesSSSE3, transposeBitsSSE2, untransposeBitsSSE2,
+	decodeCodebookScalar};
+static const struct codecKernels avx2Kernels = {ISA_AVX2, findRunEndAVX2, fillRunAVX2, decode24BitRecordsAVX2Kernel, decodeVariableBitsAVX2,
+	extractVariableBitsAVX2, encodeFloat16F16C, decodeFloat16F16C, shuffleBytesSSSE3, unshuffleBytesSSSE3, transposeBitsAVX2, untransposeBitsSSE2,
+	decodeCodebookAVX2};
+static const struct codecKernels avx512Kernels = {ISA_AVX512, findRunEndAVX512, fillRunAVX512, decode24BitRecordsAVX512Kernel, decodeVariableBitsAVX512,
+	extractVariableBitsAVX512, encodeFloat16AVX512, decodeFloat16AVX512, shuffleBytesSSSE3, unshuffleBytesSSSE3, transposeBitsAVX2,
+	untransposeBitsSSE2, decodeCodebookAVX512};
+static const struct codecKernels *isaKernels[ISA_COUNT] = {&scalarKernels, &sse2Kernels, &ssse3Kernels, &avx2Kernels, &avx512Kernels};
+#else
+static const struct codecKernels *isaKernels[ISA_COUNT] = {&scalarKernels};
+#endif
+static const char *isaNames[ISA_COUNT] = {"scalar", "sse2", "ssse3", "avx2", "avx512"};
 
-			allValues[ci] = allValues[ci
-				] | (1 << (startIndex));
-		}
+/*
+ * Purpose:
+ *		Get the name of an instruction set level, as used by the KERNEL_ISA_ENV override
+ */
+const char *getIsaName(enum kernelIsa isa) {
+	return isa < ISA_COUNT ? isaNames[isa] : "unknown";
+}
 
-		if(space==0) { //move onto next compressed byte if we have to
-			ci--;
-			space = 8;
-		} //space 3
-		if(magBits >= 17) { //magnitude is in 3 bytes
-			uci = 2;
-			target = magBits-16;
-		} else if(magBits >=9) { //magnitude in 2 bytes
-			uci = 1;
-			target = magBits-8;
-		} else { //magnitude only in 1
-			uci = 0; //uci becomes 0
-			target = magBits; //target becomes 4
-		}
+/*
+ * Purpose:
+ *		Find the newest instruction set level this CPU (and OS) supports
+ * Returns:
+ *		The best level the kernels can use, ISA_SCALAR on CPUs that arent x86
+ */
+enum kernelIsa getSupportedIsa(void) {
+#ifdef COMPRESSOR_X86
+	__builtin_cpu_init(); //can be called before the CPU model is set up when run from a constructor
+	if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("f16c")) {
+		return ISA_AVX512;
+	} else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) { //every AVX2 CPU so far has F16C, the half float kernels need it
+		return ISA_AVX2;
+	} else if(__builtin_cpu_supports("ssse3")) {
+		return ISA_SSSE3;
+	} else if(__builtin_cpu_supports("sse2")) {
+		return ISA_SSE2;
+	}
+#endif
+	return ISA_SCALAR;
+}
 
-		//while(target != 0 && uci >= 0) { //deal with magnitude bits
-		while(target != 0) {//} && uci >= 0) { //deal with magnitude bits
-			if(space >= target) { //If we can fit target into current compressed byte, need to store whats behind
+/*
+ * Purpose:
+ *		Get the instruction set level of the kernels in use
+ */
+enum kernelIsa getKernelIsa(void) {
+	return kernels->isa;
+}
 
-				allValues[ci] = allValues[ci] | (split.beforeDecimal[uci] << (space-target));
+/*
+ * Purpose:
+ *		Use the kernels of an instruction set level for every codec from now on. Not thread safe, call it between benchmarks rather than
+ *		while codecs are running.
+ * Returns:
+ *		1 if the kernels were changed, 0 if this CPU doesnt support isa (or it wasnt built in) and the kernels were left alone
+ */
+int setKernelIsa(enum kernelIsa isa) {
+	if(isa >= ISA_COUNT || isaKernels[isa] == NULL || isa > getSupportedIsa()) {
+		return 0;
+	}
+	kernels = isaKernels[isa];
+	return 1;
+}
 
-				space = space - target;
-				if(space == 0) {
-					ci--;
-					space = 8;
-				}
-				if(uci > 0) { //if not on last byte then move further down
-					uci--;
-					target = 8;
-				} else {
-					uci--;
-					target = 0;
-				}
-			} else { //trying to deal with more bits than space
-				allValues[ci] = allValues[ci] | (split.beforeDecimal[uci] >> (target-space)); 
-				ci--;
-				target = target - space;
-				space = 8;
-			}
-		}
-		if(precBits >= 17) { //magnitude is in 3 bytes
-			uci = 2;
-			target = precBits-16;
-		} else if(precBits >=9) { //magnitude in 2 bytes
-			uci = 1;
-			target = precBits-8;
-		} else { //magnitude only in 1
-			uci = 0;
-			target = precBits;
-		}
-		while(target != 0) {//deal with prec bits
-			if(space >= target) { //If we can fit target into current compressed byte
-				allValues[ci] = ((((uint32_t)pow(2, 8)-1) - ((uint32_t)pow(2,space)-1)) & allValues[ci]);
-				allValues[ci] = allValues[ci] | (split.afterDecimal[uci] << (space-target));
-				space = space - target;
-				if(space == 0) {
-					ci--;
-					space = 8;
-				}
-				if(uci > 0) { //if not on last byte then move further down
-					uci--;
-					target = 8;
-				} else {
-					uci--;
-					target = 0;
-				}
-			} else { //trying to deal with more bits than space
-				allValues[ci] = ((((uint32_t)pow(2, 8)-1) - ((uint32_t)pow(2,space)-1)) & allValues[ci]);
-				allValues[ci] = allValues[ci] | (split.afterDecimal[uci] >> (target-space));
-				ci--;
-				target = target - space;
-				space = 8;
-			}
+/*
+ * Purpose:
+ *		Pick the kernels before main runs, the best the CPU supports unless KERNEL_ISA_ENV names another level. A level the CPU cant run is
+ *		reported and ignored rather than crashing on the first illegal instruction.
+ */
+__attribute__((constructor))
+static void selectKernels(void) {
+	const char *forced = getenv(KERNEL_ISA_ENV);
+	unsigned int isa;
+
+	setKernelIsa(getSupportedIsa());
+	if(forced == NULL || forced[0] == '\0') {
+		return;
+	}
+	for(isa = 0; isa < ISA_COUNT; isa++) {
+		if(strcmp(forced, isaNames[isa]) == 0) {
+			break;
 		}
-}
\ No newline at end of file
+	}
+	if(isa == ISA_COUNT) {
+		fprintf(stderr, "%s=%s isnt one of scalar, sse2, ssse3, avx2 or avx512, using %s kernels\n", KERNEL_ISA_ENV, forced, getIsaName(getKernelIsa()));
+	} else if(!setKernelIsa((enum kernelIsa) isa)) {
+		fprintf(stderr, "%s=%s isnt supported on this CPU, using %s kernels\n", KERNEL_ISA_ENV, forced, getIsaName(getKernelIsa()));
+	}
+}
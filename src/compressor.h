@@ -2,30 +2,308 @@
 //AUTHOR: Craig
 //PURPOSE: headers for functions used for compression/decompression/etc by test/data analysis files
 #include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
 
 #ifndef COMPRESSOR_H_
 #define COMPRESSOR_H_
 
-struct compressedVal { //struct to represent a multiple*8 bit compressed value
+#ifdef __cplusplus
+extern "C" { //lets compressed_array.hpp and other C++ code link against compressor.o
+#endif
+
+#define FIELD_STREAM_MAGIC "CFLD" //first 4 bytes of a field stream
+#define FIELD_STREAM_VERSION 1
+#define FIELD_STREAM_BLOCK (1 << 20) //default values per field stream block, about 4MB of floats in memory at once
+#define FIELD_STREAM_MAX_BLOCK (1 << 26) //most values a block can hold, so a damaged stream cant ask for huge allocations
+
+enum kernelIsa { //instruction set levels the SIMD codec kernels are built for, oldest first
+	ISA_SCALAR,
+	ISA_SSE2,
+	ISA_SSSE3,
+	ISA_AVX2,
+	ISA_AVX512, //AVX-512F and BW
+	ISA_COUNT
+};
+
+#define KERNEL_ISA_ENV "COMPRESSOR_ISA" //environment variable that forces a level (scalar, sse2, ssse3, avx2 or avx512), for benchmarking
+
+struct compressedVal { //struct to represent a multiple*8 bit compressed value, arrays from get24BitCompressedData have 1 padding record on the end
 	unsigned char data[3];
 };
 
-struct runlengthEntry { //Struct to represent a runlength entry of value and number of times its repeated
-	float value;
-	uint32_t valueCount;
+#define RUNLENGTH_MAX_OVERHEAD 10 //most bytes runlength compression can add on top of the raw floats (count header and one literal span header)
+#define RUNLENGTH_PARALLEL_MIN (1 << 16) //smallest output runlength decompression splits across threads
+#define CODEBOOK_ENTRIES(indexBits) (1U << (indexBits)) //codebook formats take 8 or 16 bit indices
+#define CODEBOOK_BYTES(count, indexBits) (CODEBOOK_ENTRIES(indexBits) * sizeof(float) + (size_t) (count) * ((indexBits) / 8))
+#define ENTROPY_BLOCK (1 << 16) //bytes per entropy coded block, each has its own frequency table
+#define ENTROPY_BLOCK_OVERHEAD (1 + 3 + 32 + 512 + 3) //most bytes a block header can add: mode, length, symbol map, frequencies, stream length
+#define TRUNCATED_FLOAT_BIAS(expBits) ((1U << ((expBits) - 1)) - 1) //IEEE style exponent bias for truncated floats, range centred on 1.0
+
+enum fieldElementType { //type of each value of a field as stored in its data file
+	FIELD_FLOAT32,
+	FIELD_FLOAT64
+};
+
+struct fieldDescriptor { //shape of a 3D dataset, value (i, j, k) is at origin + i*sx + j*sy + k*sz
+	unsigned int nx;
+	unsigned int ny;
+	unsigned int nz;
+	size_t sx;
+	size_t sy;
+	size_t sz;
+	enum fieldElementType type;
+	unsigned int halo; //ghost cells stored on every side, (-halo, -halo, -halo) is the first value in memory
+	size_t origin;
 };
 
+/*
+ * Purpose:
+ *		Get the position of (i, j, k) in the flat array of a field.
+ */
+static inline size_t getFieldIndex(const struct fieldDescriptor *field, int i, int j, int k) {
+	return field->origin + i*field->sx + j*field->sy + k*field->sz;
+}
+
+enum fieldLayoutType { //order a field's values are stored in
+	LAYOUT_LINEAR, //x fastest, then y, then z
+	LAYOUT_BRICK, //LAYOUT_BRICK_SIZE^3 bricks stored one after another, linear inside each brick
+	LAYOUT_MORTON //LAYOUT_MORTON_SIZE^3 bricks stored one after another, Z-order (Morton) inside each brick
+};
+
+#define LAYOUT_BRICK_SIZE 8
+#define LAYOUT_MORTON_SIZE 16 //must be a power of 2
+
+struct fieldLayout { //storage position of (i, j, k) is xOffsets[i] + yOffsets[j] + zOffsets[k], every layout here splits that way
+	enum fieldLayoutType type;
+	unsigned int brick; //edge of a brick, 0 for LAYOUT_LINEAR
+	size_t *xOffsets;
+	size_t *yOffsets;
+	size_t *zOffsets;
+	size_t storageCount; //values needed to store the field, bricks hanging over the edge leave unused slots
+};
+
+struct variableBitStream { //reads or writes the records of a variable bit compressed array one after another, starting at index 0
+	unsigned char *values;
+	size_t byteCount;
+	size_t next; //bytes of the stream used so far, the stream runs backwards from values[byteCount-1]
+	uint64_t buffer;
+	unsigned int bits;
+	unsigned int magBits;
+	unsigned int precBits;
+	unsigned int multiplier; //scales the part after the decimal point when writing
+	float divider; //scales it back when reading
+};
+
+struct codec { //a compression format behind one interface, benchmarks loop over every registered codec instead of naming each format
+	const char *name;
+	int lossless;
+	int trained; //records index a table trained on the values compressed, set can only store the nearest value the table holds
+	unsigned int magBits; //format parameters, 0 where a codec has none
+	unsigned int precBits;
+	unsigned int parameter; //format specific: record bytes for byte aligned codecs, prediction stride for XOR predictive, index bits for codebooks
+	void *context; //state for codecs registered from outside compressor.c
+	unsigned char *(*compress)(const struct codec *codec, float *values, unsigned int count, size_t *bytes);
+	float *(*decompress)(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count);
+	size_t (*compressedSize)(const struct codec *codec, unsigned int count); //most bytes compress can return, NULL if unknown in advance
+	float (*get)(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index); //NULL without random access
+	void (*set)(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int index, float value);
+	void (*getBatch)(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values);
+	void (*setBatch)(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values);
+};
+
+#define MAX_CODECS 32
+
+struct fieldStreamHeader { //start of a field stream, the codec and shape shared by the independently compressed blocks that follow
+	struct codec codec; //copy of the registered codec with the widths and parameter the stream was written with
+	unsigned int nx; //shape of the field, 0s when the writer didnt know it
+	unsigned int ny;
+	unsigned int nz;
+};
+
+struct compressedField { //a compressed 3D field, the records together with everything needed to address and decode them
+	const struct codec *codec;
+	unsigned char *values;
+	size_t bytes;
+	unsigned int nx;
+	unsigned int ny;
+	unsigned int nz;
+	const struct fieldLayout *layout; //storage order of the records, not owned by the field
+	unsigned int recordBits; //1+magBits+precBits when the accessors below decode records inline (variable bit codecs), 0 to call the codec
+	unsigned int precBits;
+	uint32_t magMask;
+	uint32_t precMask;
+	unsigned int multiplier;
+	float divider;
+};
+
+/*
+ * Purpose:
+ *		Get the storage position of (i, j, k) in a field stored with layout.
+ */
+static inline size_t getLayoutIndex(const struct fieldLayout *layout, int i, int j, int k) {
+	return layout->xOffsets[i] + layout->yOffsets[j] + layout->zOffsets[k];
+}
+
+/*
+ * Purpose:
+ *		Load the (up to) 8 bytes of a variable bit stream starting at stream byte first, MSB first. The stream runs backwards through memory
+ *		so on a little endian machine this is one plain load.
+ */
+static inline uint64_t loadFieldWindow(const struct compressedField *field, size_t first) {
+	size_t top = field->bytes - 1 - first; //memory position of stream byte first
+	uint64_t window = 0;
+	size_t t;
+
+	if(top >= 7) {
+		memcpy(&window, field->values + top - 7, sizeof(uint64_t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		window = __builtin_bswap64(window);
+#endif
+		return window;
+	}
+	for(t = 0; t <= top; t++) { //last few bytes of the stream
+		window |= (uint64_t) field->values[top - t] << (56 - 8*t);
+	}
+	return window;
+}
+
+/*
+ * Purpose:
+ *		Get the value stored at storage position index of a compressed field
+ */
+static inline float getFieldRecord(const struct compressedField *field, size_t index) {
+	size_t bit;
+	uint64_t record;
+
+	if(field->recordBits == 0) {
+		return field->codec->get(field->codec, field->values, field->bytes, index);
+	}
+	bit = index * field->recordBits;
+	record = (loadFieldWindow(field, bit / 8) << (bit % 8)) >> (64 - field->recordBits);
+	return ((record >> (field->recordBits - 1)) ? -1 : 1) * (((record >> field->precBits) & field->magMask) + (record & field->precMask) / field->divider);
+}
+
+/*
+ * Purpose:
+ *		Compress value into storage position index of a compressed field. Only the bytes the record covers are written, so records in
+ *		different bytes can be set from different threads.
+ */
+static inline void setFieldRecord(const struct compressedField *field, size_t index, float value) {
+	size_t bit, top;
+	unsigned int shift, t;
+	uint64_t record, mask, window;
+	float beforeDp, afterDp;
+
+	if(field->recordBits == 0) {
+		field->codec->set(field->codec, field->values, field->bytes, index, value);
+		return;
+	}
+	afterDp = modff(value, &beforeDp); //same split as splitFloat
+	record = ((uint64_t) (value < 0) << (field->recordBits - 1)) | ((uint64_t) ((uint32_t) fabs(beforeDp) & field->magMask) << field->precBits)
+		| ((uint32_t) round(fabs(afterDp) * field->multiplier) & field->precMask);
+	bit = index * field->recordBits;
+	shift = 64 - field->recordBits - bit % 8;
+	mask = ((1ULL << field->recordBits) - 1) << shift;
+	window = (loadFieldWindow(field, bit / 8) & ~mask) | (record << shift);
+	top = field->bytes - 1 - bit / 8;
+	for(t = 0; t < (bit % 8 + field->recordBits + 7) / 8; t++) {
+		field->values[top - t] = window >> (56 - 8*t);
+	}
+}
+
+/*
+ * Purpose:
+ *		Get the value at (i, j, k) of a compressed field, no bounds checks
+ */
+static inline float getFieldValue(const struct compressedField *field, int i, int j, int k) {
+	return getFieldRecord(field, getLayoutIndex(field->layout, i, j, k));
+}
+
+/*
+ * Purpose:
+ *		Set the value at (i, j, k) of a compressed field, no bounds checks
+ */
+static inline void setFieldValue(const struct compressedField *field, int i, int j, int k, float value) {
+	setFieldRecord(field, getLayoutIndex(field->layout, i, j, k), value);
+}
+
+/*
+ * Purpose:
+ *		Add up the neighbours of (i, j, k) that are inside a compressed field, in the order -i, +i, -j, +j, -k, +k. Interior points take a
+ *		fast path with no bounds checks.
+ * Returns:
+ *		The sum, with the number of neighbours added in count
+ */
+static inline float getFieldNeighbourSum(const struct compressedField *field, int i, int j, int k, int *count) {
+	float sum = 0.0f;
+
+	if(i > 0 && i < (int) field->nx-1 && j > 0 && j < (int) field->ny-1 && k > 0 && k < (int) field->nz-1) {
+		*count = 6;
+		return getFieldValue(field, i-1, j, k) + getFieldValue(field, i+1, j, k) + getFieldValue(field, i, j-1, k)
+			+ getFieldValue(field, i, j+1, k) + getFieldValue(field, i, j, k-1) + getFieldValue(field, i, j, k+1);
+	}
+	*count = 0;
+	if(i > 0) {
+		sum += getFieldValue(field, i-1, j, k);
+		(*count)++;
+	}
+	if(i < (int) field->nx-1) {
+		sum += getFieldValue(field, i+1, j, k);
+		(*count)++;
+	}
+	if(j > 0) {
+		sum += getFieldValue(field, i, j-1, k);
+		(*count)++;
+	}
+	if(j < (int) field->ny-1) {
+		sum += getFieldValue(field, i, j+1, k);
+		(*count)++;
+	}
+	if(k > 0) {
+		sum += getFieldValue(field, i, j, k-1);
+		(*count)++;
+	}
+	if(k < (int) field->nz-1) {
+		sum += getFieldValue(field, i, j, k+1);
+		(*count)++;
+	}
+	return sum;
+}
+
 void getAbsoluteFilepaths(char *files[], char *baseDirectory, char *fileExtension, unsigned int *count);
 
 float *getData(char *absFilePath, unsigned int *count, float *max, float *min, float *mean);
 
+struct fieldDescriptor getContiguousField(unsigned int nx, unsigned int ny, unsigned int nz);
+
+int getFieldDescriptor(char *absFilePath, struct fieldDescriptor *field);
+
+struct fieldDescriptor getPaddedField(unsigned int nx, unsigned int ny, unsigned int nz, unsigned int halo);
+
+size_t getFieldStorageCount(const struct fieldDescriptor *field);
+
+float *getPaddedData(float *values, const struct fieldDescriptor *field, const struct fieldDescriptor *padded);
+
+struct fieldLayout getFieldLayout(const struct fieldDescriptor *field, enum fieldLayoutType type);
+
+void freeFieldLayout(struct fieldLayout *layout);
+
+float *getLayoutData(float *values, const struct fieldDescriptor *field, const struct fieldLayout *layout);
+
 unsigned int *getVerificationData(char *absFilePath, unsigned int *dataLength);
 
-unsigned int numDigits (unsigned int numBits);
+unsigned int numberOfDigits (unsigned int numberOfBits);
+
+unsigned char *getRunlengthCompressedData(float *allValues, unsigned int count, unsigned int *newCount);
 
-struct runlengthEntry *getRunlengthCompressedData(float *allValues, unsigned int count, unsigned int *newCount);
+float *getRunlengthDecompressedData(unsigned char *compressedValues, unsigned int count, unsigned int *newCount);
 
-float *getRunlengthDecompressedData(struct runlengthEntry *compressedValues, unsigned int count, unsigned int *newCount);
+unsigned char *getXorPredictiveCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int predictorStride);
+
+float *getXorPredictiveDecompressedData(unsigned char *compressedValues, unsigned int count, unsigned int *newCount);
 
 struct compressedVal *get24BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits);
 
@@ -35,6 +313,93 @@ float getSingle24BitValue(struct compressedVal *allValues, unsigned int index, u
 
 void insertSingle24BitValue(struct compressedVal *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits);
 
+unsigned char *getAligned8BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+unsigned char *getAligned16BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+unsigned char *getAligned24BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+unsigned char *getAligned32BitCompressedData(float *uncompressedData, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+float *getAligned8BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+float *getAligned16BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+float *getAligned24BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+float *getAligned32BitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int magBits, unsigned int precBits);
+
+float getSingleAligned8BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+float getSingleAligned16BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+float getSingleAligned24BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+float getSingleAligned32BitValue(unsigned char *allValues, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+void insertSingleAligned8BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+void insertSingleAligned16BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+void insertSingleAligned24BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+void insertSingleAligned32BitValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+unsigned char *getFloat16CompressedData(float *uncompressedData, unsigned int count);
+
+float *getFloat16DecompressedData(unsigned char *allValues, unsigned int count);
+
+float getSingleFloat16Value(unsigned char *allValues, unsigned int index);
+
+void insertSingleFloat16Value(unsigned char *allValues, float updatedValue, unsigned int index);
+
+unsigned char *getBFloat16CompressedData(float *uncompressedData, unsigned int count);
+
+float *getBFloat16DecompressedData(unsigned char *allValues, unsigned int count);
+
+float getSingleBFloat16Value(unsigned char *allValues, unsigned int index);
+
+void insertSingleBFloat16Value(unsigned char *allValues, float updatedValue, unsigned int index);
+
+unsigned char *getCodebookCompressedData(float *uncompressedData, unsigned int count, unsigned int indexBits);
+
+float *getCodebookDecompressedData(unsigned char *allValues, unsigned int count, unsigned int indexBits);
+
+void insertSingleCodebookValue(unsigned char *allValues, float updatedValue, unsigned int index, unsigned int indexBits);
+
+/*
+ * Purpose:
+ *		Retrieve a single value from codebook compressed data, one index load and one table lookup so it is inlined into stencil loops
+ * Parameters:
+ *		1. allValues - The codebook and indices, from getCodebookCompressedData
+ *		2. index - The index of the value desired
+ *		3. indexBits - 8 or 16
+ */
+static inline float getSingleCodebookValue(const unsigned char *allValues, unsigned int index, unsigned int indexBits) {
+	const unsigned char *indices = allValues + CODEBOOK_ENTRIES(indexBits) * sizeof(float);
+	uint16_t entry;
+
+	if(indexBits == 8) {
+		return ((const float *) allValues)[indices[index]];
+	}
+	memcpy(&entry, indices + (size_t) index*2, sizeof(uint16_t));
+	return ((const float *) allValues)[entry];
+}
+
+int32_t getSingle24BitFixedValue(struct compressedVal *allValues, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+void insertSingle24BitFixedValue(struct compressedVal *allValues, int32_t fixedValue, unsigned int index, unsigned int magBits, unsigned int precBits);
+
+int32_t floatToFixedPoint(float value, unsigned int precBits);
+
+float fixedPointToFloat(int32_t fixedValue, unsigned int precBits);
+
+int32_t fixedPointAdd(int32_t a, int32_t b);
+
+int32_t fixedPointScale(int32_t value, int32_t numerator, int32_t denominator);
+
+int32_t fixedPointAverage(int32_t *values, unsigned int count);
+
 unsigned char *getVariableBitCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int magBits, unsigned int precBits);
 
 float *getVariableBitDecompressedData(unsigned char *allValues, unsigned int count, unsigned int *newCount, unsigned int magBits, unsigned int precBits);
@@ -42,4 +407,78 @@ float *getVariableBitDecompressedData(unsigned char *allValues, unsigned int cou
 float getSingleVariableBitValue(unsigned char *allValues, unsigned int count, unsigned int targetIndex, unsigned int magBits, unsigned int precBits);
 
 void insertSingleVariableBitValue (unsigned char *allValues, unsigned int count, unsigned int targetIndex, float value, unsigned int magBits, unsigned int precBits);
-#endif
\ No newline at end of file
+
+void startVariableBitStream(struct variableBitStream *stream, unsigned char *allValues, unsigned int byteCount, unsigned int magBits, unsigned int precBits);
+
+void readVariableBitValues(struct variableBitStream *stream, float *values, unsigned int count);
+
+void writeVariableBitValues(struct variableBitStream *stream, const float *values, unsigned int count);
+
+void flushVariableBitStream(struct variableBitStream *stream);
+
+unsigned char *getTruncatedFloatCompressedData(float *uncompressedData, unsigned int count, unsigned int *newCount, unsigned int expBits, unsigned int mantBits,
+	unsigned int bias);
+
+float *getTruncatedFloatDecompressedData(unsigned char *allValues, unsigned int byteCount, unsigned int count, unsigned int expBits, unsigned int mantBits,
+	unsigned int bias);
+
+float getSingleTruncatedFloatValue(unsigned char *allValues, unsigned int byteCount, unsigned int index, unsigned int expBits, unsigned int mantBits,
+	unsigned int bias);
+
+void insertSingleTruncatedFloatValue(unsigned char *allValues, unsigned int byteCount, unsigned int index, float value, unsigned int expBits,
+	unsigned int mantBits, unsigned int bias);
+
+void shuffleBytes(const unsigned char *in, size_t count, unsigned int width, unsigned char *out);
+
+void unshuffleBytes(const unsigned char *in, size_t count, unsigned int width, unsigned char *out);
+
+void shuffleBits(unsigned char *in, size_t count, unsigned int width, unsigned char *out, unsigned char *scratch);
+
+void unshuffleBits(unsigned char *in, size_t count, unsigned int width, unsigned char *out, unsigned char *scratch);
+
+unsigned char *getEntropyCompressedData(const unsigned char *data, size_t bytes, size_t *newBytes);
+
+size_t getEntropyCompressedSize(size_t bytes);
+
+unsigned char *getEntropyDecompressedData(const unsigned char *compressed, size_t bytes, size_t *newBytes);
+
+int registerCodec(const struct codec *codec);
+
+unsigned int getCodecCount();
+
+const struct codec *getCodec(unsigned int index);
+
+const struct codec *findCodec(const char *name);
+
+void codecGetBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, float *values);
+
+void codecSetBatch(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int start, unsigned int count, const float *values);
+
+struct compressedField getCompressedField(const struct codec *codec, float *values, unsigned int nx, unsigned int ny, unsigned int nz, const struct fieldLayout *layout);
+
+void freeCompressedField(struct compressedField *field);
+
+const char *getIsaName(enum kernelIsa isa);
+
+enum kernelIsa getSupportedIsa(void);
+
+enum kernelIsa getKernelIsa(void);
+
+int setKernelIsa(enum kernelIsa isa);
+
+int setCodecWidths(struct codec *codec, unsigned int magBits, unsigned int precBits);
+
+int writeFieldStreamHeader(FILE *file, const struct fieldStreamHeader *header);
+
+int readFieldStreamHeader(FILE *file, struct fieldStreamHeader *header);
+
+int writeFieldStreamBlock(FILE *file, const struct codec *codec, float *values, unsigned int count, size_t *bytes);
+
+int writeFieldStreamEnd(FILE *file);
+
+int readFieldStreamBlock(FILE *file, const struct codec *codec, unsigned char **compressed, unsigned int *count, size_t *bytes);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
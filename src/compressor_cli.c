@@ -0,0 +1,657 @@
+//FILE: compressor_cli.c
+//PURPOSE: command line tool to compress, decompress, inspect and verify fields with any registered codec. Fields are streamed through
+//in blocks (see writeFieldStreamBlock) so memory use doesnt grow with the field and the tool can sit in a shell pipeline.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <time.h>
+#include <unistd.h>
+#include "compressor.h"
+#include "zfp_example.h"
+
+enum valueFormat { //how uncompressed values are stored in files and pipes
+	FORMAT_FLOAT32, //raw native floats
+	FORMAT_FLOAT64, //raw native doubles, converted to float on the way in
+	FORMAT_TEXT //one value per line as in the simulation datasets, a leading "# nx ny nz" header line is skipped
+};
+
+struct valueReader { //reads uncompressed values a block at a time
+	FILE *file;
+	enum valueFormat format;
+	int started;
+	int failed; //set (with a message) when the input couldnt be read or holds something that isnt a value
+	size_t position; //values read so far
+	double *doubles; //conversion buffer for FORMAT_FLOAT64
+};
+
+/*
+ * Purpose:
+ *		Print how to use the tool
+ */
+static void usage(void) {
+	fprintf(stderr,
+		"usage: compressor_cli <command> [options] [input] [output]\n"
+		"commands:\n"
+		"\tcompress [-c codec] [-m magBits -p precBits] [-a tolerance] [-i float32|float64|text] [-d nx,ny,nz] [-b blockValues] [in] [out]\n"
+		"\tdecompress [-o float32|float64|text] [in] [out]\n"
+		"\tinspect [-v] [in]\n"
+		"\tverify [-e maxError] [-i float32|float64|text] original compressed\n"
+		"\tlist\n"
+		"input and output default to stdin and stdout, \"-\" also names them. Codecs are named as shown by list, -m/-p change the widths of a\n"
+		"lossy codec and -a sets the ZFP tolerance. Without -d the shape comes from a .dims sidecar or \"#\" header of the input file.\n");
+}
+
+/*
+ * Purpose:
+ *		Parse float32, float64 or text
+ * Returns:
+ *		1 if name is a format, 0 otherwise
+ */
+static int parseFormat(const char *name, enum valueFormat *format) {
+	if(strcmp(name, "float32") == 0) {
+		*format = FORMAT_FLOAT32;
+	} else if(strcmp(name, "float64") == 0) {
+		*format = FORMAT_FLOAT64;
+	} else if(strcmp(name, "text") == 0) {
+		*format = FORMAT_TEXT;
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Purpose:
+ *		Open a file named on the command line, "-" or no name at all means stdin/stdout
+ * Returns:
+ *		The file, or NULL (with a message) if it couldnt be opened
+ */
+static FILE *openFile(const char *path, const char *mode) {
+	FILE *file;
+
+	if(path == NULL || strcmp(path, "-") == 0) {
+		return mode[0] == 'r' ? stdin : stdout;
+	}
+	file = fopen(path, mode);
+	if(file == NULL) {
+		fprintf(stderr, "couldnt open %s\n", path);
+	}
+	return file;
+}
+
+static void closeFile(FILE *file) {
+	if(file != NULL && file != stdin && file != stdout) {
+		fclose(file);
+	}
+}
+
+/*
+ * Purpose:
+ *		Read up to count values
+ * Returns:
+ *		Number of values read, less than count at the end of the input or when reader->failed gets set
+ */
+static unsigned int readValues(struct valueReader *reader, float *values, unsigned int count) {
+	unsigned int i = 0, read;
+	int firstChar;
+	char token[32];
+
+	if(reader->format != FORMAT_TEXT) {
+		if(reader->format == FORMAT_FLOAT32) {
+			read = fread(values, sizeof(float), count, reader->file);
+		} else {
+			read = fread(reader->doubles, sizeof(double), count, reader->file);
+			for(i = 0; i < read; i++) {
+				values[i] = reader->doubles[i];
+			}
+		}
+		reader->position += read;
+		if(read < count && ferror(reader->file)) {
+			fprintf(stderr, "couldnt read the input after value %zu\n", reader->position);
+			reader->failed = 1;
+		}
+		return read;
+	}
+	if(!reader->started) { //skip a field header line, as getData does
+		reader->started = 1;
+		firstChar = fgetc(reader->file);
+		if(firstChar == '#') {
+			while(firstChar != '\n' && firstChar != EOF) {
+				firstChar = fgetc(reader->file);
+			}
+		} else if(firstChar != EOF) {
+			ungetc(firstChar, reader->file);
+		}
+	}
+	while(i < count && fscanf(reader->file, "%f", &values[i]) == 1) {
+		i++;
+	}
+	reader->position += i;
+	if(i < count && !feof(reader->file)) { //fscanf stopped on something that isnt a number, or the read failed
+		if(!ferror(reader->file) && fscanf(reader->file, "%31s", token) == 1) {
+			fprintf(stderr, "input has \"%s\" where value %zu should be\n", token, reader->position);
+		} else {
+			fprintf(stderr, "couldnt read the input after value %zu\n", reader->position);
+		}
+		reader->failed = 1;
+	}
+	return i;
+}
+
+/*
+ * Purpose:
+ *		Write count values
+ * Returns:
+ *		1 on success, 0 if the output couldnt be written
+ */
+static int writeValues(FILE *file, enum valueFormat format, const float *values, unsigned int count) {
+	unsigned int i;
+	double value;
+
+	if(format == FORMAT_FLOAT32) {
+		return fwrite(values, sizeof(float), count, file) == count;
+	}
+	for(i = 0; i < count; i++) {
+		if(format == FORMAT_FLOAT64) {
+			value = values[i];
+			if(fwrite(&value, sizeof(double), 1, file) != 1) {
+				return 0;
+			}
+		} else if(fprintf(file, "%.9g\n", values[i]) < 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static unsigned int zfpNx, zfpNy; //shape of the field being streamed, zfp compresses blocks of whole planes as 3D arrays
+
+/*
+ * Purpose:
+ *		Get the shape zfp sees for a block: whole nx*ny planes when the field shape is known and the block holds whole planes, otherwise 1D
+ */
+static void getZfpShape(unsigned int count, int *nx, int *ny, int *nz) {
+	if(zfpNx != 0 && zfpNy != 0 && count % ((size_t) zfpNx * zfpNy) == 0) {
+		*nx = zfpNx;
+		*ny = zfpNy;
+		*nz = count / ((size_t) zfpNx * zfpNy);
+	} else {
+		*nx = count;
+		*ny = 1;
+		*nz = 1;
+	}
+}
+
+/*
+ * Purpose:
+ *		Compress a block with zfp at the tolerance the codec parameter holds (the bits of a float, so it is kept in the stream header)
+ */
+static unsigned char *compressZfpCodec(const struct codec *codec, float *values, unsigned int count, size_t *bytes) {
+	const unsigned char *buffer;
+	int nx, ny, nz;
+
+	getZfpShape(count, &nx, &ny, &nz);
+	*bytes = zfpCompressWithContext(codec->context, values, nx, ny, nz, &buffer);
+	return memcpy(malloc(*bytes > 0 ? *bytes : 1), buffer, *bytes); //the context reuses its buffer
+}
+
+static float *decompressZfpCodec(const struct codec *codec, unsigned char *compressed, size_t bytes, unsigned int count) {
+	float *values = malloc((size_t) count * sizeof(float));
+	int nx, ny, nz;
+
+	getZfpShape(count, &nx, &ny, &nz);
+	if(zfpDecompressWithContext(codec->context, compressed, bytes, values, nx, ny, nz) != 0) {
+		free(values);
+		return NULL;
+	}
+	return values;
+}
+
+static struct codec zfpCodec = {.name = "ZFP", .compress = compressZfpCodec, .decompress = decompressZfpCodec};
+static struct codec xorPlaneCodec; //parameter set to nx*ny once the shape is known
+
+/*
+ * Purpose:
+ *		Register the codecs that arent built into compressor.c
+ */
+static void registerToolCodecs(void) {
+	xorPlaneCodec = *findCodec("XOR Predictive (previous value)");
+	xorPlaneCodec.name = "XOR Predictive (previous plane)";
+	registerCodec(&xorPlaneCodec);
+	registerCodec(&zfpCodec);
+}
+
+/*
+ * Purpose:
+ *		Finish setting up a codec from the command line or a stream header for the field shape, the zfp codec gets a context for the
+ *		tolerance in its parameter
+ * Returns:
+ *		1 on success, 0 (with a message) if the codec cant be used with this shape
+ */
+static int prepareCodec(struct fieldStreamHeader *header) {
+	float tolerance;
+
+	zfpNx = header->nx;
+	zfpNy = header->ny;
+	if(strcmp(header->codec.name, zfpCodec.name) == 0) {
+		memcpy(&tolerance, &header->codec.parameter, sizeof(float));
+		header->codec.context = zfpCreateContext(tolerance);
+	} else if(strcmp(header->codec.name, xorPlaneCodec.name) == 0 && header->codec.parameter == 0) {
+		if(header->nx == 0 || header->ny == 0) {
+			fprintf(stderr, "%s needs the field shape, give it with -d\n", header->codec.name);
+			return 0;
+		}
+		header->codec.parameter = (size_t) header->nx * header->ny;
+	}
+	return 1;
+}
+
+static void releaseCodec(struct fieldStreamHeader *header) {
+	if(header->codec.context != NULL && strcmp(header->codec.name, zfpCodec.name) == 0) {
+		zfpFreeContext(header->codec.context);
+	}
+}
+
+/*
+ * Purpose:
+ *		Open a field stream and read its header, setting up its codec
+ * Returns:
+ *		The file, or NULL (with a message) if it isnt a field stream this build can read
+ */
+static FILE *openFieldStream(const char *path, struct fieldStreamHeader *header) {
+	FILE *file = openFile(path, "rb");
+
+	if(file == NULL) {
+		return NULL;
+	}
+	if(!readFieldStreamHeader(file, header)) {
+		fprintf(stderr, "%s isnt a field stream this build can read\n", path ? path : "input");
+		closeFile(file);
+		return NULL;
+	}
+	if(!prepareCodec(header)) {
+		closeFile(file);
+		return NULL;
+	}
+	return file;
+}
+
+/*
+ * Purpose:
+ *		Compress values from a file or stdin into a field stream
+ */
+static int compressCommand(int argc, char *argv[]) {
+	struct fieldStreamHeader header = {.nx = 0};
+	struct fieldDescriptor field;
+	struct valueReader reader = {.format = FORMAT_FLOAT32};
+	const struct codec *codec = findCodec("XOR Predictive (previous value)");
+	unsigned int magBits = 0, precBits = 0, blockValues = FIELD_STREAM_BLOCK, count;
+	float tolerance = 0.0f;
+	size_t bytes, totalBytes = 0, totalValues = 0, blocks = 0;
+	float *values;
+	FILE *out;
+	clock_t startTime;
+	int option, status = 0;
+
+	while((option = getopt(argc, argv, "c:m:p:a:i:d:b:")) != -1) {
+		switch(option) {
+			case 'c':
+				codec = findCodec(optarg);
+				if(codec == NULL) {
+					fprintf(stderr, "no codec named %s, see compressor_cli list\n", optarg);
+					return 1;
+				}
+				break;
+			case 'm':
+				magBits = atoi(optarg);
+				break;
+			case 'p':
+				precBits = atoi(optarg);
+				break;
+			case 'a':
+				tolerance = atof(optarg);
+				break;
+			case 'i':
+				if(!parseFormat(optarg, &reader.format)) {
+					usage();
+					return 1;
+				}
+				break;
+			case 'd':
+				if(sscanf(optarg, "%u,%u,%u", &header.nx, &header.ny, &header.nz) != 3) {
+					usage();
+					return 1;
+				}
+				break;
+			case 'b':
+				blockValues = atoi(optarg);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	header.codec = *codec;
+	if((magBits || precBits) && !setCodecWidths(&header.codec, magBits ? magBits : codec->magBits, precBits ? precBits : codec->precBits)) {
+		fprintf(stderr, "%s cant use %u magnitude and %u precision bits\n", codec->name, magBits, precBits);
+		return 1;
+	}
+	if(codec == &zfpCodec) {
+		memcpy(&header.codec.parameter, &tolerance, sizeof(float));
+	}
+	if(header.nx == 0 && optind < argc && strcmp(argv[optind], "-") != 0 && getFieldDescriptor(argv[optind], &field)) {
+		header.nx = field.nx;
+		header.ny = field.ny;
+		header.nz = field.nz;
+	}
+	if(header.nx != 0 && header.ny != 0 && blockValues >= (size_t) header.nx * header.ny) { //whole planes, so zfp and the plane predictor see the shape
+		blockValues -= blockValues % ((size_t) header.nx * header.ny);
+	}
+	if(blockValues == 0 || blockValues > FIELD_STREAM_MAX_BLOCK) {
+		fprintf(stderr, "block size must be 1 to %u values\n", FIELD_STREAM_MAX_BLOCK);
+		return 1;
+	}
+	if(!prepareCodec(&header)) {
+		return 1;
+	}
+
+	reader.file = openFile(optind < argc ? argv[optind] : NULL, "rb");
+	out = openFile(optind + 1 < argc ? argv[optind + 1] : NULL, "wb");
+	values = malloc((size_t) blockValues * sizeof(float));
+	reader.doubles = reader.format == FORMAT_FLOAT64 ? malloc((size_t) blockValues * sizeof(double)) : NULL;
+	if(reader.file == NULL || out == NULL || !writeFieldStreamHeader(out, &header)) {
+		status = 1;
+	}
+	startTime = clock();
+	while(status == 0 && !reader.failed && (count = readValues(&reader, values, blockValues)) > 0) {
+		if(!writeFieldStreamBlock(out, &header.codec, values, count, &bytes)) {
+			fprintf(stderr, "couldnt write the output\n");
+			status = 1;
+		}
+		totalValues += count;
+		totalBytes += bytes;
+		blocks++;
+	}
+	if(reader.failed) {
+		status = 1;
+	}
+	if(status == 0 && !writeFieldStreamEnd(out)) {
+		fprintf(stderr, "couldnt write the output\n");
+		status = 1;
+	}
+	if(status == 0) {
+		fprintf(stderr, "%s: %zu values in %zu blocks, %zu bytes -> %zu bytes (ratio %.3f), %.1f MB/s\n", header.codec.name, totalValues, blocks,
+			totalValues * sizeof(float), totalBytes, totalBytes ? (double) totalValues * sizeof(float) / totalBytes : 0.0,
+			totalValues * sizeof(float) / 1e6 / ((double) (clock() - startTime) / CLOCKS_PER_SEC + 1e-9));
+	}
+	free(values);
+	free(reader.doubles);
+	releaseCodec(&header);
+	closeFile(reader.file);
+	closeFile(out);
+	return status;
+}
+
+/*
+ * Purpose:
+ *		Decompress a field stream back to values
+ */
+static int decompressCommand(int argc, char *argv[]) {
+	struct fieldStreamHeader header;
+	enum valueFormat format = FORMAT_FLOAT32;
+	unsigned char *compressed;
+	unsigned int count;
+	size_t bytes;
+	float *values;
+	FILE *in, *out;
+	int option, status = 0, result;
+
+	while((option = getopt(argc, argv, "o:")) != -1) {
+		if(option != 'o' || !parseFormat(optarg, &format)) {
+			usage();
+			return 1;
+		}
+	}
+	in = openFieldStream(optind < argc ? argv[optind] : NULL, &header);
+	if(in == NULL) {
+		return 1;
+	}
+	out = openFile(optind + 1 < argc ? argv[optind + 1] : NULL, "wb");
+	if(out == NULL) {
+		status = 1;
+	}
+	while(status == 0 && (result = readFieldStreamBlock(in, &header.codec, &compressed, &count, &bytes)) == 1) {
+		values = header.codec.decompress(&header.codec, compressed, bytes, count);
+		if(values == NULL) { //the block doesnt decode to count values
+			free(compressed);
+			result = -1;
+			break;
+		}
+		if(!writeValues(out, format, values, count)) {
+			fprintf(stderr, "couldnt write the output\n");
+			status = 1;
+		}
+		free(values);
+		free(compressed);
+	}
+	if(status == 0 && result != 0) {
+		fprintf(stderr, "field stream is cut short or damaged\n");
+		status = 1;
+	}
+	releaseCodec(&header);
+	closeFile(in);
+	closeFile(out);
+	return status;
+}
+
+/*
+ * Purpose:
+ *		Print the header of a field stream and statistics of its blocks and values
+ */
+static int inspectCommand(int argc, char *argv[]) {
+	struct fieldStreamHeader header;
+	unsigned char *compressed;
+	unsigned int count, i;
+	size_t bytes, blocks = 0, totalValues = 0, totalBytes = 0;
+	float *values, minVal = FLT_MAX, maxVal = -FLT_MAX;
+	double total = 0.0;
+	FILE *in;
+	int option, verbose = 0, result;
+
+	while((option = getopt(argc, argv, "v")) != -1) {
+		if(option != 'v') {
+			usage();
+			return 1;
+		}
+		verbose = 1;
+	}
+	in = openFieldStream(optind < argc ? argv[optind] : NULL, &header);
+	if(in == NULL) {
+		return 1;
+	}
+	printf("Codec: %s (%s)\n", header.codec.name, header.codec.lossless ? "lossless" : "lossy");
+	if(header.codec.magBits || header.codec.precBits) {
+		printf("Magnitude bits: %u, precision bits: %u\n", header.codec.magBits, header.codec.precBits);
+	}
+	if(header.nx) {
+		printf("Dimensions: %u x %u x %u\n", header.nx, header.ny, header.nz);
+	}
+	while((result = readFieldStreamBlock(in, &header.codec, &compressed, &count, &bytes)) == 1) {
+		values = header.codec.decompress(&header.codec, compressed, bytes, count);
+		if(values == NULL) { //the block doesnt decode to count values
+			free(compressed);
+			result = -1;
+			break;
+		}
+		for(i = 0; i < count; i++) {
+			minVal = fminf(minVal, values[i]);
+			maxVal = fmaxf(maxVal, values[i]);
+			total += values[i];
+		}
+		if(verbose) {
+			printf("\tBlock %zu: %u values, %zu bytes\n", blocks, count, bytes);
+		}
+		blocks++;
+		totalValues += count;
+		totalBytes += bytes;
+		free(values);
+		free(compressed);
+	}
+	printf("Blocks: %zu, values: %zu, compressed size: %zu bytes, ratio %.3f, %.2f bits per value\n", blocks, totalValues, totalBytes,
+		totalBytes ? (double) totalValues * sizeof(float) / totalBytes : 0.0, totalValues ? 8.0 * totalBytes / totalValues : 0.0);
+	if(totalValues) {
+		printf("Max value: %f, Min value: %f, Average value: %f\n", maxVal, minVal, total / totalValues);
+	}
+	if(header.nx && totalValues != (size_t) header.nx * header.ny * header.nz) {
+		printf("Value count doesnt match the dimensions\n");
+	}
+	releaseCodec(&header);
+	closeFile(in);
+	if(result != 0) {
+		fprintf(stderr, "field stream is cut short or damaged\n");
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Purpose:
+ *		Decompress a field stream alongside the values it was made from and check the error. Lossless codecs must give the original bits
+ *		back, lossy ones are held to -e when it is given.
+ * Returns:
+ *		0 if the stream matches, 1 otherwise
+ */
+static int verifyCommand(int argc, char *argv[]) {
+	struct fieldStreamHeader header;
+	struct valueReader reader = {.format = FORMAT_FLOAT32};
+	unsigned char *compressed;
+	unsigned int count, i;
+	size_t bytes, totalValues = 0, bitMismatches = 0, worstIndex = 0;
+	float *values, *original = NULL;
+	double maxError = 0.0, squaredError = 0.0, bound = -1.0, error;
+	FILE *in;
+	int option, status = 0, result;
+
+	while((option = getopt(argc, argv, "e:i:")) != -1) {
+		if(option == 'e') {
+			bound = atof(optarg);
+		} else if(option != 'i' || !parseFormat(optarg, &reader.format)) {
+			usage();
+			return 1;
+		}
+	}
+	if(argc - optind != 2 || (strcmp(argv[optind], "-") == 0 && strcmp(argv[optind + 1], "-") == 0)) {
+		usage();
+		return 1;
+	}
+	reader.file = openFile(argv[optind], "rb");
+	in = openFieldStream(argv[optind + 1], &header);
+	if(reader.file == NULL || in == NULL) {
+		closeFile(reader.file);
+		return 1;
+	}
+	while(status == 0 && (result = readFieldStreamBlock(in, &header.codec, &compressed, &count, &bytes)) == 1) {
+		original = realloc(original, (size_t) count * sizeof(float)); //blocks are all the same size apart from the last
+		free(reader.doubles);
+		reader.doubles = reader.format == FORMAT_FLOAT64 ? malloc((size_t) count * sizeof(double)) : NULL;
+		values = header.codec.decompress(&header.codec, compressed, bytes, count);
+		if(values == NULL) { //the block doesnt decode to count values
+			free(compressed);
+			result = -1;
+			break;
+		}
+		if(readValues(&reader, original, count) != count) {
+			if(!reader.failed) {
+				fprintf(stderr, "original has fewer values than the field stream\n");
+			}
+			status = 1;
+		}
+		for(i = 0; i < count && status == 0; i++) {
+			error = fabs((double) values[i] - original[i]);
+			if(memcmp(&values[i], &original[i], sizeof(float)) != 0) {
+				bitMismatches++;
+			}
+			if(error > maxError || isnan(error)) {
+				maxError = error;
+				worstIndex = totalValues + i;
+			}
+			squaredError += error * error;
+		}
+		totalValues += count;
+		free(values);
+		free(compressed);
+	}
+	if(status == 0 && result != 0) {
+		fprintf(stderr, "field stream is cut short or damaged\n");
+		status = 1;
+	}
+	if(status == 0 && (readValues(&reader, original ? original : (float *) &error, 1) != 0 || reader.failed)) {
+		if(!reader.failed) {
+			fprintf(stderr, "original has more values than the field stream\n");
+		}
+		status = 1;
+	}
+	if(status == 0) {
+		printf("%s: %zu values, max error %g (value %zu), RMS error %g, %zu values not bit identical\n", header.codec.name, totalValues, maxError,
+			worstIndex, totalValues ? sqrt(squaredError / totalValues) : 0.0, bitMismatches);
+		if(header.codec.lossless && bound < 0.0 && bitMismatches > 0) {
+			printf("FAILED: lossless codec didnt give the original values back\n");
+			status = 1;
+		} else if(bound >= 0.0 && !(maxError <= bound)) {
+			printf("FAILED: max error is above %g\n", bound);
+			status = 1;
+		} else {
+			printf("OK\n");
+		}
+	}
+	free(original);
+	free(reader.doubles);
+	releaseCodec(&header);
+	closeFile(reader.file);
+	closeFile(in);
+	return status;
+}
+
+/*
+ * Purpose:
+ *		List the codecs a field stream can use
+ */
+static int listCommand(void) {
+	const struct codec *codec;
+	unsigned int c;
+
+	for(c = 0; c < getCodecCount(); c++) {
+		codec = getCodec(c);
+		printf("%s (%s", codec->name, codec->lossless ? "lossless" : "lossy");
+		if(codec->magBits || codec->precBits) {
+			printf(", %u magnitude bits, %u precision bits", codec->magBits, codec->precBits);
+		}
+		printf(")\n");
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	if(argc < 2) {
+		usage();
+		return 1;
+	}
+	registerToolCodecs();
+	optind = 2; //options follow the command
+	if(strcmp(argv[1], "compress") == 0) {
+		return compressCommand(argc, argv);
+	} else if(strcmp(argv[1], "decompress") == 0) {
+		return decompressCommand(argc, argv);
+	} else if(strcmp(argv[1], "inspect") == 0) {
+		return inspectCommand(argc, argv);
+	} else if(strcmp(argv[1], "verify") == 0) {
+		return verifyCommand(argc, argv);
+	} else if(strcmp(argv[1], "list") == 0) {
+		return listCommand();
+	}
+	usage();
+	return 1;
+}
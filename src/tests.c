@@ -4,9 +4,11 @@
  
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "minunit.h"
 #include "compressor.h"
 #include <math.h>
+#include <float.h>
 
 /*
  * Purpose:
@@ -47,12 +49,12 @@ MU_TEST(testGetData) {
 MU_TEST(testGetRunlengthCompressedDataset) {
 	//dataset for a situation where there's no improvement in compression
 	char *file = "../data/test_datasets/runlength/runlength_0_compression.txt";
-	int uncompressedCount = 0;
+	unsigned int uncompressedCount = 0;
 	float junk = 0.0;
 	float *uncompressedData = getData(file, &uncompressedCount, &junk, &junk, &junk);
-	int compressedCount = 0;
-	struct runlengthEntry *compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
-	mu_assert(uncompressedCount == compressedCount, "ERROR in testGetRunlengthCompressedData: 0 compression example isn't working as expected");
+	unsigned int compressedCount = 0;
+	unsigned char *compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
+	mu_assert(compressedCount <= uncompressedCount*sizeof(float) + RUNLENGTH_MAX_OVERHEAD, "ERROR in testGetRunlengthCompressedData: 0 compression example isn't working as expected");
 	free(uncompressedData);
 	free(compressedData);
 
@@ -62,7 +64,7 @@ MU_TEST(testGetRunlengthCompressedDataset) {
 	uncompressedData = getData(file, &uncompressedCount, &junk, &junk, &junk);
 	compressedCount = 0;
 	compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
-	mu_assert(compressedCount == (uncompressedCount/2), "ERROR in testGetRunlengthCompressedData: 50% compression example isn't working as expected");
+	mu_assert(compressedCount <= (uncompressedCount/2)*(1+sizeof(float)) + 5, "ERROR in testGetRunlengthCompressedData: 50% compression example isn't working as expected"); //each pair is a 1 byte run header and the value
 	free(uncompressedData);
 	free(compressedData);
 
@@ -72,7 +74,7 @@ MU_TEST(testGetRunlengthCompressedDataset) {
 	uncompressedData = getData(file, &uncompressedCount, &junk, &junk, &junk);
 	compressedCount = 0;
 	compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
-	mu_assert(compressedCount == 1, "ERROR in testGetRunlengthCompressedData: 100% compression example isn't working as expected");
+	mu_assert(compressedCount <= 2*5 + sizeof(float), "ERROR in testGetRunlengthCompressedData: 100% compression example isn't working as expected"); //count header, 1 run span
 	free(uncompressedData);
 	free(compressedData);
 }
@@ -89,7 +91,7 @@ MU_TEST(testGetRunlengthDecompressedDataset) {
 	float *uncompressedData = getData(file, &uncompressedCount, &junk, &junk, &junk);
 
 	int compressedCount = 0;
-	struct runlengthEntry *compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
+	unsigned char *compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
 
 	int decompressedCount = 0;
 	float *decompressedData = getRunlengthDecompressedData(compressedData, compressedCount, &decompressedCount);
@@ -670,6 +672,1034 @@ MU_TEST(testInsertSingleVariableBitValueAndCompress) {
 	free(compressedData);
 }
 
+/*
+ * Purpose:
+ *		Test that the vectorised bulk 24 bit decompression gives exactly the same floats as decompressing each value individually (covers the SIMD body and scalar tail)
+ */
+MU_TEST(testGet24BitDecompressedMatchesSingle) {
+	float uncompressedData[19] = {31.15115, -2.5, 0.0, 17.00001, -31.99999, 1.5, 3.25, -0.125, 12.34567, 8.0, -9.87654, 0.00001, 25.5, -16.75, 4.44444, 30.0, -1.0, 2.71828, -3.14159};
+	unsigned int uncompressedCount = 19;
+	struct compressedVal *compressedData = get24BitCompressedData(uncompressedData, uncompressedCount, 5, 18);
+	float *decompressedData = get24BitDecompressedData(compressedData, uncompressedCount, 5, 18);
+	unsigned int i;
+
+	for(i = 0; i < uncompressedCount; i++) {
+		mu_assert(decompressedData[i] == getSingle24BitValue(compressedData, i, 5, 18), "ERROR in testGet24BitDecompressedMatchesSingle (1-5-18): bulk and individual decompression dont match");
+		mu_assert(0.00001 > fabs(uncompressedData[i] - decompressedData[i]), "ERROR in testGet24BitDecompressedMatchesSingle (1-5-18): decompressed value too far from original");
+	}
+	free(compressedData);
+	free(decompressedData);
+}
+
+/*
+ * Purpose:
+ *		Test that the byte aligned codec family (8/16/24/32 bit records) decompresses, retrieves and inserts values as expected
+ */
+MU_TEST(testAlignedBitCompressAndDecompress) {
+	float values8[5] = {3.5, -2.1, 0.0, 15.7, -7.3};
+	float values16[5] = {31.151, -2.5, 0.001, 17.999, -9.876};
+	float values32[5] = {1000.125, -2.5, 0.000001, 1023.5, -512.25};
+	unsigned int count = 5;
+	unsigned int i;
+
+	//1-4-3 in 8 bits, precision is a single decimal digit
+	unsigned char *compressedData = getAligned8BitCompressedData(values8, count, 4, 3);
+	float *decompressedData = getAligned8BitDecompressedData(compressedData, count, 4, 3);
+	for(i = 0; i < count; i++) {
+		mu_assert(0.001 > fabs(values8[i] - decompressedData[i]), "ERROR in testAlignedBitCompressAndDecompress (1-4-3): decompressed values dont match");
+		mu_assert(decompressedData[i] == getSingleAligned8BitValue(compressedData, i, 4, 3), "ERROR in testAlignedBitCompressAndDecompress (1-4-3): individual value doesnt match");
+	}
+	insertSingleAligned8BitValue(compressedData, values8[0], 4, 4, 3);
+	mu_assert(compressedData[0] == compressedData[4], "ERROR in testAlignedBitCompressAndDecompress (1-4-3): inserted record doesnt match");
+	free(compressedData);
+	free(decompressedData);
+
+	//digits above what 3 precision bits hold saturate at .7 rather than wrapping, 1-3-4 holds every digit
+	values8[0] = 1.8;
+	values8[1] = 2.9;
+	values8[2] = -3.85;
+	compressedData = getAligned8BitCompressedData(values8, 3, 4, 3);
+	mu_assert(getSingleAligned8BitValue(compressedData, 0, 4, 3) == 1.7f && getSingleAligned8BitValue(compressedData, 1, 4, 3) == 2.7f, "ERROR in testAlignedBitCompressAndDecompress (1-4-3): precision wrapped");
+	free(compressedData);
+	compressedData = getAligned8BitCompressedData(values8, 3, 3, 4);
+	for(i = 0; i < 3; i++) {
+		mu_assert(0.051 > fabs(values8[i] - getSingleAligned8BitValue(compressedData, i, 3, 4)), "ERROR in testAlignedBitCompressAndDecompress (1-3-4): decimal digit was lost");
+	}
+	free(compressedData);
+
+	//1-5-10 in 16 bits
+	compressedData = getAligned16BitCompressedData(values16, count, 5, 10);
+	decompressedData = getAligned16BitDecompressedData(compressedData, count, 5, 10);
+	for(i = 0; i < count; i++) {
+		mu_assert(0.0001 > fabs(values16[i] - decompressedData[i]), "ERROR in testAlignedBitCompressAndDecompress (1-5-10): decompressed values dont match");
+		mu_assert(decompressedData[i] == getSingleAligned16BitValue(compressedData, i, 5, 10), "ERROR in testAlignedBitCompressAndDecompress (1-5-10): individual value doesnt match");
+	}
+	insertSingleAligned16BitValue(compressedData, values16[1], 0, 5, 10);
+	mu_assert(values16[1] == getSingleAligned16BitValue(compressedData, 0, 5, 10), "ERROR in testAlignedBitCompressAndDecompress (1-5-10): inserted value doesnt match");
+	mu_assert(decompressedData[2] == getSingleAligned16BitValue(compressedData, 2, 5, 10), "ERROR in testAlignedBitCompressAndDecompress (1-5-10): insert changed a neighbouring value");
+	free(compressedData);
+	free(decompressedData);
+
+	//1-10-21 in 32 bits
+	compressedData = getAligned32BitCompressedData(values32, count, 10, 21);
+	decompressedData = getAligned32BitDecompressedData(compressedData, count, 10, 21);
+	for(i = 0; i < count; i++) {
+		mu_assert(0.0001 > fabs(values32[i] - decompressedData[i]), "ERROR in testAlignedBitCompressAndDecompress (1-10-21): decompressed values dont match");
+		mu_assert(decompressedData[i] == getSingleAligned32BitValue(compressedData, i, 10, 21), "ERROR in testAlignedBitCompressAndDecompress (1-10-21): individual value doesnt match");
+	}
+	free(compressedData);
+	free(decompressedData);
+
+	//1-5-18 in 24 bits should match the original 24 bit format
+	compressedData = getAligned24BitCompressedData(values16, count, 5, 18);
+	struct compressedVal *compressed24 = get24BitCompressedData(values16, count, 5, 18);
+	for(i = 0; i < count; i++) {
+		mu_assert(getSingle24BitValue(compressed24, i, 5, 18) == getSingleAligned24BitValue(compressedData, i, 5, 18), "ERROR in testAlignedBitCompressAndDecompress (1-5-18): doesnt match the 24 bit format");
+	}
+	free(compressedData);
+	free(compressed24);
+}
+
+/*
+ * Purpose:
+ *		Test that fixed point values read from and written to 24 bit compressed data match the float path, and that the arithmetic rounds as expected
+ */
+MU_TEST(testFixedPoint24BitArithmetic) {
+	float uncompressedData[5] = {31.15115, -2.5, 0.0, 17.00001, -31.99999};
+	unsigned int uncompressedCount = 5;
+	struct compressedVal *compressedData = get24BitCompressedData(uncompressedData, uncompressedCount, 5, 18);
+	struct compressedVal *floatInserted = get24BitCompressedData(uncompressedData, uncompressedCount, 5, 18);
+	unsigned int i;
+
+	for(i = 0; i < uncompressedCount; i++) {
+		mu_assert(fixedPointToFloat(getSingle24BitFixedValue(compressedData, i, 5, 18), 18) == getSingle24BitValue(compressedData, i, 5, 18), "ERROR in testFixedPoint24BitArithmetic (1-5-18): fixed point value doesnt match decompressed value");
+	}
+	mu_assert(getSingle24BitFixedValue(compressedData, 0, 5, 18) == 3115115, "ERROR in testFixedPoint24BitArithmetic (1-5-18): unexpected fixed point value");
+	mu_assert(getSingle24BitFixedValue(compressedData, 1, 5, 18) == -250000, "ERROR in testFixedPoint24BitArithmetic (1-5-18): unexpected fixed point value");
+
+	//inserting in fixed point should give the same bytes as inserting the float
+	insertSingle24BitValue(floatInserted, 12.34567, 2, 5, 18);
+	insertSingle24BitFixedValue(compressedData, floatToFixedPoint(12.34567, 18), 2, 5, 18);
+	mu_assert(floatInserted[2].data[2] == compressedData[2].data[2], "ERROR in testFixedPoint24BitArithmetic (1-5-18): fixed point insert doesnt match float insert");
+	mu_assert(floatInserted[2].data[1] == compressedData[2].data[1], "ERROR in testFixedPoint24BitArithmetic (1-5-18): fixed point insert doesnt match float insert");
+	mu_assert(floatInserted[2].data[0] == compressedData[2].data[0], "ERROR in testFixedPoint24BitArithmetic (1-5-18): fixed point insert doesnt match float insert");
+	insertSingle24BitFixedValue(compressedData, getSingle24BitFixedValue(compressedData, 1, 5, 18), 3, 5, 18);
+	mu_assert(getSingle24BitValue(compressedData, 3, 5, 18) == -2.5, "ERROR in testFixedPoint24BitArithmetic (1-5-18): negative fixed point insert not working");
+	insertSingle24BitFixedValue(compressedData, fixedPointAdd(3115115, 3115115), 4, 5, 18); //62.3023 is past 5 magnitude bits, 62 wraps to 30
+	mu_assert(getSingle24BitFixedValue(compressedData, 4, 5, 18) == 30*100000 + 30230 && getSingle24BitFixedValue(compressedData, 3, 5, 18) == -250000,
+		"ERROR in testFixedPoint24BitArithmetic (1-5-18): out of range magnitude didnt wrap in its own field");
+	insertSingle24BitFixedValue(compressedData, floatToFixedPoint(-12.5, 15), 4, 8, 15); //precision isnt in the RHS bits, goes through float
+	insertSingle24BitValue(floatInserted, -12.5, 4, 8, 15);
+	mu_assert(memcmp(compressedData[4].data, floatInserted[4].data, 3) == 0, "ERROR in testFixedPoint24BitArithmetic (1-8-15): fixed point insert doesnt match float insert");
+
+	int32_t neighbours[3] = {100000, 200000, 300001};
+	mu_assert(fixedPointAverage(neighbours, 3) == 200000, "ERROR in testFixedPoint24BitArithmetic: average not rounded as expected");
+	mu_assert(fixedPointAverage(neighbours, 2) == 150000, "ERROR in testFixedPoint24BitArithmetic: average not as expected");
+	mu_assert(fixedPointAdd(-250000, 100000) == -150000, "ERROR in testFixedPoint24BitArithmetic: add not as expected");
+	mu_assert(fixedPointScale(-250001, 1, 2) == -125001, "ERROR in testFixedPoint24BitArithmetic: scale not rounded away from zero");
+	free(compressedData);
+	free(floatInserted);
+}
+
+/*
+ * Purpose:
+ *		Test that runlength compression mixes literal and run spans, never grows past the raw size plus RUNLENGTH_MAX_OVERHEAD and can be decompressed more than once
+ */
+MU_TEST(testRunlengthLiteralAndRunSpans) {
+	float uncompressedData[12] = {1.5, 2.5, 2.5, 2.5, 2.5, -3.0, 4.0, 0.0, -0.0, 7.25, 7.25, 7.25};
+	unsigned int uncompressedCount = 12;
+	unsigned int compressedCount = 0;
+	unsigned int decompressedCount = 0;
+	unsigned char *compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
+	float *decompressedData;
+	unsigned int i;
+	int rep;
+
+	//count header (1) + literal 1 (1+4) + run (1+4) + literal 4 (1+16) + run (1+4)
+	mu_assert(compressedCount == 33, "ERROR in testRunlengthLiteralAndRunSpans: unexpected compressed size");
+	for(rep = 0; rep < 2; rep++) {
+		decompressedData = getRunlengthDecompressedData(compressedData, compressedCount, &decompressedCount);
+		mu_assert(decompressedCount == uncompressedCount, "ERROR in testRunlengthLiteralAndRunSpans: decompressed count doesnt match");
+		for(i = 0; i < uncompressedCount; i++) {
+			mu_assert(memcmp(&uncompressedData[i], &decompressedData[i], sizeof(float)) == 0, "ERROR in testRunlengthLiteralAndRunSpans: decompressed values arent bit exact");
+		}
+		free(decompressedData);
+	}
+
+	//cut short streams and value counts that dont match the spans must be rejected
+	for(i = 0; i < compressedCount; i++) {
+		mu_assert(getRunlengthDecompressedData(compressedData, i, &decompressedCount) == NULL, "ERROR in testRunlengthLiteralAndRunSpans: truncated stream wasnt rejected");
+	}
+	for(rep = -1; rep <= 1; rep += 2) {
+		compressedData[0] = uncompressedCount + rep;
+		mu_assert(getRunlengthDecompressedData(compressedData, compressedCount, &decompressedCount) == NULL, "ERROR in testRunlengthLiteralAndRunSpans: wrong value count wasnt rejected");
+	}
+	compressedData[0] = uncompressedCount;
+	mu_assert(findCodec("Runlength")->decompress(findCodec("Runlength"), compressedData, compressedCount, uncompressedCount - 1) == NULL, "ERROR in testRunlengthLiteralAndRunSpans: codec didnt reject a block with a different value count");
+	free(compressedData);
+}
+
+/*
+ * Purpose:
+ *		Test runlength compression of a large array where runs end at every position within a vector and the output is big enough to be decompressed in parallel
+ */
+MU_TEST(testRunlengthLargeMixedRuns) {
+	unsigned int uncompressedCount = 3*RUNLENGTH_PARALLEL_MIN + 7;
+	unsigned int compressedCount = 0;
+	unsigned int decompressedCount = 0;
+	float *uncompressedData = malloc(uncompressedCount*sizeof(float));
+	unsigned char *compressedData;
+	float *decompressedData;
+	unsigned int i = 0, runLength = 1, j;
+
+	while(i < uncompressedCount) { //run lengths 1 to 40, each followed by a distinct value
+		for(j = 0; j < runLength && i < uncompressedCount; j++) {
+			uncompressedData[i++] = runLength * 0.5f;
+		}
+		if(i < uncompressedCount) {
+			uncompressedData[i] = -(float) i;
+			i++;
+		}
+		runLength = runLength % 40 + 1;
+	}
+	compressedData = getRunlengthCompressedData(uncompressedData, uncompressedCount, &compressedCount);
+	mu_assert(compressedCount < uncompressedCount*sizeof(float), "ERROR in testRunlengthLargeMixedRuns: runs didnt make the data smaller");
+	decompressedData = getRunlengthDecompressedData(compressedData, compressedCount, &decompressedCount);
+	mu_assert(decompressedCount == uncompressedCount, "ERROR in testRunlengthLargeMixedRuns: decompressed count doesnt match");
+	mu_assert(memcmp(uncompressedData, decompressedData, uncompressedCount*sizeof(float)) == 0, "ERROR in testRunlengthLargeMixedRuns: decompressed values dont match");
+	free(uncompressedData);
+	free(compressedData);
+	free(decompressedData);
+}
+
+/*
+ * Purpose:
+ *		Test that XOR predictive compression is bit exact for awkward values with both the previous value and a grid neighbour as the prediction
+ */
+MU_TEST(testXorPredictiveCompressAndDecompress) {
+	float uncompressedData[16] = {0.0, -0.0, 1.0, 1.0, 1.0000001, -2.5, NAN, INFINITY, -INFINITY, FLT_MIN/4, FLT_MAX, 3.14159, 3.14159, 3.1416, 100.25, 100.5};
+	unsigned int uncompressedCount = 16;
+	unsigned int strides[3] = {1, 4, 16};
+	unsigned int compressedCount = 0;
+	unsigned int decompressedCount = 0;
+	unsigned char *compressedData;
+	float *decompressedData;
+	int s;
+
+	for(s = 0; s < 3; s++) {
+		compressedData = getXorPredictiveCompressedData(uncompressedData, uncompressedCount, &compressedCount, strides[s]);
+		mu_assert(compressedCount <= 2 + (uncompressedCount*44 + 7)/8, "ERROR in testXorPredictiveCompressAndDecompress: compressed size is bigger than the worst case");
+		decompressedData = getXorPredictiveDecompressedData(compressedData, compressedCount, &decompressedCount);
+		mu_assert(decompressedCount == uncompressedCount, "ERROR in testXorPredictiveCompressAndDecompress: decompressed count doesnt match");
+		mu_assert(memcmp(uncompressedData, decompressedData, uncompressedCount*sizeof(float)) == 0, "ERROR in testXorPredictiveCompressAndDecompress: decompressed values arent bit exact");
+		free(compressedData);
+		free(decompressedData);
+	}
+
+	float constantData[64];
+	for(s = 0; s < 64; s++) {
+		constantData[s] = 42.75;
+	}
+	compressedData = getXorPredictiveCompressedData(constantData, 64, &compressedCount, 1);
+	mu_assert(compressedCount <= 2 + (44 + 63 + 7)/8, "ERROR in testXorPredictiveCompressAndDecompress: repeated values should take 1 bit each");
+	free(compressedData);
+
+	//cut short or damaged streams must be rejected rather than read past the end
+	compressedData = getXorPredictiveCompressedData(uncompressedData, uncompressedCount, &compressedCount, 1);
+	for(s = 0; s < (int) compressedCount; s++) {
+		mu_assert(getXorPredictiveDecompressedData(compressedData, s, &decompressedCount) == NULL, "ERROR in testXorPredictiveCompressAndDecompress: truncated stream wasnt rejected");
+	}
+	compressedData[0] = 0xFF; //value count far bigger than the stream can hold
+	compressedData[1] = 0x7F;
+	mu_assert(getXorPredictiveDecompressedData(compressedData, compressedCount, &decompressedCount) == NULL, "ERROR in testXorPredictiveCompressAndDecompress: oversized value count wasnt rejected");
+	free(compressedData);
+}
+
+/*
+ * Purpose:
+ *		Test that field dimensions are read from a sidecar .dims file or the data file's header line, and that getData skips the header
+ */
+MU_TEST(testGetFieldDescriptor) {
+	char *dataFile = "field_descriptor_test.txt.clean";
+	char *sidecarFile = "field_descriptor_test.dims";
+	struct fieldDescriptor field;
+	unsigned int count;
+	float junk;
+	float *contents;
+	FILE *file;
+
+	file = fopen(dataFile, "w");
+	fprintf(file, "# 3 2 2\n1.5\n2.5\n3.5\n4.5\n5.5\n6.5\n7.5\n8.5\n9.5\n10.5\n11.5\n12.5\n");
+	fclose(file);
+	mu_assert(getFieldDescriptor(dataFile, &field) == 1, "ERROR in testGetFieldDescriptor: header line wasnt found");
+	mu_assert(field.nx == 3 && field.ny == 2 && field.nz == 2 && field.type == FIELD_FLOAT32, "ERROR in testGetFieldDescriptor: header line dimensions dont match");
+	mu_assert(getFieldIndex(&field, 2, 1, 1) == 11, "ERROR in testGetFieldDescriptor: strides dont match a contiguous field");
+	contents = getData(dataFile, &count, &junk, &junk, &junk);
+	mu_assert(count == 12 && contents[0] == 1.5f, "ERROR in testGetFieldDescriptor: getData didnt skip the header line");
+	free(contents);
+
+	file = fopen(sidecarFile, "w");
+	fprintf(file, "6 2 1 float64\n");
+	fclose(file);
+	mu_assert(getFieldDescriptor(dataFile, &field) == 1, "ERROR in testGetFieldDescriptor: sidecar wasnt found");
+	mu_assert(field.nx == 6 && field.ny == 2 && field.nz == 1 && field.type == FIELD_FLOAT64, "ERROR in testGetFieldDescriptor: sidecar should take priority over the header line");
+	file = fopen(dataFile, "w");
+	fprintf(file, "1.00000005960464477539153\n"); //rounds up when read straight into a float, to exactly 1.0 through a double
+	fclose(file);
+	contents = getData(dataFile, &count, &junk, &junk, &junk);
+	mu_assert(count == 1 && contents[0] == 1.0f, "ERROR in testGetFieldDescriptor: float64 values should be read as doubles then narrowed");
+	free(contents);
+	remove(sidecarFile);
+
+	file = fopen(dataFile, "w");
+	fprintf(file, "1.5\n2.5\n");
+	fclose(file);
+	mu_assert(getFieldDescriptor(dataFile, &field) == 0, "ERROR in testGetFieldDescriptor: file without a header shouldnt have a descriptor");
+	remove(dataFile);
+}
+
+/*
+ * Purpose:
+ *		Test that every storage layout gives each point of a field its own slot and that getLayoutData puts values in those slots
+ */
+MU_TEST(testFieldLayouts) {
+	struct fieldDescriptor field = getContiguousField(19, 10, 5); //not a whole number of bricks in any dimension
+	enum fieldLayoutType types[3] = {LAYOUT_LINEAR, LAYOUT_BRICK, LAYOUT_MORTON};
+	struct fieldLayout layout;
+	float values[19*10*5];
+	float *layoutValues;
+	unsigned char *used;
+	unsigned int i, j, k, t;
+	size_t index;
+
+	for(i = 0; i < 19*10*5; i++) {
+		values[i] = i;
+	}
+	for(t = 0; t < 3; t++) {
+		layout = getFieldLayout(&field, types[t]);
+		used = calloc(layout.storageCount, 1);
+		layoutValues = getLayoutData(values, &field, &layout);
+		for(k = 0; k < 5; k++) {
+			for(j = 0; j < 10; j++) {
+				for(i = 0; i < 19; i++) {
+					index = getLayoutIndex(&layout, i, j, k);
+					mu_assert(index < layout.storageCount, "ERROR in testFieldLayouts: index falls outside the storage");
+					mu_assert(used[index] == 0, "ERROR in testFieldLayouts: two points share a slot");
+					used[index] = 1;
+					mu_assert(layoutValues[index] == values[getFieldIndex(&field, i, j, k)], "ERROR in testFieldLayouts: value isnt in its slot");
+				}
+			}
+		}
+		free(used);
+		free(layoutValues);
+		freeFieldLayout(&layout);
+	}
+	layout = getFieldLayout(&field, LAYOUT_MORTON);
+	mu_assert(getLayoutIndex(&layout, 1, 1, 1) == 7 && getLayoutIndex(&layout, 2, 0, 0) == 8, "ERROR in testFieldLayouts: Morton order inside a brick is wrong");
+	freeFieldLayout(&layout);
+}
+
+/*
+ * Purpose:
+ *		Test that writing a variable bit array as a stream gives the same bytes as getVariableBitCompressedData and reading it back gives
+ *		the same values as getSingleVariableBitValue, for record sizes that do and dont line up with bytes
+ */
+MU_TEST(testVariableBitStream) {
+	float uncompressedData[11] = {0.0, 1.25, -2.25, 31.125, -17.0625, 3.3, 0.25, -0.3125, 12.0, 7.1875, -30.25}; //fit every field size below
+	unsigned int magBits[4] = {5, 5, 5, 7};
+	unsigned int precBits[4] = {15, 9, 6, 12};
+	unsigned int compressedCount = 0;
+	unsigned char *compressedData, *streamedData;
+	struct variableBitStream stream;
+	float streamedValues[11];
+	unsigned int f, i;
+
+	for(f = 0; f < 4; f++) {
+		compressedData = getVariableBitCompressedData(uncompressedData, 11, &compressedCount, magBits[f], precBits[f]);
+		streamedData = malloc(compressedCount);
+		memset(streamedData, 0xFF, compressedCount); //every byte must be overwritten
+		startVariableBitStream(&stream, streamedData, compressedCount, magBits[f], precBits[f]);
+		writeVariableBitValues(&stream, uncompressedData, 4);
+		writeVariableBitValues(&stream, uncompressedData + 4, 7);
+		flushVariableBitStream(&stream);
+		mu_assert(memcmp(compressedData, streamedData, compressedCount) == 0, "ERROR in testVariableBitStream: streamed bytes dont match getVariableBitCompressedData");
+
+		startVariableBitStream(&stream, compressedData, compressedCount, magBits[f], precBits[f]);
+		readVariableBitValues(&stream, streamedValues, 11);
+		for(i = 0; i < 11; i++) {
+			mu_assert(streamedValues[i] == getSingleVariableBitValue(compressedData, compressedCount, i, magBits[f], precBits[f]), "ERROR in testVariableBitStream: streamed value doesnt match getSingleVariableBitValue");
+		}
+		free(compressedData);
+		free(streamedData);
+	}
+}
+
+/*
+ * Purpose:
+ *		Test that every registered codec round trips through the codec interface, that random access and batch access agree with
+ *		decompression, and that new codecs can be registered and found by name
+ */
+MU_TEST(testCodecRegistry) {
+	float fractions[4] = {0.0, 0.125, 0.25, 0.3125}; //fit the precision of every built in codec
+	float original[40], replacement[20], expected[40], batch[40];
+	unsigned char *compressed, *expectedCompressed;
+	float *decompressed, *expectedDecompressed;
+	size_t bytes, expectedBytes;
+	const struct codec *codec;
+	static struct codec testCodec;
+	unsigned int c, i;
+
+	for(i = 0; i < 40; i++) {
+		original[i] = (i % 2 ? -1 : 1) * ((i % 15) + fractions[i % 4]);
+		expected[i] = original[i];
+	}
+	for(i = 0; i < 20; i++) {
+		replacement[i] = (i % 3 ? 1 : -1) * ((i*7 % 13) + fractions[(i+1) % 4]);
+		expected[i+5] = replacement[i];
+	}
+	mu_assert(getCodecCount() >= 9 && getCodec(getCodecCount()) == NULL, "ERROR in testCodecRegistry: built in codecs arent registered");
+	for(c = 0; c < getCodecCount(); c++) {
+		codec = getCodec(c);
+		compressed = codec->compress(codec, original, 40, &bytes);
+		mu_assert(codec->compressedSize == NULL || bytes <= codec->compressedSize(codec, 40), "ERROR in testCodecRegistry: compressed size is bigger than the codec says it can be");
+		decompressed = codec->decompress(codec, compressed, bytes, 40);
+		if(codec->lossless) {
+			mu_assert(memcmp(original, decompressed, sizeof(original)) == 0, "ERROR in testCodecRegistry: lossless codec didnt round trip");
+		}
+		if(codec->get) {
+			for(i = 0; i < 40; i++) {
+				mu_assert(codec->get(codec, compressed, bytes, i) == decompressed[i], "ERROR in testCodecRegistry: get doesnt match decompress");
+			}
+			codecGetBatch(codec, compressed, bytes, 3, 30, batch);
+			mu_assert(memcmp(batch, decompressed + 3, 30*sizeof(float)) == 0, "ERROR in testCodecRegistry: batch get doesnt match decompress");
+		}
+		if(codec->set && codec->trained) { //the table was built from original, so sets give the nearest value it holds
+			codecSetBatch(codec, compressed, bytes, 5, 20, replacement);
+			for(i = 5; i < 25; i++) {
+				mu_assert(fabsf(codec->get(codec, compressed, bytes, i) - replacement[i - 5]) <= 1.0f, "ERROR in testCodecRegistry: trained set didnt store the nearest value");
+			}
+		} else if(codec->set) {
+			codecSetBatch(codec, compressed, bytes, 5, 20, replacement);
+			expectedCompressed = codec->compress(codec, expected, 40, &expectedBytes);
+			expectedDecompressed = codec->decompress(codec, expectedCompressed, expectedBytes, 40);
+			free(decompressed);
+			decompressed = codec->decompress(codec, compressed, bytes, 40);
+			mu_assert(memcmp(decompressed, expectedDecompressed, sizeof(expected)) == 0, "ERROR in testCodecRegistry: batch set didnt store the values");
+			codec->set(codec, compressed, bytes, 39, replacement[0]);
+			mu_assert(codec->get(codec, compressed, bytes, 39) == expectedDecompressed[5] && codec->get(codec, compressed, bytes, 38) == expectedDecompressed[38], "ERROR in testCodecRegistry: set didnt store the value");
+			free(expectedCompressed);
+			free(expectedDecompressed);
+		}
+		free(compressed);
+		free(decompressed);
+	}
+
+	testCodec = *findCodec("16 Bit Aligned");
+	testCodec.name = "16 Bit Aligned (test copy)";
+	mu_assert(registerCodec(&testCodec) == 1, "ERROR in testCodecRegistry: new codec wasnt registered");
+	mu_assert(registerCodec(&testCodec) == 0, "ERROR in testCodecRegistry: codec name was registered twice");
+	mu_assert(findCodec("16 Bit Aligned (test copy)") == &testCodec && findCodec("no such codec") == NULL, "ERROR in testCodecRegistry: codec lookup by name failed");
+}
+
+/*
+ * Purpose:
+ *		Test that the compressed field accessors agree with the codec they wrap, both on the inline variable bit path and through
+ *		codec->get/set, and that a set only changes its own record
+ */
+MU_TEST(testCompressedField) {
+	float fractions[4] = {0.0, 0.125, 0.25, 0.3125}; //fit the precision of every built in codec
+	struct fieldDescriptor shape = getContiguousField(19, 10, 5);
+	struct fieldLayout layout = getFieldLayout(&shape, LAYOUT_BRICK);
+	struct compressedField field;
+	const struct codec *codec;
+	float *values = malloc(layout.storageCount * sizeof(float));
+	unsigned char *expected;
+	float sum, expectedSum;
+	int count;
+	unsigned int c, i, j, k;
+	size_t index;
+
+	for(i = 0; i < layout.storageCount; i++) {
+		values[i] = (i % 2 ? -1 : 1) * ((i % 15) + fractions[i % 4]);
+	}
+	for(c = 0; c < getCodecCount(); c++) {
+		codec = getCodec(c);
+		if(codec->get == NULL || codec->set == NULL) {
+			continue;
+		}
+		field = getCompressedField(codec, values, 19, 10, 5, &layout);
+		for(k = 0; k < 5; k++) {
+			for(j = 0; j < 10; j++) {
+				for(i = 0; i < 19; i++) {
+					index = getLayoutIndex(&layout, i, j, k);
+					mu_assert(getFieldValue(&field, i, j, k) == codec->get(codec, field.values, field.bytes, index), "ERROR in testCompressedField: field value doesnt match the codec");
+				}
+			}
+		}
+		for(k = 0; k < 5; k += 4) { //corner (0, 0) of the first then the last k plane, each missing 3 neighbours
+			sum = getFieldNeighbourSum(&field, 0, 0, k, &count);
+			expectedSum = getFieldValue(&field, 1, 0, k) + getFieldValue(&field, 0, 1, k) + (k ? getFieldValue(&field, 0, 0, k-1) : getFieldValue(&field, 0, 0, k+1));
+			mu_assert(count == 3 && sum == expectedSum, "ERROR in testCompressedField: boundary neighbour sum is wrong");
+		}
+		sum = getFieldNeighbourSum(&field, 7, 4, 2, &count);
+		expectedSum = getFieldValue(&field, 6, 4, 2) + getFieldValue(&field, 8, 4, 2) + getFieldValue(&field, 7, 3, 2)
+			+ getFieldValue(&field, 7, 5, 2) + getFieldValue(&field, 7, 4, 1) + getFieldValue(&field, 7, 4, 3);
+		mu_assert(count == 6 && sum == expectedSum, "ERROR in testCompressedField: interior neighbour sum is wrong");
+
+		expected = malloc(field.bytes);
+		memcpy(expected, field.values, field.bytes);
+		for(k = 0; k < 5; k += 2) {
+			index = getLayoutIndex(&layout, 18, 9 - k, k);
+			codec->set(codec, expected, field.bytes, index, -9.25);
+			setFieldValue(&field, 18, 9 - k, k, -9.25);
+		}
+		mu_assert(memcmp(expected, field.values, field.bytes) == 0, "ERROR in testCompressedField: set changed other records");
+		mu_assert(getFieldValue(&field, 18, 5, 4) == codec->get(codec, expected, field.bytes, getLayoutIndex(&layout, 18, 5, 4)), "ERROR in testCompressedField: set value doesnt read back");
+		free(expected);
+		freeCompressedField(&field);
+	}
+	free(values);
+	freeFieldLayout(&layout);
+}
+
+/*
+ * Purpose:
+ *		Test that every instruction set level this CPU supports gives bit identical results to the scalar kernels, for runlength compression,
+ *		24 bit decompression and variable bit stream reads starting part way through a byte
+ */
+MU_TEST(testKernelDispatch) {
+	enum kernelIsa selected = getKernelIsa();
+	unsigned int magBits[3] = {5, 5, 7};
+	unsigned int precBits[3] = {15, 6, 17}; //the last is too wide for the vector variable bit kernels
+	float values[1000];
+	float *expected[5], *decoded;
+	unsigned char *compressed;
+	struct compressedVal *compressed24;
+	struct variableBitStream stream;
+	unsigned int compressedCount, count, f, i, isa;
+
+	for(i = 0; i < 1000; i++) {
+		values[i] = (i % 3 ? 1 : -1) * (((i*7) % 29) + (i % 8) / 8.0); //fits every field size below
+		if(i % 100 > 60) {
+			values[i] = values[i - i % 100 + 60]; //runs of repeats for runlength
+		}
+	}
+	mu_assert(setKernelIsa(ISA_COUNT) == 0 && setKernelIsa(ISA_SCALAR) == 1 && getKernelIsa() == ISA_SCALAR, "ERROR in testKernelDispatch: kernels couldnt be selected");
+	for(isa = ISA_SCALAR; isa <= getSupportedIsa(); isa++) {
+		mu_assert(setKernelIsa((enum kernelIsa) isa) == 1 && strcmp(getIsaName(getKernelIsa()), getIsaName((enum kernelIsa) isa)) == 0, "ERROR in testKernelDispatch: supported level wasnt selected");
+		compressed = getRunlengthCompressedData(values, 1000, &compressedCount);
+		decoded = getRunlengthDecompressedData(compressed, compressedCount, &count);
+		mu_assert(count == 1000 && memcmp(decoded, values, sizeof(values)) == 0, "ERROR in testKernelDispatch: runlength didnt round trip");
+		free(compressed);
+		free(decoded);
+
+		compressed24 = get24BitCompressedData(values, 1000, 5, 18);
+		decoded = get24BitDecompressedData(compressed24, 1000, 5, 18);
+		if(isa == ISA_SCALAR) {
+			expected[0] = decoded;
+		} else {
+			mu_assert(memcmp(decoded, expected[0], sizeof(values)) == 0, "ERROR in testKernelDispatch: 24 bit decompression differs from scalar");
+			free(decoded);
+		}
+		free(compressed24);
+
+		for(f = 0; f < 3; f++) {
+			compressed = getVariableBitCompressedData(values, 1000, &compressedCount, magBits[f], precBits[f]);
+			decoded = malloc(1000 * sizeof(float));
+			startVariableBitStream(&stream, compressed, compressedCount, magBits[f], precBits[f]);
+			readVariableBitValues(&stream, decoded, 3); //leave the stream part way through a byte
+			readVariableBitValues(&stream, decoded + 3, 990);
+			readVariableBitValues(&stream, decoded + 993, 7);
+			if(isa == ISA_SCALAR) {
+				expected[f+1] = decoded;
+			} else {
+				mu_assert(memcmp(decoded, expected[f+1], sizeof(values)) == 0, "ERROR in testKernelDispatch: variable bit read differs from scalar");
+				free(decoded);
+			}
+			free(compressed);
+		}
+	}
+	compressed = getVariableBitCompressedData(values, 1000, &compressedCount, 5, 6);
+	for(i = 0; i < 1000; i++) {
+		mu_assert(expected[2][i] == getSingleVariableBitValue(compressed, compressedCount, i, 5, 6), "ERROR in testKernelDispatch: scalar variable bit read is wrong");
+	}
+	free(compressed);
+	for(f = 0; f < 4; f++) {
+		free(expected[f]);
+	}
+	setKernelIsa(selected);
+}
+
+/*
+ * Purpose:
+ *		Test that a field stream reads back the header, widths and blocks it was written with, that widths a codec cant store are refused
+ *		and that a stream cut off part way through a block is reported as damaged
+ */
+MU_TEST(testFieldStream) {
+	struct fieldStreamHeader header = {.nx = 5, .ny = 4, .nz = 3}, readHeader;
+	unsigned int blockCounts[3] = {25, 25, 10}, count, b, i;
+	unsigned char *compressed;
+	float values[60], *decompressed, *expected;
+	size_t bytes, expectedBytes, streamBytes;
+	struct codec widthCodec;
+	FILE *file = tmpfile();
+	char *damaged;
+
+	for(i = 0; i < 60; i++) {
+		values[i] = (i % 3 ? 1 : -1) * ((i*7 % 23) + 0.125 * (i % 8));
+	}
+	header.codec = *findCodec("21 Bit Lossy");
+	mu_assert(setCodecWidths(&header.codec, 6, 10) && header.codec.magBits == 6 && header.codec.precBits == 10, "ERROR in testFieldStream: variable bit widths werent set");
+	widthCodec = *findCodec("24 Bit Lossy");
+	mu_assert(!setCodecWidths(&widthCodec, 5, 15) && setCodecWidths(&widthCodec, 6, 17), "ERROR in testFieldStream: 24 bit codec accepted a record that isnt 24 bits");
+	widthCodec = *findCodec("16 Bit Aligned");
+	mu_assert(setCodecWidths(&widthCodec, 5, 14) && widthCodec.parameter == 3 && !setCodecWidths(&widthCodec, 8, 24), "ERROR in testFieldStream: aligned codec record bytes are wrong");
+	mu_assert(!setCodecWidths(&widthCodec, 5, 0), "ERROR in testFieldStream: record without precision bits was accepted");
+	widthCodec = *findCodec("Runlength");
+	mu_assert(!setCodecWidths(&widthCodec, 5, 10), "ERROR in testFieldStream: codec without widths accepted them");
+
+	mu_assert(writeFieldStreamHeader(file, &header), "ERROR in testFieldStream: couldnt write the header");
+	for(b = 0, i = 0; b < 3; i += blockCounts[b++]) {
+		mu_assert(writeFieldStreamBlock(file, &header.codec, values + i, blockCounts[b], &bytes), "ERROR in testFieldStream: couldnt write a block");
+	}
+	mu_assert(writeFieldStreamEnd(file), "ERROR in testFieldStream: couldnt end the stream");
+	streamBytes = ftell(file);
+
+	rewind(file);
+	mu_assert(readFieldStreamHeader(file, &readHeader), "ERROR in testFieldStream: couldnt read the header");
+	mu_assert(strcmp(readHeader.codec.name, "21 Bit Lossy") == 0 && readHeader.codec.magBits == 6 && readHeader.codec.precBits == 10
+		&& readHeader.nx == 5 && readHeader.ny == 4 && readHeader.nz == 3, "ERROR in testFieldStream: header doesnt match what was written");
+	for(b = 0, i = 0; b < 3; i += blockCounts[b++]) {
+		mu_assert(readFieldStreamBlock(file, &readHeader.codec, &compressed, &count, &bytes) == 1 && count == blockCounts[b], "ERROR in testFieldStream: block is missing");
+		decompressed = readHeader.codec.decompress(&readHeader.codec, compressed, bytes, count);
+		free(compressed);
+		compressed = header.codec.compress(&header.codec, values + i, count, &expectedBytes);
+		expected = header.codec.decompress(&header.codec, compressed, expectedBytes, count);
+		mu_assert(bytes == expectedBytes && memcmp(decompressed, expected, count * sizeof(float)) == 0, "ERROR in testFieldStream: block doesnt decompress to the values written");
+		free(compressed);
+		free(expected);
+		free(decompressed);
+	}
+	mu_assert(readFieldStreamBlock(file, &readHeader.codec, &compressed, &count, &bytes) == 0, "ERROR in testFieldStream: end of stream wasnt found");
+
+	//the same stream cut off inside its last block
+	damaged = malloc(streamBytes);
+	rewind(file);
+	mu_assert(fread(damaged, 1, streamBytes, file) == streamBytes, "ERROR in testFieldStream: couldnt read the stream back");
+	fclose(file);
+	file = tmpfile();
+	fwrite(damaged, 1, streamBytes - 10, file);
+	rewind(file);
+	readFieldStreamHeader(file, &readHeader);
+	for(b = 0; b < 2; b++) {
+		mu_assert(readFieldStreamBlock(file, &readHeader.codec, &compressed, &count, &bytes) == 1, "ERROR in testFieldStream: block before the damage is missing");
+		free(compressed);
+	}
+	mu_assert(readFieldStreamBlock(file, &readHeader.codec, &compressed, &count, &bytes) == -1, "ERROR in testFieldStream: cut off block wasnt reported");
+	fclose(file);
+	free(damaged);
+
+	//headers with a parameter the codec cant use are refused, the decoders index and shift by it
+	const char *parameterCodecs[8] = {"16 Bit Aligned", "16 Bit Aligned", "XOR Predictive (previous value)", "16 Bit Truncated Float", "24 Bit Lossy Shuffled + rANS",
+		"8 Bit Codebook", "8 Bit Codebook", "8 Bit Codebook"};
+	unsigned int parameters[8] = {2, 100, 0, 200, 3, 16, 9, 40};
+	int accepted[8] = {1, 0, 0, 0, 0, 1, 0, 0};
+	for(b = 0; b < 8; b++) {
+		header.codec = *findCodec(parameterCodecs[b]);
+		header.codec.parameter = parameters[b];
+		file = tmpfile();
+		writeFieldStreamHeader(file, &header);
+		rewind(file);
+		mu_assert(readFieldStreamHeader(file, &readHeader) == accepted[b], "ERROR in testFieldStream: codec parameter wasnt checked");
+		fclose(file);
+	}
+
+	//a block too small for the values it claims comes back NULL rather than being read past its end
+	header.codec = *findCodec("16 Bit Aligned");
+	compressed = header.codec.compress(&header.codec, values, 60, &bytes);
+	mu_assert(header.codec.decompress(&header.codec, compressed, bytes - 1, 60) == NULL, "ERROR in testFieldStream: short block wasnt rejected");
+	free(compressed);
+}
+
+/*
+ * Purpose:
+ *		Test the truncated float format: relative error stays within half the last kept mantissa bit across the exponent range, 8 exponent
+ *		and 23 mantissa bits give the original floats back, out of range values flush or saturate, single gets and sets match the bulk
+ *		functions and every instruction set level decodes the same values
+ */
+MU_TEST(testTruncatedFloat) {
+	unsigned int widths[4][2] = {{5, 10}, {8, 7}, {8, 15}, {4, 3}}, byteCount, f, i, bias;
+	enum kernelIsa isa, selected = getKernelIsa();
+	float values[1000], special[6] = {0.0f, -0.0f, 1e-30f, -1e30f, INFINITY, NAN};
+	float *decompressed, *isaDecompressed, largest;
+	unsigned char *compressed;
+
+	for(i = 0; i < 1000; i++) {
+		values[i] = (i % 2 ? -1 : 1) * powf(1.0371f, (float) i - 500.0f) * (1.0f + (i % 7) / 7.0f); //about 1e-8 to 1e8
+	}
+	for(f = 0; f < 4; f++) {
+		bias = TRUNCATED_FLOAT_BIAS(widths[f][0]);
+		compressed = getTruncatedFloatCompressedData(values, 1000, &byteCount, widths[f][0], widths[f][1], bias);
+		mu_assert(byteCount == (1000 * (1 + widths[f][0] + widths[f][1]) + 7) / 8, "ERROR in testTruncatedFloat: wrong compressed size");
+		decompressed = getTruncatedFloatDecompressedData(compressed, byteCount, 1000, widths[f][0], widths[f][1], bias);
+		for(i = 0; i < 1000; i++) {
+			if(fabsf(values[i]) >= ldexpf(1.0f, 2 - (int) bias) && fabsf(values[i]) < ldexpf(1.0f, (1 << widths[f][0]) - 1 - bias)) { //inside the range
+				mu_assert(fabsf(decompressed[i] - values[i]) <= fabsf(values[i]) * ldexpf(1.0f, -(int) widths[f][1] - 1), "ERROR in testTruncatedFloat: relative error is above half a mantissa bit");
+			}
+			mu_assert(getSingleTruncatedFloatValue(compressed, byteCount, i, widths[f][0], widths[f][1], bias) == decompressed[i], "ERROR in testTruncatedFloat: single get doesnt match decompress");
+		}
+		for(isa = ISA_SCALAR; isa <= getSupportedIsa(); isa++) {
+			setKernelIsa(isa);
+			isaDecompressed = getTruncatedFloatDecompressedData(compressed, byteCount, 1000, widths[f][0], widths[f][1], bias);
+			mu_assert(memcmp(isaDecompressed, decompressed, sizeof(values)) == 0, "ERROR in testTruncatedFloat: instruction set levels decode differently");
+			free(isaDecompressed);
+		}
+		setKernelIsa(selected);
+
+		//a set must only touch its own record
+		for(i = 0; i < 1000; i += 37) {
+			insertSingleTruncatedFloatValue(compressed, byteCount, i, values[999 - i], widths[f][0], widths[f][1], bias);
+			mu_assert(getSingleTruncatedFloatValue(compressed, byteCount, i, widths[f][0], widths[f][1], bias) == decompressed[999 - i], "ERROR in testTruncatedFloat: set didnt store the value");
+			mu_assert(i == 999 || getSingleTruncatedFloatValue(compressed, byteCount, i + 1, widths[f][0], widths[f][1], bias) == decompressed[i + 1], "ERROR in testTruncatedFloat: set changed the next record");
+		}
+		free(compressed);
+		free(decompressed);
+	}
+
+	compressed = getTruncatedFloatCompressedData(values, 1000, &byteCount, 8, 23, 127);
+	decompressed = getTruncatedFloatDecompressedData(compressed, byteCount, 1000, 8, 23, 127);
+	mu_assert(memcmp(decompressed, values, sizeof(values)) == 0, "ERROR in testTruncatedFloat: full width records arent lossless");
+	free(compressed);
+	free(decompressed);
+
+	compressed = getTruncatedFloatCompressedData(special, 6, &byteCount, 5, 10, 15);
+	decompressed = getTruncatedFloatDecompressedData(compressed, byteCount, 6, 5, 10, 15);
+	largest = ldexpf(2.0f - ldexpf(1.0f, -10), 16);
+	mu_assert(decompressed[0] == 0.0f && !signbit(decompressed[0]) && decompressed[1] == 0.0f && signbit(decompressed[1]) && decompressed[2] == 0.0f, "ERROR in testTruncatedFloat: small values didnt flush to zero");
+	mu_assert(decompressed[3] == -largest && decompressed[4] == largest && decompressed[5] == largest, "ERROR in testTruncatedFloat: large values didnt saturate");
+	free(compressed);
+	free(decompressed);
+	compressed = getTruncatedFloatCompressedData(special, 6, &byteCount, 8, 7, 127);
+	decompressed = getTruncatedFloatDecompressedData(compressed, byteCount, 6, 8, 7, 127);
+	mu_assert(fabsf(decompressed[3] + 1e30f) <= ldexpf(1e30f, -8) && isinf(decompressed[4]) && isnan(decompressed[5]), "ERROR in testTruncatedFloat: 8 exponent bits dont keep infinity and NaN");
+	free(compressed);
+	free(decompressed);
+}
+
+/*
+ * Purpose:
+ *		Test the half precision and bfloat16 formats: every half record converts back and forth exactly, every instruction set level
+ *		converts a wide spread of float bit patterns (subnormals, rounding ties, overflow, NaN) to the same records, and single gets and
+ *		inserts match the bulk functions
+ */
+MU_TEST(testHalfFloat) {
+	enum kernelIsa isa, selected = getKernelIsa();
+	unsigned int count = 65536 + 65536, i;
+	float *values = malloc(count * sizeof(float)), *decompressed, *expectedValues = NULL;
+	unsigned char *records = malloc(65536 * 2), *compressed, *expected = NULL;
+	uint32_t bits;
+	uint16_t record;
+
+	for(i = 0; i < 65536; i++) {
+		record = i;
+		memcpy(records + i*2, &record, sizeof(uint16_t));
+		bits = i * 65537U + 12345; //spread over every exponent, with low bits set so rounding is exercised
+		memcpy(&values[i], &bits, sizeof(float));
+		bits = (i & 0x8000) << 16 | (0x33000000 + (i & 0x7FFF) * 0x2000); //around the subnormal and overflow thresholds, including exact ties
+		memcpy(&values[65536 + i], &bits, sizeof(float));
+	}
+	for(isa = ISA_SCALAR; isa <= getSupportedIsa(); isa++) {
+		setKernelIsa(isa);
+		decompressed = getFloat16DecompressedData(records, 65536);
+		compressed = getFloat16CompressedData(values, count);
+		if(isa == ISA_SCALAR) {
+			expected = compressed;
+			expectedValues = decompressed;
+			for(i = 0; i < 65536; i++) {
+				mu_assert(getSingleFloat16Value(records, i) == decompressed[i] || (isnan(decompressed[i]) && isnan(getSingleFloat16Value(records, i))), "ERROR in testHalfFloat: single get doesnt match decompress");
+			}
+		} else {
+			mu_assert(memcmp(compressed, expected, count * 2) == 0, "ERROR in testHalfFloat: instruction set levels round differently");
+			mu_assert(memcmp(decompressed, expectedValues, 65536 * sizeof(float)) == 0, "ERROR in testHalfFloat: instruction set levels decode differently");
+			free(compressed);
+			free(decompressed);
+		}
+	}
+	setKernelIsa(selected);
+	compressed = getFloat16CompressedData(expectedValues, 65536);
+	for(i = 0; i < 65536; i++) {
+		if((i & 0x7C00) != 0x7C00 || (i & 0x3FF) == 0 || (i & 0x200)) { //signalling NaNs come back quietened
+			mu_assert(memcmp(compressed + i*2, records + i*2, 2) == 0, "ERROR in testHalfFloat: half records dont round trip");
+		}
+	}
+	free(compressed);
+	for(i = 0; i < count; i += 7) {
+		insertSingleFloat16Value(records, values[i], i % 65536);
+		mu_assert(memcmp(records + (i % 65536)*2, expected + i*2, 2) == 0, "ERROR in testHalfFloat: single insert doesnt match compress");
+	}
+	free(expected);
+	free(expectedValues);
+
+	compressed = getBFloat16CompressedData(values, count);
+	decompressed = getBFloat16DecompressedData(compressed, count);
+	for(i = 0; i < count; i++) {
+		if(isnan(values[i])) {
+			mu_assert(isnan(decompressed[i]), "ERROR in testHalfFloat: bfloat16 lost a NaN");
+		} else if(isfinite(decompressed[i]) && fabsf(values[i]) >= FLT_MIN) {
+			mu_assert(fabsf(decompressed[i] - values[i]) <= fabsf(values[i]) * 0x1p-8f, "ERROR in testHalfFloat: bfloat16 relative error is above 2^-8");
+		}
+		mu_assert(getSingleBFloat16Value(compressed, i) == decompressed[i] || isnan(decompressed[i]), "ERROR in testHalfFloat: bfloat16 single get doesnt match decompress");
+	}
+	insertSingleBFloat16Value(compressed, 1.0f + 0x1p-8f, 3); //tie, rounds to even
+	insertSingleBFloat16Value(compressed, 1.0f + 0x3p-8f, 4);
+	mu_assert(getSingleBFloat16Value(compressed, 3) == 1.0f && getSingleBFloat16Value(compressed, 4) == 1.0f + 0x1p-6f && getSingleBFloat16Value(compressed, 5) == decompressed[5], "ERROR in testHalfFloat: bfloat16 insert didnt round to nearest even");
+	free(compressed);
+	free(decompressed);
+	free(values);
+	free(records);
+}
+
+/*
+ * Purpose:
+ *		Test that the rANS entropy stage gives the bytes back over several blocks, stores bytes it cant shrink within the block overhead,
+ *		rejects damaged data, and that the entropy coded codecs decode to the same values as the packed formats under them
+ */
+MU_TEST(testEntropyCoding) {
+	unsigned int count = 3*ENTROPY_BLOCK/2 + 17, i, newCount, decodedCount; //the last block is short and doesnt line up with the interleaved states
+	unsigned char *data = malloc(count), *coded, *decoded, *packed;
+	float *values = malloc(1000 * sizeof(float)), *expected, *decompressed;
+	const struct codec *codec;
+	size_t codedBytes, decodedBytes;
+
+	srand(11);
+	for(i = 0; i < count; i++) { //skewed towards small bytes like the top bits of packed records
+		data[i] = (rand() % 8) * (rand() % 4) + (i % 5000 == 0 ? 200 : 0);
+	}
+	coded = getEntropyCompressedData(data, count, &codedBytes);
+	mu_assert(codedBytes < count / 2 && codedBytes <= getEntropyCompressedSize(count), "ERROR in testEntropyCoding: skewed bytes didnt compress");
+	decoded = getEntropyDecompressedData(coded, codedBytes, &decodedBytes);
+	mu_assert(decoded != NULL && decodedBytes == count && memcmp(decoded, data, count) == 0, "ERROR in testEntropyCoding: skewed bytes didnt round trip");
+	free(decoded);
+	coded[codedBytes / 2] ^= 0x5A;
+	decoded = getEntropyDecompressedData(coded, codedBytes / 2, &decodedBytes);
+	mu_assert(decoded == NULL, "ERROR in testEntropyCoding: cut short data wasnt rejected");
+	free(coded);
+
+	for(i = 0; i < count; i++) {
+		data[i] = rand();
+	}
+	coded = getEntropyCompressedData(data, count, &codedBytes);
+	mu_assert(codedBytes <= count + 2*4 + 3, "ERROR in testEntropyCoding: random bytes werent stored as they are");
+	decoded = getEntropyDecompressedData(coded, codedBytes, &decodedBytes);
+	mu_assert(decoded != NULL && decodedBytes == count && memcmp(decoded, data, count) == 0, "ERROR in testEntropyCoding: random bytes didnt round trip");
+	free(decoded);
+	free(coded);
+
+	memset(data, 7, count); //one symbol takes the whole frequency table
+	for(i = 1; i < 40; i += 13) {
+		coded = getEntropyCompressedData(data, i, &codedBytes);
+		decoded = getEntropyDecompressedData(coded, codedBytes, &decodedBytes);
+		mu_assert(decoded != NULL && decodedBytes == i && memcmp(decoded, data, i) == 0, "ERROR in testEntropyCoding: short single symbol block didnt round trip");
+		free(decoded);
+		free(coded);
+	}
+	coded = getEntropyCompressedData(data, count, &codedBytes);
+	mu_assert(codedBytes < 400, "ERROR in testEntropyCoding: a single symbol didnt compress");
+	free(coded);
+	coded = getEntropyCompressedData(data, 0, &codedBytes);
+	decoded = getEntropyDecompressedData(coded, codedBytes, &decodedBytes);
+	mu_assert(decoded != NULL && decodedBytes == 0, "ERROR in testEntropyCoding: empty input didnt round trip");
+	free(decoded);
+	free(coded);
+
+	for(i = 0; i < 1000; i++) {
+		values[i] = i % 4 ? 0.0f : (float) ((i / 40) % 5) * 0.25f; //mostly zeros with a few levels, like the sparser fields
+	}
+	codec = findCodec("21 Bit Lossy + rANS");
+	packed = getVariableBitCompressedData(values, 1000, &newCount, 5, 15);
+	expected = getVariableBitDecompressedData(packed, newCount, &decodedCount, 5, 15);
+	coded = codec->compress(codec, values, 1000, &codedBytes);
+	decompressed = codec->decompress(codec, coded, codedBytes, 1000);
+	mu_assert(codedBytes < newCount && memcmp(decompressed, expected, 1000 * sizeof(float)) == 0, "ERROR in testEntropyCoding: variable bit codec doesnt match the packed format");
+	free(packed);
+	free(expected);
+	free(coded);
+	free(decompressed);
+
+	codec = findCodec("24 Bit Lossy Shuffled + rANS");
+	packed = (unsigned char *) get24BitCompressedData(values, 1000, 5, 18);
+	expected = get24BitDecompressedData((struct compressedVal *) packed, 1000, 5, 18);
+	coded = codec->compress(codec, values, 1000, &codedBytes);
+	decompressed = codec->decompress(codec, coded, codedBytes, 1000);
+	mu_assert(codedBytes < 3000 && memcmp(decompressed, expected, 1000 * sizeof(float)) == 0, "ERROR in testEntropyCoding: shuffled 24 bit codec doesnt match the packed format");
+	free(packed);
+	free(expected);
+	free(coded);
+	free(decompressed);
+	free(values);
+	free(data);
+}
+
+/*
+ * Purpose:
+ *		Test the byte and bit shuffles against the layouts they document at every instruction set level, for widths with and without a
+ *		vector kernel and counts that dont fill a vector or a byte of each bit plane, and that the shuffled codecs round trip
+ */
+MU_TEST(testShuffleTransforms) {
+	enum kernelIsa selected = getKernelIsa();
+	unsigned int widths[5] = {1, 3, 4, 8, 11};
+	size_t counts[4] = {5, 16, 203, 4096};
+	unsigned char *in = malloc(4096 * 11), *out = malloc(4096 * 11), *back = malloc(4096 * 11), *scratch = malloc(4096 * 11);
+	float *values = malloc(1000 * sizeof(float)), *decompressed, *expected;
+	unsigned int w, c, isa, b, k, i, width, planeBytes;
+	const struct codec *codec;
+	unsigned char *compressed;
+	size_t count, bytes, j;
+	int correct;
+
+	srand(5);
+	for(j = 0; j < 4096 * 11; j++) {
+		in[j] = rand();
+	}
+	for(isa = ISA_SCALAR; isa <= getSupportedIsa(); isa++) {
+		setKernelIsa((enum kernelIsa) isa);
+		for(w = 0; w < 5; w++) {
+			for(c = 0; c < 4; c++) {
+				width = widths[w];
+				count = counts[c];
+				shuffleBytes(in, count, width, out);
+				for(j = 0, correct = 1; j < count * width; j++) {
+					correct &= out[(j % width) * count + j / width] == in[j];
+				}
+				mu_assert(correct, "ERROR in testShuffleTransforms: byte planes are wrong");
+				unshuffleBytes(out, count, width, back);
+				mu_assert(memcmp(back, in, count * width) == 0, "ERROR in testShuffleTransforms: byte shuffle didnt round trip");
+
+				shuffleBits(in, count, width, out, scratch);
+				planeBytes = count & ~7;
+				for(j = 0, correct = 1; j < planeBytes; j++) { //bit k of byte b of record j
+					for(b = 0; b < width; b++) {
+						for(k = 0; k < 8; k++) {
+							i = b*planeBytes + k*(planeBytes / 8) + j / 8;
+							correct &= ((out[i] >> (j % 8)) & 1) == ((in[j*width + b] >> k) & 1);
+						}
+					}
+				}
+				mu_assert(correct && memcmp(out + planeBytes*width, in + planeBytes*width, (count - planeBytes) * width) == 0, "ERROR in testShuffleTransforms: bit planes are wrong");
+				unshuffleBits(out, count, width, back, out); //scratch can be the input
+				mu_assert(memcmp(back, in, count * width) == 0, "ERROR in testShuffleTransforms: bit shuffle didnt round trip");
+			}
+		}
+	}
+	setKernelIsa(selected);
+
+	for(i = 0; i < 1000; i++) {
+		values[i] = i % 4 ? 0.0f : (float) ((i / 40) % 5) * 0.25f;
+	}
+	values[7] = -3.1f;
+	codec = findCodec("32 Bit Float Bitshuffled + rANS");
+	compressed = codec->compress(codec, values, 1000, &bytes);
+	decompressed = codec->decompress(codec, compressed, bytes, 1000);
+	mu_assert(codec->lossless && bytes < 1000 && memcmp(decompressed, values, 1000 * sizeof(float)) == 0, "ERROR in testShuffleTransforms: bit shuffled floats didnt round trip");
+	free(compressed);
+	free(decompressed);
+	codec = findCodec("21 Bit Lossy");
+	compressed = codec->compress(codec, values, 1000, &bytes);
+	expected = codec->decompress(codec, compressed, bytes, 1000);
+	free(compressed);
+	codec = findCodec("21 Bit Lossy Bitshuffled + rANS");
+	compressed = codec->compress(codec, values, 1000, &bytes);
+	decompressed = codec->decompress(codec, compressed, bytes, 1000);
+	mu_assert(bytes < 1000 && memcmp(decompressed, expected, 1000 * sizeof(float)) == 0, "ERROR in testShuffleTransforms: bit shuffled variable bit records dont match the packed format");
+	free(compressed);
+	free(decompressed);
+	free(expected);
+	free(values);
+	free(in);
+	free(out);
+	free(back);
+	free(scratch);
+}
+
+/*
+ * Purpose:
+ *		Test the codebook codec: fields with few distinct values are stored exactly, smooth fields stay within a fraction of a uniform step,
+ *		every instruction set level decodes the same values as single gets, and inserts pick the nearest entry
+ */
+MU_TEST(testCodebook) {
+	enum kernelIsa selected = getKernelIsa();
+	unsigned int count = 100003, i, isa, bits;
+	float *values = malloc(count * sizeof(float)), *decompressed, *codebook, maxError, step;
+	const struct codec *codec;
+	unsigned char *compressed;
+	double squaredError;
+	size_t bytes;
+	int correct;
+
+	for(i = 0; i < count; i++) {
+		values[i] = (float) ((i * 7919) % 200) / 8.0f - 10.0f; //200 levels
+	}
+	compressed = getCodebookCompressedData(values, count, 8);
+	decompressed = getCodebookDecompressedData(compressed, count, 8);
+	mu_assert(memcmp(decompressed, values, count * sizeof(float)) == 0, "ERROR in testCodebook: values with fewer levels than entries werent exact");
+	free(compressed);
+	free(decompressed);
+
+	for(i = 0; i < count; i++) {
+		values[i] = 50.0f * sinf(i / 997.0f) + 3.0f * cosf(i / 13.0f);
+	}
+	for(bits = 8; bits <= 16; bits += 8) {
+		compressed = getCodebookCompressedData(values, count, bits);
+		codebook = (float *) compressed;
+		step = 106.0f / CODEBOOK_ENTRIES(bits); //uniform step over the range
+		for(i = 1, correct = 1; i < CODEBOOK_ENTRIES(bits); i++) {
+			correct &= codebook[i] >= codebook[i - 1];
+		}
+		mu_assert(correct, "ERROR in testCodebook: codebook isnt sorted");
+		for(isa = ISA_SCALAR; isa <= getSupportedIsa(); isa++) {
+			setKernelIsa((enum kernelIsa) isa);
+			decompressed = getCodebookDecompressedData(compressed, count, bits);
+			maxError = 0.0f;
+			squaredError = 0.0;
+			for(i = 0, correct = 1; i < count; i++) {
+				correct &= decompressed[i] == getSingleCodebookValue(compressed, i, bits);
+				maxError = fmaxf(maxError, fabsf(decompressed[i] - values[i]));
+				squaredError += (decompressed[i] - values[i]) * (decompressed[i] - values[i]);
+			}
+			mu_assert(correct, "ERROR in testCodebook: decode doesnt match single gets");
+			mu_assert(maxError < 2 * step && sqrt(squaredError / count) < step / 2, "ERROR in testCodebook: quantisation error is too big");
+			free(decompressed);
+		}
+		setKernelIsa(selected);
+
+		insertSingleCodebookValue(compressed, codebook[5], 17, bits);
+		insertSingleCodebookValue(compressed, 1000.0f, 18, bits);
+		insertSingleCodebookValue(compressed, -1000.0f, 19, bits);
+		insertSingleCodebookValue(compressed, NAN, 20, bits);
+		mu_assert(getSingleCodebookValue(compressed, 17, bits) == codebook[5] && getSingleCodebookValue(compressed, 18, bits) == codebook[CODEBOOK_ENTRIES(bits) - 1]
+			&& getSingleCodebookValue(compressed, 19, bits) == codebook[0] && getSingleCodebookValue(compressed, 20, bits) == codebook[0], "ERROR in testCodebook: insert didnt pick the nearest entry");
+		insertSingleCodebookValue(compressed, values[21] + step / 8, 21, bits);
+		mu_assert(fabsf(getSingleCodebookValue(compressed, 21, bits) - values[21]) < 2 * step && getSingleCodebookValue(compressed, 22, bits) == getSingleCodebookValue(compressed, 22, bits), "ERROR in testCodebook: insert is too far off");
+		free(compressed);
+	}
+
+	codec = findCodec("8 Bit Codebook");
+	compressed = codec->compress(codec, values, count, &bytes);
+	decompressed = codec->decompress(codec, compressed, bytes, count);
+	codec->set(codec, compressed, bytes, 9, decompressed[3]);
+	mu_assert(bytes == 1024 + count && bytes <= codec->compressedSize(codec, count) && codec->get(codec, compressed, bytes, 9) == decompressed[3]
+		&& codec->get(codec, compressed, bytes, 10) == decompressed[10], "ERROR in testCodebook: codec doesnt match the codebook functions");
+
+	//only 8 and 16 bit indices are supported, anything else is refused rather than shifted or read as 16 bit
+	insertSingleCodebookValue(compressed, 1000.0f, 9, 40);
+	mu_assert(getCodebookCompressedData(values, count, 9) == NULL && getCodebookCompressedData(values, count, 40) == NULL
+		&& getCodebookDecompressedData(compressed, count, 12) == NULL && codec->get(codec, compressed, bytes, 9) == decompressed[3],
+		"ERROR in testCodebook: index bits other than 8 or 16 were accepted");
+	free(compressed);
+	free(decompressed);
+	free(values);
+}
+
 /*
  * Purpose:
  *	Causes all individual tests to be run...
@@ -679,14 +1709,32 @@ MU_TEST_SUITE(test_suite) {
 	MU_RUN_TEST(testGetData);
 	MU_RUN_TEST(testGetRunlengthCompressedDataset);
 	MU_RUN_TEST(testGetRunlengthDecompressedDataset);
+	MU_RUN_TEST(testRunlengthLiteralAndRunSpans);
+	MU_RUN_TEST(testRunlengthLargeMixedRuns);
+	MU_RUN_TEST(testXorPredictiveCompressAndDecompress);
+	MU_RUN_TEST(testGetFieldDescriptor);
+	MU_RUN_TEST(testFieldLayouts);
 	MU_RUN_TEST(testGet24BitCompressedDataset);
 	MU_RUN_TEST(testGet24BitDecompressedDataset);
 	MU_RUN_TEST(testGetSingle24BitValueAndDecompress);
 	MU_RUN_TEST(testInsertSingle24BitValueAndCompress);
+	MU_RUN_TEST(testGet24BitDecompressedMatchesSingle);
+	MU_RUN_TEST(testAlignedBitCompressAndDecompress);
+	MU_RUN_TEST(testFixedPoint24BitArithmetic);
 	MU_RUN_TEST(testGetVariableBitCompressedDataset);
 	MU_RUN_TEST(testGetVariableBitDecompressedDataset);
 	MU_RUN_TEST(testGetSingleVariableBitValueAndDecompress);
 	MU_RUN_TEST(testInsertSingleVariableBitValueAndCompress);
+	MU_RUN_TEST(testVariableBitStream);
+	MU_RUN_TEST(testCodecRegistry);
+	MU_RUN_TEST(testCompressedField);
+	MU_RUN_TEST(testKernelDispatch);
+	MU_RUN_TEST(testFieldStream);
+	MU_RUN_TEST(testTruncatedFloat);
+	MU_RUN_TEST(testHalfFloat);
+	MU_RUN_TEST(testEntropyCoding);
+	MU_RUN_TEST(testShuffleTransforms);
+	MU_RUN_TEST(testCodebook);
 }
 
 int main(int argc, char *argv[]) {
@@ -71,3 +71,326 @@ size_t zfpCompress(float* array, int nx, int ny, int nz, double tolerance, int d
 
   return zfpsize;
 }
+
+struct zfpContext {          /* zfp state kept between calls so nothing is reallocated per array */
+  zfp_stream* zfp;           /* compressed stream settings */
+  zfp_field* field;          /* array meta data, pointer and size set per call */
+  unsigned char* buffer;     /* storage for the last compressed stream */
+  size_t bufsize;            /* byte size of buffer */
+  bitstream* stream;         /* bit stream over buffer */
+};
+
+/*
+ * Purpose:
+ *    Create a zfp context that compresses in accuracy mode with the given tolerance (0.0 is lossless for our data)
+ * Returns:
+ *    The context, free it with zfpFreeContext
+ */
+struct zfpContext* zfpCreateContext(double tolerance)
+{
+  struct zfpContext* context = calloc(1, sizeof(struct zfpContext));
+
+  context->zfp = zfp_stream_open(NULL);
+  zfp_stream_set_accuracy(context->zfp, tolerance);
+  context->field = zfp_field_alloc();
+  zfp_field_set_type(context->field, zfp_type_float);
+  return context;
+}
+
+/*
+ * Purpose:
+ *    Choose how many threads the context compresses with. More than 1 thread uses zfp's OpenMP policy, which zfp only offers
+ *    when libzfp was built with OpenMP, otherwise the context stays serial. zfp only decompresses serially so decompression ignores this.
+ * Returns:
+ *    1 if compression will use the OpenMP policy, 0 if it is serial
+ * Parameters:
+ *    1. context - from zfpCreateContext
+ *    2. threads - number of threads, 0 lets OpenMP decide, 1 is serial
+ *    3. chunksize - blocks handed to a thread at a time, 0 lets zfp pick one chunk per thread
+ */
+int zfpSetThreads(struct zfpContext* context, unsigned int threads, unsigned int chunksize)
+{
+  if (threads != 1 && zfp_stream_set_execution(context->zfp, zfp_exec_omp)) {
+    zfp_stream_set_omp_threads(context->zfp, threads);
+    zfp_stream_set_omp_chunk_size(context->zfp, chunksize);
+    return 1;
+  }
+  zfp_stream_set_execution(context->zfp, zfp_exec_serial);
+  return 0;
+}
+
+/*
+ * Purpose:
+ *    Free a context and its compressed buffer
+ */
+void zfpFreeContext(struct zfpContext* context)
+{
+  if (context->stream)
+    stream_close(context->stream);
+  zfp_stream_close(context->zfp);
+  zfp_field_free(context->field);
+  free(context->buffer);
+  free(context);
+}
+
+/*
+ * Purpose:
+ *    Point the context's field at a 3D array a[nz][ny][nx]
+ */
+static void zfpSetField(struct zfpContext* context, float* array, int nx, int ny, int nz)
+{
+  zfp_field_set_pointer(context->field, array);
+  zfp_field_set_size_3d(context->field, nx, ny, nz);
+}
+
+/*
+ * Purpose:
+ *    Compress a 3D array a[nz][ny][nx] into the context's buffer, growing the buffer only when the array needs more than it has
+ * Returns:
+ *    Byte size of the compressed stream (0 on failure)
+ * Parameters:
+ *    1. context - from zfpCreateContext
+ *    2. array - values to compress
+ *    3. nx, ny, nz - dimensions of array, x varying fastest
+ *    4. compressed - gets pointed at the compressed stream, which stays valid until the next compression with this context
+ */
+size_t zfpCompressWithContext(struct zfpContext* context, float* array, int nx, int ny, int nz, const unsigned char** compressed)
+{
+  size_t bufsize;
+  size_t zfpsize;
+
+  zfpSetField(context, array, nx, ny, nz);
+  bufsize = zfp_stream_maximum_size(context->zfp, context->field);
+  if (bufsize > context->bufsize) {
+    if (context->stream)
+      stream_close(context->stream);
+    free(context->buffer);
+    context->buffer = malloc(bufsize);
+    context->bufsize = bufsize;
+    context->stream = stream_open(context->buffer, bufsize);
+  }
+  zfp_stream_set_bit_stream(context->zfp, context->stream);
+  zfp_stream_rewind(context->zfp);
+  zfpsize = zfp_compress(context->zfp, context->field);
+  if (!zfpsize)
+    fprintf(stderr, "compression failed\n");
+  if (compressed)
+    *compressed = context->buffer;
+  return zfpsize;
+}
+
+/*
+ * Purpose:
+ *    Decompress an in memory zfp stream into a 3D array a[nz][ny][nx]
+ * Returns:
+ *    0 on success, 1 on failure
+ * Parameters:
+ *    1. context - from zfpCreateContext, with the same tolerance the stream was compressed with
+ *    2. compressed - the compressed stream (from zfpCompressWithContext or a copy of it)
+ *    3. zfpsize - byte size of compressed
+ *    4. array - where to write the values
+ *    5. nx, ny, nz - dimensions of array, x varying fastest
+ */
+int zfpDecompressWithContext(struct zfpContext* context, const unsigned char* compressed, size_t zfpsize, float* array, int nx, int ny, int nz)
+{
+  zfp_exec_policy policy = zfp_stream_execution(context->zfp);
+  bitstream* input = NULL;
+  int status = 0;
+
+  zfpSetField(context, array, nx, ny, nz);
+  if (compressed == context->buffer) {
+    zfp_stream_set_bit_stream(context->zfp, context->stream);
+  }
+  else { /* a caller buffer gets its own bit stream per call, its address may be freed and reused between calls */
+    input = stream_open((void*)compressed, zfpsize);
+    zfp_stream_set_bit_stream(context->zfp, input);
+  }
+  zfp_stream_rewind(context->zfp);
+  zfp_stream_set_execution(context->zfp, zfp_exec_serial); /* zfp has no parallel decompression on the CPU */
+  if (!zfp_decompress(context->zfp, context->field)) {
+    fprintf(stderr, "decompression failed\n");
+    status = 1;
+  }
+  zfp_stream_set_execution(context->zfp, policy);
+  if (input) {
+    zfp_stream_set_bit_stream(context->zfp, context->stream);
+    stream_close(input);
+  }
+  return status;
+}
+
+struct zfpCachedBlock {       /* one decoded 4x4x4 block */
+  size_t index;              /* block number, (size_t)-1 when the slot is empty */
+  int dirty;                 /* set when values changed since the block was decoded */
+  float values[64];
+};
+
+struct zfpArray {            /* fixed rate zfp array with per element access through a cache of decoded blocks */
+  zfp_stream* zfp;
+  bitstream* stream;
+  unsigned char* buffer;
+  size_t bufsize;
+  size_t blockbits;          /* every block takes exactly this many bits in fixed rate mode */
+  int nx, ny, nz;
+  int bx, by, bz;            /* number of blocks in each dimension */
+  unsigned int cacheblocks;
+  struct zfpCachedBlock* cache;
+};
+
+/*
+ * Purpose:
+ *    Encode block number index of the array from 64 values, overwriting the bits it had
+ */
+static void zfpArrayEncodeBlock(struct zfpArray* array, size_t index, const float* values)
+{
+  stream_wseek(array->stream, index * array->blockbits);
+  zfp_encode_block_float_3(array->zfp, values);
+  stream_flush(array->stream);
+}
+
+/*
+ * Purpose:
+ *    Decode block number index of the array into 64 values
+ */
+static void zfpArrayDecodeBlock(struct zfpArray* array, size_t index, float* values)
+{
+  stream_rseek(array->stream, index * array->blockbits);
+  zfp_decode_block_float_3(array->zfp, values);
+}
+
+/*
+ * Purpose:
+ *    Compress a 3D array a[nz][ny][nx] in fixed rate mode so any block can be found without decoding the ones before it.
+ *    Blocks that hang over the edge of the array are padded by repeating the last value in each dimension.
+ * Returns:
+ *    The compressed array, free it with zfpFreeArray
+ * Parameters:
+ *    1. values - array to compress, x varying fastest
+ *    2. nx, ny, nz - dimensions of values
+ *    3. rate - bits per value
+ *    4. cacheblocks - number of decoded blocks kept (direct mapped), at least 1
+ */
+struct zfpArray* zfpCreateArray(float* values, int nx, int ny, int nz, double rate, unsigned int cacheblocks)
+{
+  struct zfpArray* array = calloc(1, sizeof(struct zfpArray));
+  float block[64];
+  int x, y, z, i, j, k;
+  unsigned int c;
+
+  array->nx = nx;
+  array->ny = ny;
+  array->nz = nz;
+  array->bx = (nx + 3) / 4;
+  array->by = (ny + 3) / 4;
+  array->bz = (nz + 3) / 4;
+  array->zfp = zfp_stream_open(NULL);
+  zfp_stream_set_rate(array->zfp, rate, zfp_type_float, 3, 1); /* aligned so each block starts on a word */
+  array->blockbits = array->zfp->maxbits;
+  array->bufsize = ((size_t)array->bx * array->by * array->bz * array->blockbits + 63) / 64 * 8;
+  array->buffer = calloc(array->bufsize, 1);
+  array->stream = stream_open(array->buffer, array->bufsize);
+  zfp_stream_set_bit_stream(array->zfp, array->stream);
+  zfp_stream_rewind(array->zfp);
+
+  for (z = 0; z < array->bz; z++)
+    for (y = 0; y < array->by; y++)
+      for (x = 0; x < array->bx; x++) {
+        for (k = 0; k < 4; k++)
+          for (j = 0; j < 4; j++)
+            for (i = 0; i < 4; i++) {
+              int ix = 4 * x + i < nx ? 4 * x + i : nx - 1;
+              int iy = 4 * y + j < ny ? 4 * y + j : ny - 1;
+              int iz = 4 * z + k < nz ? 4 * z + k : nz - 1;
+              block[i + 4 * j + 16 * k] = values[ix + (size_t)nx * (iy + (size_t)ny * iz)];
+            }
+        zfp_encode_block_float_3(array->zfp, block);
+      }
+  zfp_stream_flush(array->zfp);
+
+  array->cacheblocks = cacheblocks ? cacheblocks : 1;
+  array->cache = malloc(array->cacheblocks * sizeof(struct zfpCachedBlock));
+  for (c = 0; c < array->cacheblocks; c++) {
+    array->cache[c].index = (size_t)-1;
+    array->cache[c].dirty = 0;
+  }
+  return array;
+}
+
+/*
+ * Purpose:
+ *    Find the cached copy of the block holding (i, j, k), decoding it (and writing back whatever it replaces) on a miss
+ * Returns:
+ *    The cached block
+ */
+static struct zfpCachedBlock* zfpArrayBlock(struct zfpArray* array, int i, int j, int k)
+{
+  size_t index = (size_t)(i >> 2) + (size_t)array->bx * ((j >> 2) + (size_t)array->by * (k >> 2));
+  struct zfpCachedBlock* slot = &array->cache[(index * 2654435761u) % array->cacheblocks]; /* hash so blocks a z step apart dont share a slot */
+
+  if (slot->index != index) {
+    if (slot->dirty)
+      zfpArrayEncodeBlock(array, slot->index, slot->values);
+    zfpArrayDecodeBlock(array, index, slot->values);
+    slot->index = index;
+    slot->dirty = 0;
+  }
+  return slot;
+}
+
+/*
+ * Purpose:
+ *    Get the value at (i, j, k) of a zfp array
+ */
+float zfpArrayGet(struct zfpArray* array, int i, int j, int k)
+{
+  return zfpArrayBlock(array, i, j, k)->values[(i & 3) + 4 * (j & 3) + 16 * (k & 3)];
+}
+
+/*
+ * Purpose:
+ *    Set the value at (i, j, k) of a zfp array. The block is only recompressed when it leaves the cache or the array is flushed.
+ */
+void zfpArraySet(struct zfpArray* array, int i, int j, int k, float value)
+{
+  struct zfpCachedBlock* slot = zfpArrayBlock(array, i, j, k);
+
+  slot->values[(i & 3) + 4 * (j & 3) + 16 * (k & 3)] = value;
+  slot->dirty = 1;
+}
+
+/*
+ * Purpose:
+ *    Recompress every changed block still in the cache
+ */
+void zfpArrayFlush(struct zfpArray* array)
+{
+  unsigned int c;
+
+  for (c = 0; c < array->cacheblocks; c++)
+    if (array->cache[c].dirty) {
+      zfpArrayEncodeBlock(array, array->cache[c].index, array->cache[c].values);
+      array->cache[c].dirty = 0;
+    }
+}
+
+/*
+ * Purpose:
+ *    Get the number of bytes of compressed data held by a zfp array
+ */
+size_t zfpArraySize(struct zfpArray* array)
+{
+  return array->bufsize;
+}
+
+/*
+ * Purpose:
+ *    Free a zfp array, changes still in the cache are dropped
+ */
+void zfpFreeArray(struct zfpArray* array)
+{
+  stream_close(array->stream);
+  zfp_stream_close(array->zfp);
+  free(array->buffer);
+  free(array->cache);
+  free(array);
+}
@@ -3,4 +3,30 @@
 
 size_t zfpCompress(float *array, int nx, int ny, int nz, double tolerance, int decompress);
 
+struct zfpContext; //persistent zfp stream and buffer, reused across calls
+
+struct zfpContext *zfpCreateContext(double tolerance);
+
+void zfpFreeContext(struct zfpContext *context);
+
+int zfpSetThreads(struct zfpContext *context, unsigned int threads, unsigned int chunksize);
+
+size_t zfpCompressWithContext(struct zfpContext *context, float *array, int nx, int ny, int nz, const unsigned char **compressed);
+
+int zfpDecompressWithContext(struct zfpContext *context, const unsigned char *compressed, size_t zfpsize, float *array, int nx, int ny, int nz);
+
+struct zfpArray; //fixed rate zfp array with get/set through a cache of decoded blocks
+
+struct zfpArray *zfpCreateArray(float *values, int nx, int ny, int nz, double rate, unsigned int cacheblocks);
+
+float zfpArrayGet(struct zfpArray *array, int i, int j, int k);
+
+void zfpArraySet(struct zfpArray *array, int i, int j, int k, float value);
+
+void zfpArrayFlush(struct zfpArray *array);
+
+size_t zfpArraySize(struct zfpArray *array);
+
+void zfpFreeArray(struct zfpArray *array);
+
 #endif //ZFP_EXAMPLE_H_
\ No newline at end of file